@@ -0,0 +1,378 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "baseline.h"
+
+/*
+ * Baseline file is line based text:
+ *   tframetest-baseline <version>
+ *   case <name>
+ *   run <fps> <mibps> <p50> <p99> <p99.9>
+ *   lat <cnt> <min> <max> <sum> <sum_sq>
+ *   bucket <index> <count>
+ *   end
+ * with run and bucket lines repeated as needed.
+ */
+
+baseline_t *baseline_new(void)
+{
+	return calloc(1, sizeof(baseline_t));
+}
+
+void baseline_free(baseline_t *base)
+{
+	size_t i;
+
+	if (!base)
+		return;
+	for (i = 0; i < base->cnt; i++)
+		free(base->cases[i].run);
+	free(base);
+}
+
+baseline_case_t *baseline_find(baseline_t *base, const char *name)
+{
+	size_t i;
+
+	for (i = 0; base && i < base->cnt; i++) {
+		if (!strcmp(base->cases[i].name, name))
+			return &base->cases[i];
+	}
+
+	return NULL;
+}
+
+static baseline_case_t *baseline_get(baseline_t *base, const char *name)
+{
+	baseline_case_t *bc = baseline_find(base, name);
+
+	if (bc)
+		return bc;
+	if (base->cnt == BASELINE_MAX_CASES)
+		return NULL;
+	if (strlen(name) >= BASELINE_NAME_MAX || strchr(name, ' '))
+		return NULL;
+
+	bc = &base->cases[base->cnt++];
+	snprintf(bc->name, sizeof(bc->name), "%s", name);
+	stats_init(&bc->lat);
+
+	return bc;
+}
+
+static int baseline_add_run(baseline_case_t *bc, const baseline_run_t *run)
+{
+	if (bc->runs == bc->size) {
+		size_t size = bc->size ? bc->size * 2 : 8;
+		baseline_run_t *tmp;
+
+		tmp = realloc(bc->run, size * sizeof(*tmp));
+		if (!tmp)
+			return 1;
+		bc->run = tmp;
+		bc->size = size;
+	}
+	bc->run[bc->runs++] = *run;
+
+	return 0;
+}
+
+int baseline_add_result(baseline_t *base, const char *name,
+			const test_result_t *res)
+{
+	baseline_case_t *bc;
+	baseline_run_t run;
+	stats_t *st;
+	uint64_t i;
+
+	if (!base || !res || !res->time_taken_ns)
+		return 1;
+
+	bc = baseline_get(base, name);
+	if (!bc)
+		return 1;
+	st = malloc(sizeof(*st));
+	if (!st)
+		return 1;
+
+	/* Open loop latencies count from the time the frame was due */
+	stats_init(st);
+	if (res->stats)
+		*st = res->stats[COMP_SCHED];
+	for (i = 0; res->completion && i < res->frames_written; i++)
+		stats_add(st, completion_value(&res->completion[i],
+					       COMP_SCHED));
+
+	run.fps = (double)res->frames_written * SEC_IN_NS / res->time_taken_ns;
+	run.mibps = (double)res->bytes_written * SEC_IN_NS / (1024 * 1024) /
+		    res->time_taken_ns;
+	run.p50 = stats_percentile(st, 50);
+	run.p99 = stats_percentile(st, 99);
+	run.p999 = stats_percentile(st, 99.9);
+	stats_merge(&bc->lat, st);
+	free(st);
+	bc->frames += res->frames_written;
+	bc->late += res->late;
+
+	return baseline_add_run(bc, &run);
+}
+
+int baseline_save(const baseline_t *base, const char *fname)
+{
+	FILE *f;
+	size_t i;
+	size_t j;
+	int res;
+
+	f = fopen(fname, "w");
+	if (!f)
+		return 1;
+
+	fprintf(f, "%s %d\n", BASELINE_MAGIC, BASELINE_VERSION);
+	for (i = 0; i < base->cnt; i++) {
+		const baseline_case_t *bc = &base->cases[i];
+
+		fprintf(f, "case %s\n", bc->name);
+		for (j = 0; j < bc->runs; j++) {
+			const baseline_run_t *r = &bc->run[j];
+
+			fprintf(f,
+				"run %.17g %.17g %" PRIu64 " %" PRIu64
+				" %" PRIu64 "\n",
+				r->fps, r->mibps, r->p50, r->p99, r->p999);
+		}
+		fprintf(f,
+			"lat %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64
+			" %.17g\n",
+			bc->lat.cnt, bc->lat.min, bc->lat.max, bc->lat.sum,
+			bc->lat.sum_sq);
+		for (j = 0; j < STATS_BUCKETS; j++) {
+			if (bc->lat.buckets[j])
+				fprintf(f, "bucket %zu %" PRIu64 "\n", j,
+					bc->lat.buckets[j]);
+		}
+		fprintf(f, "end\n");
+	}
+
+	res = ferror(f) ? 1 : 0;
+	if (fclose(f))
+		res = 1;
+
+	return res;
+}
+
+static int baseline_parse_line(baseline_t *base, baseline_case_t **bc,
+			       const char *line)
+{
+	char name[BASELINE_NAME_MAX];
+	baseline_run_t run;
+	stats_t *lat = *bc ? &(*bc)->lat : NULL;
+	size_t idx;
+	uint64_t cnt;
+
+	if (sscanf(line, "case %63s", name) == 1) {
+		*bc = baseline_get(base, name);
+		return *bc ? 0 : 1;
+	}
+	if (!*bc)
+		return 1;
+	if (!strcmp(line, "end\n") || !strcmp(line, "end")) {
+		*bc = NULL;
+		return 0;
+	}
+	if (sscanf(line, "run %lf %lf %" SCNu64 " %" SCNu64 " %" SCNu64,
+		   &run.fps, &run.mibps, &run.p50, &run.p99, &run.p999) == 5)
+		return baseline_add_run(*bc, &run);
+	if (sscanf(line,
+		   "lat %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %lf",
+		   &lat->cnt, &lat->min, &lat->max, &lat->sum,
+		   &lat->sum_sq) == 5)
+		return 0;
+	if (sscanf(line, "bucket %zu %" SCNu64, &idx, &cnt) == 2 &&
+	    idx < STATS_BUCKETS) {
+		lat->buckets[idx] = cnt;
+		return 0;
+	}
+
+	return 1;
+}
+
+baseline_t *baseline_load(const char *fname)
+{
+	baseline_case_t *bc = NULL;
+	baseline_t *base;
+	char line[256];
+	int version = 0;
+	FILE *f;
+
+	f = fopen(fname, "r");
+	if (!f)
+		return NULL;
+
+	base = baseline_new();
+	if (!base || !fgets(line, sizeof(line), f) ||
+	    sscanf(line, BASELINE_MAGIC " %d", &version) != 1 ||
+	    version != BASELINE_VERSION)
+		goto fail;
+
+	while (fgets(line, sizeof(line), f)) {
+		if (baseline_parse_line(base, &bc, line))
+			goto fail;
+	}
+	if (bc || ferror(f))
+		goto fail;
+
+	fclose(f);
+	return base;
+
+fail:
+	baseline_free(base);
+	fclose(f);
+	return NULL;
+}
+
+static double baseline_field(const baseline_run_t *run,
+			     enum BaselineField field)
+{
+	switch (field) {
+	case BASELINE_MIBPS:
+		return run->mibps;
+	case BASELINE_P50:
+		return run->p50;
+	case BASELINE_P99:
+		return run->p99;
+	case BASELINE_P999:
+		return run->p999;
+	case BASELINE_FPS:
+	default:
+		return run->fps;
+	}
+}
+
+static double *baseline_values(const baseline_case_t *bc,
+			       enum BaselineField field)
+{
+	double *vals;
+	size_t i;
+
+	vals = malloc((bc->runs ? bc->runs : 1) * sizeof(*vals));
+	if (!vals)
+		return NULL;
+	for (i = 0; i < bc->runs; i++)
+		vals[i] = baseline_field(&bc->run[i], field);
+
+	return vals;
+}
+
+double baseline_median(const baseline_case_t *bc, enum BaselineField field,
+		       double *lo, double *hi)
+{
+	double *vals;
+	double median;
+	double l;
+	double h;
+
+	vals = baseline_values(bc, field);
+	if (!vals)
+		return 0;
+	stats_median_ci(vals, bc->runs, &median, &l, &h);
+	free(vals);
+	if (lo)
+		*lo = l;
+	if (hi)
+		*hi = h;
+
+	return median;
+}
+
+/* Relative change in percent, higher is better if lower_worse is set */
+static inline int baseline_worse(double base, double cur, double threshold,
+				 int lower_worse)
+{
+	double change;
+
+	if (base <= 0)
+		return 0;
+	change = (cur - base) * 100 / base;
+
+	return lower_worse ? -change > threshold : change > threshold;
+}
+
+/* Smallest two-sided p-value of the exact rank test with n1 and n2 runs */
+static inline double baseline_min_p(size_t n1, size_t n2)
+{
+	double comb = 1;
+	size_t i;
+
+	/* Orderings of the runs, n1 + n2 choose n1 */
+	for (i = 1; i <= n1; i++)
+		comb = comb * (n2 + i) / i;
+
+	return 2 / comb;
+}
+
+int baseline_compare(const baseline_case_t *base, const baseline_case_t *cur,
+		     double threshold, double alpha, baseline_cmp_t *cmp)
+{
+	memset(cmp, 0, sizeof(*cmp));
+	cmp->fps_p = 1;
+	cmp->lat_p = 1;
+
+	cmp->fps_base = baseline_median(base, BASELINE_FPS, NULL, NULL);
+	cmp->fps_cur = baseline_median(cur, BASELINE_FPS, NULL, NULL);
+	if (base->runs >= 3 && cur->runs >= 3 &&
+	    baseline_min_p(cur->runs, base->runs) < alpha) {
+		double *a = baseline_values(cur, BASELINE_FPS);
+		double *b = baseline_values(base, BASELINE_FPS);
+
+		if (a && b)
+			cmp->fps_p = stats_mann_whitney_values(
+				a, cur->runs, b, base->runs, NULL);
+		free(a);
+		free(b);
+	} else {
+		/*
+		 * Too few runs for the test to ever reach alpha, only the
+		 * threshold applies
+		 */
+		cmp->fps_p = 0;
+	}
+	cmp->fps_regression = baseline_worse(cmp->fps_base, cmp->fps_cur,
+					     threshold, 1) &&
+			      cmp->fps_p < alpha;
+
+	cmp->p50_base = stats_percentile(&base->lat, 50);
+	cmp->p50_cur = stats_percentile(&cur->lat, 50);
+	cmp->p99_base = stats_percentile(&base->lat, 99);
+	cmp->p99_cur = stats_percentile(&cur->lat, 99);
+	cmp->lat_p = stats_mann_whitney(&cur->lat, &base->lat,
+					&cmp->lat_effect);
+	cmp->lat_regression =
+		cmp->lat_p < alpha && cmp->lat_effect > 0.5 &&
+		(baseline_worse(cmp->p50_base, cmp->p50_cur, threshold, 0) ||
+		 baseline_worse(cmp->p99_base, cmp->p99_cur, threshold, 0));
+
+	return cmp->fps_regression || cmp->lat_regression;
+}
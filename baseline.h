@@ -0,0 +1,98 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_BASELINE_H
+#define FRAMETEST_BASELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "frametest.h"
+#include "stats.h"
+
+#define BASELINE_MAGIC "tframetest-baseline"
+#define BASELINE_VERSION 1
+#define BASELINE_MAX_CASES 16
+#define BASELINE_NAME_MAX 64
+
+enum BaselineField {
+	BASELINE_FPS = 0,
+	BASELINE_MIBPS,
+	BASELINE_P50,
+	BASELINE_P99,
+	BASELINE_P999,
+};
+
+typedef struct baseline_run_t {
+	double fps;
+	double mibps;
+	uint64_t p50;
+	uint64_t p99;
+	uint64_t p999;
+} baseline_run_t;
+
+/* Results of all repeats of one test case */
+typedef struct baseline_case_t {
+	char name[BASELINE_NAME_MAX];
+	size_t runs;
+	size_t size;
+	baseline_run_t *run;
+	/* Frame latencies of all runs */
+	stats_t lat;
+	/* Frames and late frames of all runs, not saved */
+	uint64_t frames;
+	uint64_t late;
+} baseline_case_t;
+
+typedef struct baseline_t {
+	size_t cnt;
+	baseline_case_t cases[BASELINE_MAX_CASES];
+} baseline_t;
+
+typedef struct baseline_cmp_t {
+	double fps_base;
+	double fps_cur;
+	double fps_p;
+	uint64_t p50_base;
+	uint64_t p50_cur;
+	uint64_t p99_base;
+	uint64_t p99_cur;
+	double lat_p;
+	/* Probability of a current frame being slower than a baseline one */
+	double lat_effect;
+	int fps_regression;
+	int lat_regression;
+} baseline_cmp_t;
+
+baseline_t *baseline_new(void);
+void baseline_free(baseline_t *base);
+
+baseline_case_t *baseline_find(baseline_t *base, const char *name);
+int baseline_add_result(baseline_t *base, const char *name,
+			const test_result_t *res);
+
+int baseline_save(const baseline_t *base, const char *fname);
+baseline_t *baseline_load(const char *fname);
+
+double baseline_median(const baseline_case_t *bc, enum BaselineField field,
+		       double *lo, double *hi);
+int baseline_compare(const baseline_case_t *base, const baseline_case_t *cur,
+		     double threshold, double alpha, baseline_cmp_t *cmp);
+
+#endif
@@ -0,0 +1,408 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Micro-benchmarks for the overhead tframetest itself adds on top of
+ * the storage under test. Results are appended as CSV rows to the file
+ * given as argument, so the history can be tracked over versions.
+ */
+
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "frametest.h"
+#include "frame.h"
+#include "histogram.h"
+#include "profile.h"
+#include "report.h"
+#include "tester.h"
+#include "timing.h"
+
+#define BENCH_THREADS 4
+#define BENCH_TESTER_FRAMES 1000000UL
+#define BENCH_TIMING_CNT 10000000UL
+#define BENCH_FILL_CNT 1000UL
+
+static FILE *bench_out;
+static char bench_date[32];
+
+/* Platform which completes all I/O immediately */
+static platform_handle_t null_open(const char *fname,
+				   platform_open_flags_t flags, int mode)
+{
+	(void)fname;
+	(void)flags;
+	(void)mode;
+	return 3;
+}
+
+static int null_close(platform_handle_t handle)
+{
+	(void)handle;
+	return 0;
+}
+
+static size_t null_write(platform_handle_t handle, const char *buf,
+			 size_t size)
+{
+	(void)handle;
+	(void)buf;
+	return size;
+}
+
+static size_t null_read(platform_handle_t handle, char *buf, size_t size)
+{
+	(void)handle;
+	(void)buf;
+	return size;
+}
+
+static platform_off_t null_seek(platform_handle_t handle, platform_off_t offs,
+				platform_seek_flags_t whence)
+{
+	(void)handle;
+	(void)whence;
+	return offs;
+}
+
+static int null_usleep(uint64_t us)
+{
+	(void)us;
+	return 0;
+}
+
+static int null_stat(const char *fname, platform_stat_t *st)
+{
+	(void)fname;
+	memset(st, 0, sizeof(*st));
+	return 0;
+}
+
+static int null_thread_create(uint64_t *thread_id, void *(*start)(void *),
+			      void *arg)
+{
+	(void)thread_id;
+	(void)start;
+	(void)arg;
+	return -1;
+}
+
+static int null_thread_cancel(uint64_t thread_id)
+{
+	(void)thread_id;
+	return -1;
+}
+
+static int null_thread_join(uint64_t thread_id, void **retval)
+{
+	(void)thread_id;
+	(void)retval;
+	return -1;
+}
+
+static platform_t null_platform = {
+	.open = null_open,
+	.close = null_close,
+	.write = null_write,
+	.read = null_read,
+	.seek = null_seek,
+	.usleep = null_usleep,
+	.stat = null_stat,
+	.calloc = calloc,
+	.malloc = malloc,
+	.aligned_alloc = posix_memalign,
+	.free = free,
+	.thread_create = null_thread_create,
+	.thread_cancel = null_thread_cancel,
+	.thread_join = null_thread_join,
+};
+
+static void bench_record(const char *name, uint64_t cnt, uint64_t ns)
+{
+	double per_op = cnt ? (double)ns / cnt : 0;
+
+	fprintf(stderr, "%-24s %12" PRIu64 " ops %14.3lf ns/op\n", name, cnt,
+		per_op);
+	fprintf(bench_out, "%s,%s,%s,%" PRIu64 ",%" PRIu64 ",%lf\n",
+		bench_date, FRAMETEST_VERSION, name, cnt, ns, per_op);
+}
+
+static void bench_skip(const char *name, uint64_t cnt, const char *why)
+{
+	fprintf(stderr, "%-24s %12" PRIu64 " ops skipped: %s\n", name, cnt,
+		why);
+}
+
+/* Silence stdout while benchmarking the report functions */
+static int bench_stdout_off(void)
+{
+	int saved;
+	int null;
+
+	fflush(stdout);
+	saved = dup(STDOUT_FILENO);
+	null = open("/dev/null", O_WRONLY);
+	if (saved < 0 || null < 0)
+		exit(1);
+	dup2(null, STDOUT_FILENO);
+	close(null);
+
+	return saved;
+}
+
+static void bench_stdout_on(int saved)
+{
+	fflush(stdout);
+	dup2(saved, STDOUT_FILENO);
+	close(saved);
+}
+
+static void bench_timing(void)
+{
+	uint64_t start;
+	uint64_t sum = 0;
+	size_t i;
+
+	start = timing_start();
+	for (i = 0; i < BENCH_TIMING_CNT; i++)
+		sum += timing_start();
+	bench_record("timing_start", BENCH_TIMING_CNT, timing_elapsed(start));
+	if (!sum)
+		fprintf(stderr, "Timer not running\n");
+}
+
+static void bench_frame_fill(void)
+{
+	frame_t *frm;
+	uint64_t start;
+	size_t i;
+
+	frm = frame_gen(&null_platform, profile_get_by_type(PROF_FULLHD));
+	if (!frm)
+		return;
+
+	start = timing_start();
+	for (i = 0; i < BENCH_FILL_CNT; i++)
+		frame_fill(frm, (char)i);
+	bench_record("frame_fill_fullhd", BENCH_FILL_CNT,
+		     timing_elapsed(start));
+	frame_destroy(&null_platform, frm);
+}
+
+static void bench_tester(void)
+{
+	test_result_t res;
+	frame_t *frm;
+	uint64_t start;
+
+	/* Null platform never touches the data, only overhead is measured */
+	frm = frame_gen(&null_platform, profile_get_by_type(PROF_SD));
+	if (!frm)
+		return;
+
+	start = timing_start();
+	res = tester_run_write(&null_platform, "/nonexistent", frm, 0,
+			       BENCH_TESTER_FRAMES, 0, TEST_MODE_NORM,
+			       TEST_FILES_MULTIPLE, NULL);
+	bench_record("tester_write_null", res.frames_written,
+		     timing_elapsed(start));
+	result_free(&null_platform, &res);
+
+	start = timing_start();
+	res = tester_run_read(&null_platform, "/nonexistent", frm, 0,
+			      BENCH_TESTER_FRAMES, 0, TEST_MODE_RANDOM,
+			      TEST_FILES_MULTIPLE, NULL);
+	bench_record("tester_read_random_null", res.frames_written,
+		     timing_elapsed(start));
+	result_free(&null_platform, &res);
+
+	start = timing_start();
+	res = tester_run_write(&null_platform, "/nonexistent", frm, 0,
+			       BENCH_TESTER_FRAMES, 0, TEST_MODE_NORM,
+			       TEST_FILES_SINGLE, NULL);
+	bench_record("tester_write_single_null", res.frames_written,
+		     timing_elapsed(start));
+	result_free(&null_platform, &res);
+
+	frame_destroy(&null_platform, frm);
+}
+
+static void gen_completions(test_result_t *res, uint64_t frames,
+			    uint64_t base)
+{
+	uint64_t t = base;
+	uint64_t i;
+
+	res->frames_written = frames;
+	res->bytes_written = frames * 4096;
+	res->time_taken_ns = 0;
+	res->started = base;
+	for (i = 0; i < frames; i++) {
+		test_completion_t *c = &res->completion[i];
+		uint64_t lat = 100000 + (uint64_t)(rand() % 20000000);
+
+		c->start = t;
+		c->open = t + lat / 100;
+		c->io = t + lat - lat / 50;
+		c->close = t + lat - lat / 100;
+		c->frame = t + lat;
+		t += lat;
+	}
+	res->finished = t;
+	res->time_taken_ns = t - base;
+}
+
+static int bench_fits(uint64_t frames)
+{
+	uint64_t need;
+	uint64_t have;
+
+	/* Per thread results plus the aggregate */
+	need = 2 * frames * sizeof(test_completion_t);
+	have = (uint64_t)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+
+	return need < have / 10 * 8;
+}
+
+static void bench_results(uint64_t frames)
+{
+	test_result_t threads[BENCH_THREADS];
+	test_result_t tres = { 0 };
+	opts_t opts = { 0 };
+	uint64_t *cnts;
+	uint64_t start;
+	char name[64];
+	size_t i;
+	int fd;
+
+	if (!bench_fits(frames)) {
+		snprintf(name, sizeof(name), "aggregate_%" PRIu64, frames);
+		bench_skip(name, frames, "not enough memory");
+		return;
+	}
+
+	memset(threads, 0, sizeof(threads));
+	for (i = 0; i < BENCH_THREADS; i++) {
+		uint64_t cnt = frames / BENCH_THREADS;
+
+		threads[i].completion = calloc(cnt, sizeof(test_completion_t));
+		if (!threads[i].completion)
+			goto out;
+		gen_completions(&threads[i], cnt, 1000);
+	}
+
+	snprintf(name, sizeof(name), "aggregate_%" PRIu64, frames);
+	start = timing_start();
+	for (i = 0; i < BENCH_THREADS; i++)
+		test_result_aggregate(&tres, &threads[i]);
+	bench_record(name, tres.frames_written, timing_elapsed(start));
+
+	cnts = calloc(histogram_size(), sizeof(*cnts));
+	if (cnts) {
+		snprintf(name, sizeof(name), "histogram_%" PRIu64, frames);
+		start = timing_start();
+		histogram_collect(&tres, cnts);
+		bench_record(name, tres.frames_written, timing_elapsed(start));
+		free(cnts);
+	}
+
+	opts.path = ".";
+	opts.threads = BENCH_THREADS;
+	opts.frames = frames;
+	opts.times = 1;
+	opts.per_thread = 1;
+	opts.profile = profile_get_by_type(PROF_SD);
+
+	snprintf(name, sizeof(name), "report_text_%" PRIu64, frames);
+	fd = bench_stdout_off();
+	start = timing_start();
+	print_results("write", &opts, &tres, threads, BENCH_THREADS);
+	print_histogram(&tres);
+	start = timing_elapsed(start);
+	bench_stdout_on(fd);
+	bench_record(name, tres.frames_written, start);
+
+	snprintf(name, sizeof(name), "report_json_%" PRIu64, frames);
+	fd = bench_stdout_off();
+	start = timing_start();
+	print_header_json(&opts);
+	print_results_json("write", &opts, &tres, threads, BENCH_THREADS,
+			   NULL, NULL);
+	print_footer_json();
+	start = timing_elapsed(start);
+	bench_stdout_on(fd);
+	bench_record(name, tres.frames_written, start);
+
+out:
+	for (i = 0; i < BENCH_THREADS; i++)
+		free(threads[i].completion);
+	free(tres.completion);
+}
+
+int main(int argc, char **argv)
+{
+	timing_info_t info;
+	time_t now;
+	int i;
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s results.csv [frames...]\n", argv[0]);
+		return 1;
+	}
+
+	bench_out = fopen(argv[1], "a+");
+	if (!bench_out) {
+		fprintf(stderr, "Can't open %s\n", argv[1]);
+		return 1;
+	}
+	fseek(bench_out, 0, SEEK_END);
+	if (!ftell(bench_out))
+		fprintf(bench_out, "date,version,bench,ops,ns,ns_per_op\n");
+
+	now = time(NULL);
+	strftime(bench_date, sizeof(bench_date), "%Y-%m-%dT%H:%M:%S",
+		 gmtime(&now));
+	srand(1);
+
+	timing_init(TIMING_AUTO);
+	timing_get_info(&info);
+	fprintf(stderr, "Timer: %s, cost %.1lf ns\n", info.name, info.cost_ns);
+
+	bench_timing();
+	bench_frame_fill();
+	bench_tester();
+	for (i = 2; i < argc; i++)
+		bench_results(strtoull(argv[i], NULL, 10));
+
+	fclose(bench_out);
+	fprintf(stderr, "Results appended to %s\n", argv[1]);
+
+	return 0;
+}
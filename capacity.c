@@ -0,0 +1,129 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "capacity.h"
+
+static int capacity_parse_ms(const char *str, uint64_t *ns)
+{
+	char *endp = NULL;
+	double ms = strtod(str, &endp);
+
+	if (endp == str || *endp || ms <= 0)
+		return 1;
+	*ns = ms * 1000000;
+
+	return 0;
+}
+
+int capacity_parse_slo(capacity_slo_t *slo, const char *str)
+{
+	char buf[256];
+	char *tok;
+	char *save = NULL;
+
+	if (!slo || !str)
+		return 1;
+	if (snprintf(buf, sizeof(buf), "%s", str) >= (int)sizeof(buf))
+		return 1;
+
+	memset(slo, 0, sizeof(*slo));
+	slo->late = -1;
+	for (tok = strtok_r(buf, ",", &save); tok;
+	     tok = strtok_r(NULL, ",", &save)) {
+		char *val = strchr(tok, '=');
+		char *endp = NULL;
+		int res = 0;
+
+		if (!val)
+			return 1;
+		*val++ = 0;
+
+		if (!strcmp(tok, "late")) {
+			slo->late = strtod(val, &endp);
+			res = endp == val || *endp || slo->late < 0;
+		} else if (!strcmp(tok, "p50")) {
+			res = capacity_parse_ms(val, &slo->p50);
+		} else if (!strcmp(tok, "p99")) {
+			res = capacity_parse_ms(val, &slo->p99);
+		} else if (!strcmp(tok, "p99.9")) {
+			res = capacity_parse_ms(val, &slo->p999);
+		} else {
+			return 1;
+		}
+		if (res)
+			return 1;
+	}
+
+	return slo->late >= 0 || slo->p50 || slo->p99 || slo->p999 ? 0 : 1;
+}
+
+int capacity_slo_met(const capacity_slo_t *slo, const sweep_result_t *res)
+{
+	/* Failed runs have no throughput */
+	if (res->mibps <= 0)
+		return 0;
+	if (slo->late >= 0 && res->late > slo->late)
+		return 0;
+	if ((slo->p50 && res->p50 > slo->p50) ||
+	    (slo->p99 && res->p99 > slo->p99) ||
+	    (slo->p999 && res->p999 > slo->p999))
+		return 0;
+
+	return 1;
+}
+
+void capacity_init(capacity_t *cap, size_t max, int bisect)
+{
+	cap->lo = 0;
+	cap->hi = max + 1;
+	cap->cur = 0;
+	cap->bisect = bisect;
+}
+
+size_t capacity_next(capacity_t *cap)
+{
+	if (cap->hi - cap->lo <= 1)
+		cap->cur = 0;
+	else if (cap->bisect)
+		cap->cur = cap->lo + (cap->hi - cap->lo) / 2;
+	else
+		cap->cur = cap->lo + 1;
+
+	return cap->cur;
+}
+
+void capacity_result(capacity_t *cap, int pass)
+{
+	if (!cap->cur)
+		return;
+	if (pass)
+		cap->lo = cap->cur;
+	else
+		cap->hi = cap->cur;
+}
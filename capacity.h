@@ -0,0 +1,65 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_CAPACITY_H
+#define FRAMETEST_CAPACITY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sweep.h"
+
+/* Limits a stream count must meet, 0 latency or negative late is none */
+typedef struct capacity_slo_t {
+	double late;
+	uint64_t p50;
+	uint64_t p99;
+	uint64_t p999;
+} capacity_slo_t;
+
+/*
+ * Search of the largest passing stream count. Counts up to lo are known
+ * to pass and from hi on to fail.
+ */
+typedef struct capacity_t {
+	size_t lo;
+	size_t hi;
+	size_t cur;
+	int bisect;
+} capacity_t;
+
+/*
+ * Comma separated key=value list: late (percent of frames), p50, p99 and
+ * p99.9 (milliseconds)
+ */
+int capacity_parse_slo(capacity_slo_t *slo, const char *str);
+int capacity_slo_met(const capacity_slo_t *slo, const sweep_result_t *res);
+
+/* Searches 1..max streams one by one, or by bisection */
+void capacity_init(capacity_t *cap, size_t max, int bisect);
+/* Stream count to try next, 0 once the search is done */
+size_t capacity_next(capacity_t *cap);
+void capacity_result(capacity_t *cap, int pass);
+
+static inline size_t capacity_best(const capacity_t *cap)
+{
+	return cap->lo;
+}
+
+#endif
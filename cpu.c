@@ -0,0 +1,90 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+#include <string.h>
+#include <time.h>
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+#include "frametest.h"
+#include "cpu.h"
+
+uint64_t cpu_thread_time(void)
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts))
+		return 0;
+
+	return (uint64_t)ts.tv_sec * SEC_IN_NS + ts.tv_nsec;
+#else
+	return 0;
+#endif
+}
+
+#if !defined(_WIN32)
+static inline uint64_t cpu_timeval_ns(const struct timeval *tv)
+{
+	return (uint64_t)tv->tv_sec * SEC_IN_NS + (uint64_t)tv->tv_usec * 1000;
+}
+#endif
+
+int cpu_usage_get(cpu_usage_t *usage)
+{
+#if defined(_WIN32)
+	memset(usage, 0, sizeof(*usage));
+	return 1;
+#else
+	struct rusage ru;
+
+	memset(usage, 0, sizeof(*usage));
+	if (getrusage(RUSAGE_SELF, &ru))
+		return 1;
+
+	usage->user_ns = cpu_timeval_ns(&ru.ru_utime);
+	usage->sys_ns = cpu_timeval_ns(&ru.ru_stime);
+	usage->vol_csw = ru.ru_nvcsw;
+	usage->invol_csw = ru.ru_nivcsw;
+
+	return 0;
+#endif
+}
+
+static inline uint64_t cpu_sub(uint64_t a, uint64_t b)
+{
+	return a > b ? a - b : 0;
+}
+
+void cpu_usage_diff(cpu_usage_t *res, const cpu_usage_t *start,
+		    const cpu_usage_t *end)
+{
+	res->user_ns = cpu_sub(end->user_ns, start->user_ns);
+	res->sys_ns = cpu_sub(end->sys_ns, start->sys_ns);
+	res->vol_csw = cpu_sub(end->vol_csw, start->vol_csw);
+	res->invol_csw = cpu_sub(end->invol_csw, start->invol_csw);
+}
@@ -0,0 +1,41 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_CPU_H
+#define FRAMETEST_CPU_H
+
+#include <stdint.h>
+
+/* Process wide CPU usage */
+typedef struct cpu_usage_t {
+	uint64_t user_ns;
+	uint64_t sys_ns;
+	uint64_t vol_csw;
+	uint64_t invol_csw;
+} cpu_usage_t;
+
+/* CPU time consumed by the calling thread, 0 if not supported */
+uint64_t cpu_thread_time(void);
+
+int cpu_usage_get(cpu_usage_t *usage);
+void cpu_usage_diff(cpu_usage_t *res, const cpu_usage_t *start,
+		    const cpu_usage_t *end);
+
+#endif
@@ -18,7 +18,16 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 
+#ifdef __linux__
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+#endif
 #include <getopt.h>
+#include <limits.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -31,6 +40,14 @@
 #include "frametest.h"
 #include "report.h"
 #include "platform.h"
+#include "timeline.h"
+#include "telemetry.h"
+#include "baseline.h"
+#include "heatmap.h"
+#include "watchdog.h"
+#include "steady.h"
+#include "job.h"
+#include "interfere.h"
 
 typedef struct thread_info_t {
 	size_t id;
@@ -39,6 +56,7 @@ typedef struct thread_info_t {
 	const platform_t *platform;
 	const opts_t *opts;
 	test_result_t res;
+	test_ctx_t ctx;
 
 	size_t start_frame;
 	size_t frames;
@@ -60,13 +78,19 @@ void *run_write_test_thread(void *arg)
 		mode = TEST_MODE_REVERSE;
 	else if (info->opts->random)
 		mode = TEST_MODE_RANDOM;
+	else if (info->opts->pattern.stride)
+		mode = TEST_MODE_PATTERN;
 
 	files = info->opts->single_file ? TEST_FILES_SINGLE :
 					  TEST_FILES_MULTIPLE;
+	/* Keep creating new frames after the ones of this thread */
+	if (info->opts->no_wrap)
+		info->ctx.loop_step = info->opts->frames;
 
 	info->res = tester_run_write(info->platform, info->opts->path,
 				     info->opts->frm, info->start_frame,
-				     info->frames, info->fps, mode, files);
+				     info->frames, info->fps, mode, files,
+				     &info->ctx);
 
 	return NULL;
 }
@@ -86,13 +110,16 @@ void *run_read_test_thread(void *arg)
 		mode = TEST_MODE_REVERSE;
 	else if (info->opts->random)
 		mode = TEST_MODE_RANDOM;
+	else if (info->opts->pattern.stride)
+		mode = TEST_MODE_PATTERN;
 
 	files = info->opts->single_file ? TEST_FILES_SINGLE :
 					  TEST_FILES_MULTIPLE;
 
 	info->res = tester_run_read(info->platform, info->opts->path,
 				    info->opts->frm, info->start_frame,
-				    info->frames, info->fps, mode, files);
+				    info->frames, info->fps, mode, files,
+				    &info->ctx);
 
 	return NULL;
 }
@@ -130,28 +157,189 @@ void calculate_frame_range(thread_info_t *threads, const opts_t *opts)
 	}
 }
 
+static int cmp_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/* Time of the n-th, from 1, smallest start or end of frame */
+static uint64_t nth_time(const test_result_t *res, size_t n, int end)
+{
+	uint64_t *times;
+	uint64_t val;
+	uint64_t i;
+
+	times = malloc(sizeof(*times) * res->frames_written);
+	if (!times)
+		return 0;
+	for (i = 0; i < res->frames_written; i++)
+		times[i] = end ? res->completion[i].frame :
+				 res->completion[i].start;
+	qsort(times, res->frames_written, sizeof(*times), cmp_u64);
+	val = times[n - 1];
+	free(times);
+
+	return val;
+}
+
+/*
+ * Steady state window without warm-up and cool-down. Frames overlapping
+ * its edges are excluded too. Returns non-zero if nothing would be left.
+ */
+static int steady_window(const opts_t *opts, const test_result_t *res,
+			 uint64_t start, uint64_t end, uint64_t *from,
+			 uint64_t *to)
+{
+	size_t cnt = res->frames_written;
+
+	*from = start;
+	*to = end;
+	if (!cnt || !res->completion)
+		return 1;
+	if (opts->warmup.frames >= cnt || opts->cooldown.frames >= cnt)
+		return 1;
+
+	if (opts->warmup.ns)
+		*from = start + opts->warmup.ns;
+	else if (opts->warmup.frames)
+		*from = nth_time(res, opts->warmup.frames, 1);
+	if (opts->cooldown.ns)
+		*to = end > opts->cooldown.ns ? end - opts->cooldown.ns : 0;
+	else if (opts->cooldown.frames)
+		*to = nth_time(res, cnt - opts->cooldown.frames + 1, 0);
+
+	return *from < *to ? 0 : 1;
+}
+
+static void topks_free(const platform_t *platform, topk_t *topks,
+		       size_t cnt)
+{
+	size_t i;
+
+	for (i = 0; topks && i < cnt; i++)
+		topk_free(&topks[i]);
+	platform->free(topks);
+}
+
+static topk_t *topks_new(const platform_t *platform, size_t cnt, size_t k)
+{
+	topk_t *topks;
+	size_t i;
+
+	topks = platform->calloc(cnt, sizeof(*topks));
+	for (i = 0; topks && i < cnt; i++) {
+		if (topk_init(&topks[i], k, i)) {
+			topks_free(platform, topks, cnt);
+			topks = NULL;
+		}
+	}
+	if (!topks)
+		fprintf(stderr, "Can't track slowest frames\n");
+
+	return topks;
+}
+
 int run_test_threads(const platform_t *platform, const char *tst,
-		     const opts_t *opts, void *(*tfunc)(void *))
+		     const opts_t *opts, void *(*tfunc)(void *),
+		     baseline_t *runs)
 {
 	size_t i;
 	int res;
 	thread_info_t *threads;
+	test_result_t *thread_res;
+	trace_writer_t *writers = NULL;
 	test_result_t tres = { 0 };
+	cpu_usage_t usage_start;
+	cpu_usage_t usage_end;
+	telemetry_t tm = { 0 };
+	heatmap_t *hm = NULL;
+	topk_t *topks = NULL;
+	watchdog_t wd = { 0 };
+	steady_t sd = { 0 };
+	platform_gate_t *gate;
+	uint64_t duration = opts->duration_ns;
 	uint64_t start;
 
+	gate = platform->gate_new();
+	if (!gate)
+		return 1;
 	threads = platform->calloc(opts->threads, sizeof(*threads));
-	if (!threads)
+	if (!threads) {
+		platform->gate_free(gate);
+		return 1;
+	}
+	thread_res = platform->calloc(opts->threads, sizeof(*thread_res));
+	if (!thread_res) {
+		platform->free(threads);
+		platform->gate_free(gate);
 		return 1;
+	}
 
 	calculate_frame_range(threads, opts);
+	if (opts->slowest)
+		topks = topks_new(platform, opts->threads, opts->slowest);
+	if (opts->trace) {
+		writers = platform->calloc(opts->threads, sizeof(*writers));
+		if (!writers) {
+			topks_free(platform, topks, opts->threads);
+			platform->free(thread_res);
+			platform->free(threads);
+			platform->gate_free(gate);
+			return 1;
+		}
+	}
 
-	start = timing_start();
+	if (opts->cpu)
+		(void)cpu_usage_get(&usage_start);
+	if (opts->interval_ns &&
+	    telemetry_start(&tm, platform, opts->path, opts->interval_ns))
+		fprintf(stderr, "Can't start telemetry sampler\n");
+	if (opts->watchdog_ns &&
+	    (watchdog_init(&wd, platform, opts, tst) || watchdog_start(&wd))) {
+		fprintf(stderr, "Can't start stall watchdog\n");
+		watchdog_free(&wd);
+	}
+	if (opts->steady_ns) {
+		if (steady_init(&sd, platform, opts->threads, opts->steady_ns,
+				opts->steady_cv))
+			fprintf(stderr, "Can't detect steady state\n");
+		if (!duration)
+			duration = STEADY_MAX_NS;
+	}
+	if (opts->on_ns)
+		duration = opts->bursts * (opts->on_ns + opts->off_ns) -
+			   opts->off_ns;
 	for (i = 0; i < opts->threads; i++) {
 		int res;
 
 		threads[i].id = i;
 		threads[i].platform = platform;
 		threads[i].opts = opts;
+		threads[i].ctx.thread_id = i;
+		threads[i].ctx.cpu = opts->cpu;
+		threads[i].ctx.perf = opts->perf;
+		threads[i].ctx.sched = opts->sched;
+		threads[i].ctx.burst = opts->burst;
+		threads[i].ctx.pattern = &opts->pattern;
+		threads[i].ctx.gate = gate;
+		threads[i].ctx.duration_ns = duration;
+		threads[i].ctx.on_ns = opts->on_ns;
+		threads[i].ctx.off_ns = opts->off_ns;
+		if (sd.slots) {
+			threads[i].ctx.steady = &sd.slots[i];
+			threads[i].ctx.stop = &sd.done;
+		}
+		if (topks)
+			threads[i].ctx.topk = &topks[i];
+		if (wd.running)
+			threads[i].ctx.watch = &wd.slots[i];
+		if (writers) {
+			trace_writer_init(&writers[i], opts->trace);
+			threads[i].ctx.trace = &writers[i];
+		}
 		res = platform->thread_create(&threads[i].thread, tfunc,
 					      (void *)&threads[i]);
 		if (res) {
@@ -162,11 +350,26 @@ int run_test_threads(const platform_t *platform, const char *tst,
 				platform->thread_cancel(threads[j].thread);
 			for (j = 0; j < i; j++)
 				platform->thread_join(threads[j].thread, &ret);
+			telemetry_stop(&tm);
+			telemetry_free(&tm);
+			watchdog_stop(&wd);
+			watchdog_free(&wd);
+			steady_free(&sd);
+			topks_free(platform, topks, opts->threads);
+			platform->free(writers);
+			platform->free(thread_res);
 			platform->free(threads);
+			platform->gate_free(gate);
 			return 1;
 		}
 	}
 
+	/* Workers wait for all to be created, so they begin together */
+	start = timing_start();
+	platform->gate_open(gate);
+	if (sd.slots && steady_start(&sd, start))
+		fprintf(stderr, "Can't start steady state detection\n");
+
 	res = 0;
 	for (i = 0; i < opts->threads; i++) {
 		void *ret;
@@ -176,39 +379,334 @@ int run_test_threads(const platform_t *platform, const char *tst,
 		if (ret)
 			res = 1;
 
-#if 0
-		print_results(&threads[i].res);
-#endif
 		if (test_result_aggregate(&tres, &threads[i].res))
 			res = 1;
-		result_free(platform, &threads[i].res);
+		thread_res[i] = threads[i].res;
+		threads[i].res.completion = NULL;
+		threads[i].res.stats = NULL;
 	}
 	tres.time_taken_ns = timing_elapsed(start);
-	if (!res) {
-		if (opts->csv)
-			print_results_csv(tst, opts, &tres);
+	platform->gate_free(gate);
+	steady_stop(&sd);
+	telemetry_stop(&tm);
+	watchdog_stop(&wd);
+	if (wd.stalls)
+		fprintf(stderr, "%zu stalled frames in %s test\n", wd.stalls,
+			tst);
+	watchdog_free(&wd);
+	if (opts->cpu && !cpu_usage_get(&usage_end))
+		cpu_usage_diff(&tres.usage, &usage_start, &usage_end);
+	if (!res && opts->timeline &&
+	    timeline_add(opts->timeline, tst, thread_res, opts->threads,
+			 opts->frm ? opts->frm->size : 0))
+		fprintf(stderr, "Failed to add %s test to timeline\n", tst);
+	if (!res && (opts->warmup.frames || opts->warmup.ns ||
+		     opts->cooldown.frames || opts->cooldown.ns)) {
+		uint64_t from;
+		uint64_t to;
+		uint64_t end = start + tres.time_taken_ns;
+
+		if (steady_window(opts, &tres, start, end, &from, &to)) {
+			fprintf(stderr,
+				"Warm-up and cool-down leave no frames in %s "
+				"test, reporting the whole run\n",
+				tst);
+		} else {
+			tester_result_trim(&tres, from, to);
+			for (i = 0; i < opts->threads; i++)
+				tester_result_trim(&thread_res[i], from, to);
+		}
+	}
+	if (!res && (opts->heatmap || opts->heatmap_out)) {
+		hm = platform->malloc(sizeof(*hm));
+		if (hm) {
+			heatmap_init(hm, tres.started);
+			heatmap_add_results(hm, thread_res, opts->threads);
+			if (opts->heatmap_out)
+				heatmap_write_csv(opts->heatmap_out, hm, tst);
+		}
+	}
+	if (!res && runs && baseline_add_result(runs, tst, &tres))
+		fprintf(stderr, "Failed to record %s run\n", tst);
+	if (!res && !opts->quiet) {
+		if (opts->json)
+			print_results_json(tst, opts, &tres, thread_res,
+					   opts->threads, &tm, &sd);
+		else if (opts->csv)
+			print_results_csv(tst, opts, &tres, thread_res,
+					  opts->threads);
 		else {
-			print_results(tst, opts, &tres);
+			print_results(tst, opts, &tres, thread_res,
+				      opts->threads);
 			if (opts->histogram)
 				print_histogram(&tres);
+			print_intervals(tst, &tres, &tm);
+			if (hm && opts->heatmap)
+				heatmap_print(hm, tst);
+			print_slowest(tst, opts, &tres, topks, opts->threads);
+			print_steady(tst, &sd);
 		}
 	}
+	platform->free(hm);
+	steady_free(&sd);
+	topks_free(platform, topks, opts->threads);
+	telemetry_free(&tm);
+	for (i = 0; i < opts->threads; i++)
+		result_free(platform, &thread_res[i]);
 	result_free(platform, &tres);
+	platform->free(writers);
+	platform->free(thread_res);
 	platform->free(threads);
 	return res;
 }
 
-int run_tests(opts_t *opts)
+static int run_repeated(const platform_t *platform, const char *tst,
+			const opts_t *opts, void *(*tfunc)(void *),
+			baseline_t *runs)
 {
-	const platform_t *platform = NULL;
+	size_t i;
+	int res = 0;
 
-	if (!opts)
+	for (i = 0; i < opts->repeat; i++) {
+		if (run_test_threads(platform, tst, opts, tfunc, runs))
+			res = 1;
+	}
+
+	return res;
+}
+
+/* Returns 1 if any test case regressed against the baseline */
+static int compare_baseline(const opts_t *opts, baseline_t *base,
+			    baseline_t *runs)
+{
+	FILE *out = opts->csv || opts->json ? stderr : stdout;
+	int regressed = 0;
+	size_t i;
+
+	for (i = 0; runs && i < runs->cnt; i++) {
+		const baseline_case_t *cur = &runs->cases[i];
+		const baseline_case_t *bc;
+		baseline_cmp_t cmp;
+
+		if (!opts->csv && !opts->json && opts->repeat > 1)
+			print_repeat_summary(stdout, cur);
+		bc = baseline_find(base, cur->name);
+		if (!bc) {
+			if (base)
+				fprintf(stderr, "No baseline for %s test\n",
+					cur->name);
+			continue;
+		}
+		if (baseline_compare(bc, cur, opts->threshold, opts->alpha,
+				     &cmp))
+			regressed = 1;
+		print_baseline_cmp(out, cur->name, &cmp);
+	}
+
+	return regressed;
+}
+
+static int sweep_run(const platform_t *platform, const opts_t *cfg,
+		     const char *tcase, void *(*tfunc)(void *),
+		     sweep_result_t *res)
+{
+	baseline_t *runs = baseline_new();
+	baseline_case_t *bc;
+	int ret;
+
+	memset(res, 0, sizeof(*res));
+	res->tcase = tcase;
+	res->threads = cfg->threads;
+	res->size = cfg->frm ? cfg->frm->size : 0;
+	if (!runs)
+		return 1;
+	ret = run_repeated(platform, tcase, cfg, tfunc, runs);
+	bc = baseline_find(runs, tcase);
+	if (bc && bc->runs) {
+		res->fps = baseline_median(bc, BASELINE_FPS, NULL, NULL);
+		res->mibps = baseline_median(bc, BASELINE_MIBPS, NULL, NULL);
+		res->p50 = stats_percentile(&bc->lat, 50);
+		res->p99 = stats_percentile(&bc->lat, 99);
+		res->p999 = stats_percentile(&bc->lat, 99.9);
+		if (bc->frames)
+			res->late = 100.0 * bc->late / bc->frames;
+	}
+	baseline_free(runs);
+
+	return ret;
+}
+
+/* Runs the tests in every configuration, reusing the frame buffer */
+static int run_sweep(const platform_t *platform, const opts_t *opts)
+{
+	const sweep_t *sw = &opts->sweep;
+	size_t threads_cnt = sw->threads.cnt ? sw->threads.cnt : 1;
+	size_t size_cnt = sw->size.cnt ? sw->size.cnt : 1;
+	size_t frame_size = opts->frm ? opts->frm->size : 0;
+	sweep_result_t *results;
+	size_t cnt = 0;
+	opts_t cfg = *opts;
+	int res = 0;
+	size_t i;
+	size_t j;
+
+	results = calloc(threads_cnt * size_cnt * 2, sizeof(*results));
+	if (!results)
+		return 1;
+	cfg.quiet = 1;
+
+	print_sweep_header(opts);
+	for (i = 0; i < threads_cnt; i++) {
+		if (sw->threads.cnt)
+			cfg.threads = sw->threads.vals[i];
+		for (j = 0; j < size_cnt; j++) {
+			if (sw->size.cnt)
+				cfg.frm->size = sw->size.vals[j];
+			if (opts->mode & TEST_WRITE) {
+				if (sweep_run(platform, &cfg, "write",
+					      &run_write_test_thread,
+					      &results[cnt]))
+					res = 1;
+				print_sweep_result(opts, &results[cnt++]);
+			}
+			if (opts->mode & TEST_READ) {
+				if (sweep_run(platform, &cfg, "read",
+					      &run_read_test_thread,
+					      &results[cnt]))
+					res = 1;
+				print_sweep_result(opts, &results[cnt++]);
+			}
+		}
+	}
+	if (opts->frm)
+		opts->frm->size = frame_size;
+
+	for (i = 0; i < 2; i++) {
+		const char *tcase = i ? "read" : "write";
+		long best;
+
+		if (!(opts->mode & (i ? TEST_READ : TEST_WRITE)))
+			continue;
+		best = sweep_best(results, cnt, tcase, opts->sweep_p99_ns);
+		print_sweep_best(opts, tcase, best < 0 ? NULL : &results[best]);
+	}
+	free(results);
+
+	return res;
+}
+
+/*
+ * Searches the largest number of open loop streams, each running at the
+ * frame rate and playing the frames, which still meet the SLO
+ */
+static int run_capacity(const platform_t *platform, const opts_t *opts)
+{
+	capacity_slo_t slo = opts->slo;
+	sweep_result_t step;
+	opts_t cfg = *opts;
+	capacity_t cap;
+	size_t streams;
+	int res = 0;
+	int i;
+
+	/* By default 99% of frames must complete within a frame period */
+	if (slo.late < 0 && !slo.p50 && !slo.p99 && !slo.p999)
+		slo.p99 = SEC_IN_NS / opts->fps;
+	cfg.quiet = 1;
+	if (cfg.sched == SCHED_CLOSED)
+		cfg.sched = SCHED_FIXED;
+
+	print_capacity_header(opts, &slo);
+	for (i = 0; i < 2; i++) {
+		const char *tcase = i ? "read" : "write";
+
+		if (!(opts->mode & (i ? TEST_READ : TEST_WRITE)))
+			continue;
+		capacity_init(&cap, opts->capacity, opts->capacity_bisect);
+		while ((streams = capacity_next(&cap))) {
+			int pass;
+
+			cfg.threads = streams;
+			cfg.frames = opts->frames * streams;
+			cfg.fps = opts->fps * streams;
+			if (sweep_run(platform, &cfg, tcase,
+				      i ? &run_read_test_thread :
+					  &run_write_test_thread,
+				      &step))
+				res = 1;
+			pass = capacity_slo_met(&slo, &step);
+			capacity_result(&cap, pass);
+			print_capacity_step(opts, &step, pass);
+		}
+		print_capacity_best(opts, tcase, capacity_best(&cap));
+	}
+
+	return res;
+}
+
+/*
+ * Runs the tests first alone and then with the background workers, to see
+ * how much they suffer from the interference
+ */
+static int run_interfere(const platform_t *platform, const opts_t *opts)
+{
+	char prefix[PATH_MAX];
+	sweep_result_t quiet;
+	sweep_result_t loaded;
+	opts_t cfg = *opts;
+	interfere_t bg;
+	int res = 0;
+	int i;
+
+	/* Next to the frames, or the streaming file */
+	snprintf(prefix, sizeof(prefix), "%s%s", opts->path,
+		 opts->single_file ? ".bg" : "/bg");
+	if (interfere_init(&bg, platform, prefix, &opts->interfere,
+			   opts->backend_sim ? NULL : remove)) {
+		fprintf(stderr, "Can't create interference files: %s\n",
+			prefix);
+		interfere_free(&bg);
 		return 1;
+	}
+	cfg.quiet = 1;
+
+	print_interfere_header(opts, &bg);
+	for (i = 0; i < 2; i++) {
+		const char *tcase = i ? "read" : "write";
+		void *(*tfunc)(void *) = i ? &run_read_test_thread :
+					     &run_write_test_thread;
+
+		if (!(opts->mode & (i ? TEST_READ : TEST_WRITE)))
+			continue;
+		if (sweep_run(platform, &cfg, tcase, tfunc, &quiet))
+			res = 1;
+		if (interfere_start(&bg)) {
+			fprintf(stderr, "Can't start interference\n");
+			res = 1;
+			break;
+		}
+		if (sweep_run(platform, &cfg, tcase, tfunc, &loaded))
+			res = 1;
+		interfere_stop(&bg);
+		print_interfere_result(opts, &quiet, &loaded, &bg);
+	}
+	interfere_free(&bg);
+
+	return res;
+}
 
-	platform = platform_get();
+/* Resolves the test profile from the options, prints the error if none */
+static int resolve_profile(opts_t *opts)
+{
 	if (opts->profile.prof == PROF_INVALID && opts->prof != PROF_INVALID) {
 		opts->profile = profile_get_by_type(opts->prof);
 	}
+	if (opts->sweep.size.cnt) {
+		/* One frame of the largest size is used for all of them */
+		opts->write_size =
+			opts->sweep.size.vals[opts->sweep.size.cnt - 1];
+		opts->profile.prof = PROF_INVALID;
+	}
 	if (opts->mode & TEST_EMPTY)
 		opts->profile = profile_get_by_name("empty");
 	else if (opts->profile.prof == PROF_INVALID && opts->write_size) {
@@ -251,42 +749,189 @@ int run_tests(opts_t *opts)
 		return 1;
 	}
 
-	if (opts->mode & TEST_WRITE)
-		opts->frm = frame_gen(platform, opts->profile);
-	else if (opts->mode & TEST_READ) {
-		if (opts->single_file || opts->profile.prof != PROF_INVALID)
-			opts->frm = frame_gen(platform, opts->profile);
-		if (!opts->frm) {
-			opts->frm = tester_get_frame_read(
-				platform, opts->path,
-				opts->profile.header_size);
-		}
+	return 0;
+}
+
+/* Frames of read tests without a profile are sized after the first one */
+static int frame_discovered(const opts_t *opts)
+{
+	return !(opts->mode & TEST_WRITE) && (opts->mode & TEST_READ) &&
+	       !opts->single_file && opts->profile.prof == PROF_INVALID;
+}
+
+/* Frame buffer of the tests, generated or sized after the frames */
+static frame_t *tests_frame(const platform_t *platform, const opts_t *opts)
+{
+	frame_t *frm = NULL;
+
+	if (!(opts->mode & (TEST_WRITE | TEST_READ)))
+		return NULL;
+	if (!frame_discovered(opts))
+		frm = frame_gen(platform, opts->profile);
+	if (!frm && !(opts->mode & TEST_WRITE))
+		frm = tester_get_frame_read(platform, opts->path,
+					    opts->profile.header_size);
+
+	return frm;
+}
+
+int run_tests(opts_t *opts)
+{
+	const platform_t *platform = NULL;
+	frame_t *own = NULL;
+	baseline_t *base = NULL;
+	baseline_t *runs = NULL;
+	int sweep;
+	int res = 0;
+
+	if (!opts)
+		return 1;
+	sweep = opts->sweep.threads.cnt || opts->sweep.size.cnt ||
+		opts->capacity || opts->interfere.cnt;
+
+	if (opts->backend_sim)
+		platform = sim_platform_get(&opts->sim);
+	else
+		platform = platform_get();
+	if (resolve_profile(opts))
+		return 1;
+
+	/* The frame buffer may be shared by the caller */
+	if (!opts->frm) {
+		own = tests_frame(platform, opts);
+		opts->frm = own;
+	}
+	if (!(opts->mode & TEST_WRITE) && (opts->mode & TEST_READ)) {
 		if (!opts->frm) {
 			fprintf(stderr, "Can't allocate frame\n");
 			return 1;
 		}
 		opts->profile = opts->frm->profile;
 	}
-	if (!opts->csv)
-		printf("Profile: %s\n", opts->profile.name);
-
-	if (opts->csv && !opts->no_csv_header)
-		print_header_csv(opts);
+	if (opts->frame_trace) {
+		opts->trace = trace_open(opts->frame_trace, opts->threads,
+					 opts->frm ? opts->frm->size : 0);
+		if (!opts->trace) {
+			fprintf(stderr, "Can't open frame trace: %s\n",
+				opts->frame_trace);
+			frame_destroy(platform, own);
+			return 1;
+		}
+	}
 
-	if (opts->mode & TEST_WRITE) {
-		if (!opts->frm) {
-			fprintf(stderr, "Can't allocate frame\n");
+	if (opts->trace_out) {
+		opts->timeline = timeline_open(opts->trace_out);
+		if (!opts->timeline) {
+			fprintf(stderr, "Can't open timeline: %s\n",
+				opts->trace_out);
+			trace_close(opts->trace);
+			opts->trace = NULL;
+			frame_destroy(platform, own);
 			return 1;
 		}
-		run_test_threads(platform, "write", opts,
-				 &run_write_test_thread);
 	}
-	if (opts->mode & TEST_READ) {
-		run_test_threads(platform, "read", opts, &run_read_test_thread);
+
+	if (opts->heatmap_csv) {
+		opts->heatmap_out = fopen(opts->heatmap_csv, "w");
+		if (!opts->heatmap_out) {
+			fprintf(stderr, "Can't open heatmap: %s\n",
+				opts->heatmap_csv);
+			goto fail;
+		}
+		heatmap_write_csv_header(opts->heatmap_out);
+	}
+	if (opts->baseline) {
+		base = baseline_load(opts->baseline);
+		if (!base) {
+			fprintf(stderr, "Can't load baseline: %s\n",
+				opts->baseline);
+			goto fail;
+		}
+	}
+	if (base || opts->save_baseline || opts->repeat > 1) {
+		runs = baseline_new();
+		if (!runs)
+			goto fail;
+	}
+	if ((opts->mode & TEST_WRITE) && !opts->frm) {
+		fprintf(stderr, "Can't allocate frame\n");
+		goto fail;
 	}
-	frame_destroy(platform, opts->frm);
 
-	return 0;
+	if (opts->json && !opts->quiet)
+		print_header_json(opts);
+	else if (!opts->csv && !opts->quiet) {
+		printf("Profile: %s\n", opts->profile.name);
+		print_timer();
+	}
+
+	if (opts->csv && !opts->json && !opts->no_csv_header && !sweep &&
+	    !opts->quiet)
+		print_header_csv(opts);
+
+	if (opts->capacity) {
+		if (run_capacity(platform, opts))
+			res = 1;
+	} else if (opts->interfere.cnt) {
+		if (run_interfere(platform, opts))
+			res = 1;
+	} else if (sweep) {
+		if (run_sweep(platform, opts))
+			res = 1;
+	} else if (opts->results) {
+		if ((opts->mode & TEST_WRITE) &&
+		    sweep_run(platform, opts, "write", &run_write_test_thread,
+			      &opts->results[opts->results_cnt++]))
+			res = 1;
+		if ((opts->mode & TEST_READ) &&
+		    sweep_run(platform, opts, "read", &run_read_test_thread,
+			      &opts->results[opts->results_cnt++]))
+			res = 1;
+	} else {
+		if (opts->mode & TEST_WRITE)
+			run_repeated(platform, "write", opts,
+				     &run_write_test_thread, runs);
+		if (opts->mode & TEST_READ)
+			run_repeated(platform, "read", opts,
+				     &run_read_test_thread, runs);
+	}
+	if (opts->json && !opts->quiet)
+		print_footer_json();
+	if (compare_baseline(opts, base, runs))
+		res = 2;
+	if (opts->save_baseline && baseline_save(runs, opts->save_baseline))
+		fprintf(stderr, "Failed to save baseline: %s\n",
+			opts->save_baseline);
+	baseline_free(runs);
+	baseline_free(base);
+	if (trace_close(opts->trace))
+		fprintf(stderr, "Failed to write frame trace: %s\n",
+			opts->frame_trace);
+	opts->trace = NULL;
+	if (timeline_close(opts->timeline))
+		fprintf(stderr, "Failed to write timeline: %s\n",
+			opts->trace_out);
+	opts->timeline = NULL;
+	if (opts->heatmap_out && fclose(opts->heatmap_out))
+		fprintf(stderr, "Failed to write heatmap: %s\n",
+			opts->heatmap_csv);
+	opts->heatmap_out = NULL;
+	frame_destroy(platform, own);
+
+	return res;
+
+fail:
+	baseline_free(runs);
+	baseline_free(base);
+	trace_close(opts->trace);
+	opts->trace = NULL;
+	(void)timeline_close(opts->timeline);
+	opts->timeline = NULL;
+	if (opts->heatmap_out)
+		fclose(opts->heatmap_out);
+	opts->heatmap_out = NULL;
+	frame_destroy(platform, own);
+	return 1;
 }
 
 int opt_parse_frame_size_helper(opts_t *opt, const char *arg,
@@ -380,100 +1025,403 @@ int opt_parse_header_size(opts_t *opt, const char *arg)
 	return parse_arg_size_t(arg, &opt->header_size, 1);
 }
 
-int opt_parse_frame_size(opts_t *opt, const char *arg)
+int opt_parse_timer(opts_t *opt, const char *arg)
 {
-	return opt_parse_frame_size_helper(opt, arg, &opt->stream_prof,
-					   &opt->frame_size);
+	if (!strcmp(arg, "auto"))
+		opt->timer = TIMING_AUTO;
+	else if (!strcmp(arg, "tsc"))
+		opt->timer = TIMING_TSC;
+	else if (!strcmp(arg, "clock"))
+		opt->timer = TIMING_CLOCK;
+	else
+		return 1;
+
+	return 0;
 }
 
-void list_profiles(void)
+int opt_parse_interval(opts_t *opt, const char *arg)
 {
-	size_t cnt = profile_count();
-	size_t i;
+	size_t ms;
 
-	printf("Profiles:\n");
-	for (i = 1; i < cnt; i++) {
-		profile_t prof = profile_get_by_index(i);
+	if (parse_arg_size_t(arg, &ms, 0))
+		return 1;
+	opt->interval_ns = (uint64_t)ms * SEC_IN_MS;
 
-		printf("  %s\n", prof.name);
-		printf("     %zux%zu, %zu bits, %zuB header\n", prof.width,
-		       prof.height, prof.bytes_per_pixel * 8, prof.header_size);
-	}
+	return 0;
 }
 
-struct long_opt_desc {
-	const char *name;
-	const char *desc;
-};
-static struct option long_opts[] = {
-	{ "write", required_argument, 0, 'w' },
-	{ "read", no_argument, 0, 'r' },
-	{ "empty", no_argument, 0, 'e' },
-	{ "streaming", no_argument, 0, 's' },
-	{ "frame-size", no_argument, 0, 'z' },
-	{ "list-profiles", no_argument, 0, 'l' },
-	{ "threads", required_argument, 0, 't' },
-	{ "num-frames", required_argument, 0, 'n' },
-	{ "fps", required_argument, 0, 'f' },
-	{ "reverse", no_argument, 0, 'v' },
-	{ "random", no_argument, 0, 'm' },
-	{ "csv", no_argument, 0, 'c' },
-	{ "no-csv-header", no_argument, 0, 0 },
-	{ "header", required_argument, 0, 0 },
-	{ "times", no_argument, 0, 0 },
-	{ "frametimes", no_argument, 0, 0 },
-	{ "histogram", no_argument, 0, 0 },
-	{ "version", no_argument, 0, 'V' },
-	{ "help", no_argument, 0, 'h' },
-	{ 0, 0, 0, 0 },
-};
-static size_t long_opts_cnt = sizeof(long_opts) / sizeof(long_opts[0]);
-static struct long_opt_desc long_opt_descs[] = {
-	{ "write", "Perform write tests, size/profile as parameter" },
-	{ "read", "Perform read tests" },
-	{ "empty", "Perform write tests with empty frames" },
-	{ "streaming", "Perform streaming test to a single file" },
-	{ "frame-size",
-	  "Specify frame size for reading, required for streaming" },
-	{ "list-profiles", "List available profiles" },
-	{ "threads", "Use number of threads (default 1)" },
-	{ "num-frames", "Write number of frames (default 1800)" },
-	{ "fps", "Limit frame rate to frames per second" },
-	{ "reverse", "Access files in reverse order" },
-	{ "random", "Access files in random order" },
-	{ "csv", "Output results in CSV format" },
-	{ "no-csv-header", "Do not print CSV header" },
-	{ "header", "Frame header size (default 64k)" },
-	{ "times", "Show breakdown of completion times (open/io/close)" },
-	{ "frametimes", "Show detailed timings of every frames in CSV format" },
-	{ "histogram", "Show histogram of completion times at the end" },
-	{ "version", "Display version information" },
-	{ "help", "Display this help" },
-	{ 0, 0 },
-};
+int opt_parse_slowest(opts_t *opt, const char *arg)
+{
+	return parse_arg_size_t(arg, &opt->slowest, 0);
+}
 
-#define XSTRING(x) #x
-#define VERSION_STRING(a, b, c) XSTRING(a) "." XSTRING(b) "." XSTRING(c)
-void version(void)
+int opt_parse_repeat(opts_t *opt, const char *arg)
 {
-	fprintf(stderr, "tframetest %s\n", VERSION_STRING(MAJOR, MINOR, PATCH));
+	return parse_arg_size_t(arg, &opt->repeat, 0);
 }
-#undef XSTRING
-#undef VERSION_STRING
 
-#define DESC_POS 30
-void usage(const char *name)
+static inline int parse_arg_double(const char *arg, double *res)
 {
-	size_t i;
+	char *endp = NULL;
+	double val;
 
-	version();
-	fprintf(stderr, "Usage: %s [options] path\n", name);
-	fprintf(stderr, "Options:\n");
-	for (i = 0; i < long_opts_cnt; i++) {
-		int p = 8;
+	if (!arg || !res)
+		return 1;
 
-		if (!long_opts[i].name)
-			break;
+	val = strtod(arg, &endp);
+	if (!endp || endp == arg || *endp != 0 || !isfinite(val))
+		return 1;
+
+	*res = val;
+
+	return 0;
+}
+
+int opt_parse_threshold(opts_t *opt, const char *arg)
+{
+	double val;
+
+	if (parse_arg_double(arg, &val) || val < 0)
+		return 1;
+	opt->threshold = val;
+
+	return 0;
+}
+
+int opt_parse_alpha(opts_t *opt, const char *arg)
+{
+	double val;
+
+	if (parse_arg_double(arg, &val) || val <= 0 || val >= 1)
+		return 1;
+	opt->alpha = val;
+
+	return 0;
+}
+
+int opt_parse_watchdog(opts_t *opt, const char *arg)
+{
+	size_t ms;
+
+	if (parse_arg_size_t(arg, &ms, 0))
+		return 1;
+	opt->watchdog_ns = (uint64_t)ms * SEC_IN_MS;
+
+	return 0;
+}
+
+/* Number of frames, or seconds with "s" suffix */
+static int opt_parse_span(run_span_t *span, const char *arg)
+{
+	size_t len = strlen(arg);
+	char buf[32];
+	double sec;
+
+	if (!len || len >= sizeof(buf))
+		return 1;
+	if (arg[len - 1] != 's') {
+		span->ns = 0;
+		return parse_arg_size_t(arg, &span->frames, 1);
+	}
+
+	memcpy(buf, arg, len - 1);
+	buf[len - 1] = 0;
+	if (parse_arg_double(buf, &sec) || sec < 0)
+		return 1;
+	span->frames = 0;
+	span->ns = (uint64_t)(sec * SEC_IN_NS);
+
+	return 0;
+}
+
+int opt_parse_warmup(opts_t *opt, const char *arg)
+{
+	return opt_parse_span(&opt->warmup, arg);
+}
+
+int opt_parse_cooldown(opts_t *opt, const char *arg)
+{
+	return opt_parse_span(&opt->cooldown, arg);
+}
+
+int opt_parse_duration(opts_t *opt, const char *arg)
+{
+	double sec;
+
+	if (parse_arg_double(arg, &sec) || sec <= 0)
+		return 1;
+	opt->duration_ns = (uint64_t)(sec * SEC_IN_NS);
+
+	return 0;
+}
+
+/* ON:OFF:N, seconds of frames and of idle, and number of bursts */
+int opt_parse_burst_pattern(opts_t *opt, const char *arg)
+{
+	double on;
+	double off;
+	unsigned long cnt;
+	char end;
+
+	if (sscanf(arg, "%lf:%lf:%lu%c", &on, &off, &cnt, &end) != 3)
+		return 1;
+	if (on <= 0 || off < 0 || !cnt)
+		return 1;
+	opt->on_ns = (uint64_t)(on * SEC_IN_NS);
+	opt->off_ns = (uint64_t)(off * SEC_IN_NS);
+	opt->bursts = cnt;
+
+	return 0;
+}
+
+int opt_parse_steady(opts_t *opt, const char *arg)
+{
+	double sec;
+
+	if (parse_arg_double(arg, &sec) || sec <= 0)
+		return 1;
+	opt->steady_ns = (uint64_t)(sec * SEC_IN_NS);
+
+	return 0;
+}
+
+int opt_parse_steady_cv(opts_t *opt, const char *arg)
+{
+	double val;
+
+	if (parse_arg_double(arg, &val) || val <= 0)
+		return 1;
+	opt->steady_cv = val;
+
+	return 0;
+}
+
+int opt_parse_sweep_p99(opts_t *opt, const char *arg)
+{
+	double ms;
+
+	if (parse_arg_double(arg, &ms) || ms <= 0)
+		return 1;
+	opt->sweep_p99_ns = (uint64_t)(ms * SEC_IN_MS);
+
+	return 0;
+}
+
+int opt_parse_open_loop(opts_t *opt, const char *arg)
+{
+	if (!strcmp(arg, "fixed")) {
+		opt->sched = SCHED_FIXED;
+	} else if (!strcmp(arg, "poisson")) {
+		opt->sched = SCHED_POISSON;
+	} else if (!strncmp(arg, "burst:", 6)) {
+		if (parse_arg_size_t(arg + 6, &opt->burst, 0))
+			return 1;
+		opt->sched = SCHED_BURST;
+	} else {
+		return 1;
+	}
+
+	return 0;
+}
+
+int opt_parse_capacity(opts_t *opt, const char *arg)
+{
+	return parse_arg_size_t(arg, &opt->capacity, 0);
+}
+
+int opt_parse_backend(opts_t *opt, const char *arg)
+{
+	if (!strcmp(arg, "default"))
+		opt->backend_sim = 0;
+	else if (!strcmp(arg, "sim"))
+		opt->backend_sim = 1;
+	else
+		return 1;
+
+	return 0;
+}
+
+int opt_parse_frame_size(opts_t *opt, const char *arg)
+{
+	return opt_parse_frame_size_helper(opt, arg, &opt->stream_prof,
+					   &opt->frame_size);
+}
+
+void list_profiles(void)
+{
+	size_t cnt = profile_count();
+	size_t i;
+
+	printf("Profiles:\n");
+	for (i = 1; i < cnt; i++) {
+		profile_t prof = profile_get_by_index(i);
+
+		printf("  %s\n", prof.name);
+		printf("     %zux%zu, %zu bits, %zuB header\n", prof.width,
+		       prof.height, prof.bytes_per_pixel * 8, prof.header_size);
+	}
+}
+
+struct long_opt_desc {
+	const char *name;
+	const char *desc;
+};
+#define SHORT_OPTS "rw:elt:n:f:s:z:vmhVc"
+
+/* New options go in their feature group, long_opt_descs in the same order */
+static struct option long_opts[] = {
+	{ "write", required_argument, 0, 'w' },
+	{ "read", no_argument, 0, 'r' },
+	{ "empty", no_argument, 0, 'e' },
+	{ "streaming", no_argument, 0, 's' },
+	{ "frame-size", no_argument, 0, 'z' },
+	{ "list-profiles", no_argument, 0, 'l' },
+	{ "threads", required_argument, 0, 't' },
+	{ "num-frames", required_argument, 0, 'n' },
+	{ "fps", required_argument, 0, 'f' },
+	{ "reverse", no_argument, 0, 'v' },
+	{ "random", no_argument, 0, 'm' },
+	{ "csv", no_argument, 0, 'c' },
+	{ "no-csv-header", no_argument, 0, 0 },
+	{ "header", required_argument, 0, 0 },
+	{ "times", no_argument, 0, 0 },
+	{ "frametimes", no_argument, 0, 0 },
+	{ "histogram", no_argument, 0, 0 },
+	/* Frame schedule and order */
+	{ "open-loop", required_argument, 0, 0 },
+	{ "pattern", required_argument, 0, 0 },
+	/* Run length */
+	{ "repeat", required_argument, 0, 0 },
+	{ "warmup", required_argument, 0, 0 },
+	{ "cooldown", required_argument, 0, 0 },
+	{ "duration", required_argument, 0, 0 },
+	{ "no-wrap", no_argument, 0, 0 },
+	{ "burst-pattern", required_argument, 0, 0 },
+	{ "steady", required_argument, 0, 0 },
+	{ "steady-cv", required_argument, 0, 0 },
+	/* Storage and timing */
+	{ "timer", required_argument, 0, 0 },
+	{ "backend", required_argument, 0, 0 },
+	{ "sim-opts", required_argument, 0, 0 },
+	{ "interfere", required_argument, 0, 0 },
+	/* Output */
+	{ "json", no_argument, 0, 0 },
+	{ "per-thread", no_argument, 0, 0 },
+	{ "jitter", no_argument, 0, 0 },
+	{ "heatmap", no_argument, 0, 0 },
+	{ "heatmap-csv", required_argument, 0, 0 },
+	{ "slowest", required_argument, 0, 0 },
+	{ "frame-trace", required_argument, 0, 0 },
+	{ "trace-out", required_argument, 0, 0 },
+	/* Diagnostics */
+	{ "cpu", no_argument, 0, 0 },
+	{ "perf", no_argument, 0, 0 },
+	{ "interval", required_argument, 0, 0 },
+	{ "watchdog", required_argument, 0, 0 },
+	/* Regression gating */
+	{ "baseline", required_argument, 0, 0 },
+	{ "save-baseline", required_argument, 0, 0 },
+	{ "threshold", required_argument, 0, 0 },
+	{ "alpha", required_argument, 0, 0 },
+	/* Searches and batches */
+	{ "sweep", required_argument, 0, 0 },
+	{ "sweep-p99", required_argument, 0, 0 },
+	{ "capacity", required_argument, 0, 0 },
+	{ "capacity-bisect", no_argument, 0, 0 },
+	{ "slo", required_argument, 0, 0 },
+	{ "job", required_argument, 0, 0 },
+
+	{ "version", no_argument, 0, 'V' },
+	{ "help", no_argument, 0, 'h' },
+	{ 0, 0, 0, 0 },
+};
+static size_t long_opts_cnt = sizeof(long_opts) / sizeof(long_opts[0]);
+static struct long_opt_desc long_opt_descs[] = {
+	{ "write", "Perform write tests, size/profile as parameter" },
+	{ "read", "Perform read tests" },
+	{ "empty", "Perform write tests with empty frames" },
+	{ "streaming", "Perform streaming test to a single file" },
+	{ "frame-size",
+	  "Specify frame size for reading, required for streaming" },
+	{ "list-profiles", "List available profiles" },
+	{ "threads", "Use number of threads (default 1)" },
+	{ "num-frames", "Write number of frames (default 1800)" },
+	{ "fps", "Limit frame rate to frames per second" },
+	{ "reverse", "Access files in reverse order" },
+	{ "random", "Access files in random order" },
+	{ "csv", "Output results in CSV format" },
+	{ "no-csv-header", "Do not print CSV header" },
+	{ "header", "Frame header size (default 64k)" },
+	{ "times", "Show breakdown of completion times (open/io/close)" },
+	{ "frametimes", "Show detailed timings of every frames in CSV format" },
+	{ "histogram", "Show histogram of completion times at the end" },
+	/* Frame schedule and order */
+	{ "open-loop", "Issue frames on a schedule: fixed, poisson, burst:N" },
+	{ "pattern", "Trick play, eg. stride=-4 or seek=48 or speed=2" },
+	/* Run length */
+	{ "repeat", "Repeat every test N times, report median and CI" },
+	{ "warmup", "Exclude first N frames, or N seconds with s suffix" },
+	{ "cooldown", "Exclude last N frames, or N seconds with s suffix" },
+	{ "duration", "Run for N seconds, looping over the frames" },
+	{ "no-wrap", "Keep writing new frames with --duration, no overwrite" },
+	{ "burst-pattern", "ON:OFF:N, N bursts of ON s of frames, OFF s idle" },
+	{ "steady", "Run until N seconds of steady state are measured" },
+	{ "steady-cv", "Steady state variation limit in percent (default 5)" },
+	/* Storage and timing */
+	{ "timer", "Time source: auto (default), tsc or clock" },
+	{ "backend", "Storage backend: default or sim (simulated device)" },
+	{ "sim-opts", "Simulated device model, eg. bw=500,lat=100" },
+	{ "interfere", "Background I/O, eg. randread:4k:500,scan,meta:100" },
+	/* Output */
+	{ "json", "Output results and run metadata as a JSON document" },
+	{ "per-thread", "Show per thread results and fairness summary" },
+	{ "jitter", "Show intervals between frame deliveries in order" },
+	{ "heatmap", "Show heatmap of completion times over the test run" },
+	{ "heatmap-csv", "Write completion time heatmap as CSV matrix" },
+	{ "slowest", "Show N slowest frames with phases and neighbours" },
+	{ "frame-trace", "Record every frame to a binary trace file" },
+	{ "trace-out", "Write timeline in Chrome trace-event JSON format" },
+	/* Diagnostics */
+	{ "cpu", "Account CPU time, context switches and on/off-CPU time" },
+	{ "perf", "Count page faults, context switches, cycles etc." },
+	{ "interval", "Interval report with system telemetry every N ms" },
+	{ "watchdog", "Log kernel wait state of frames stuck over N ms" },
+	/* Regression gating */
+	{ "baseline", "Compare to baseline file, exit 2 on regression" },
+	{ "save-baseline", "Save results of this run as a baseline file" },
+	{ "threshold", "Regression threshold in percent (default 5)" },
+	{ "alpha", "Significance level of regression (default 0.01)" },
+	/* Searches and batches */
+	{ "sweep", "Run all configurations, eg. threads=1..32,size=64k..8m" },
+	{ "sweep-p99", "Best sweep configuration needs p99 below N ms" },
+	{ "capacity", "Find how many --fps streams, up to N, meet the SLO" },
+	{ "capacity-bisect", "Bisect the stream count instead of adding one" },
+	{ "slo", "Capacity SLO, eg. late=1,p99=41.7 (default p99=period)" },
+	{ "job", "Run the test cases of a job file, one combined report" },
+
+	{ "version", "Display version information" },
+	{ "help", "Display this help" },
+	{ 0, 0 },
+};
+
+void version(void)
+{
+	fprintf(stderr, "tframetest %s\n", FRAMETEST_VERSION);
+}
+
+#define DESC_POS 30
+void usage(const char *name)
+{
+	size_t i;
+
+	version();
+	fprintf(stderr, "Usage: %s [options] path\n", name);
+	fprintf(stderr, "Options:\n");
+	for (i = 0; i < long_opts_cnt; i++) {
+		int p = 8;
+
+		if (!long_opts[i].name)
+			break;
 		if (long_opts[i].val)
 			fprintf(stderr, "    -%c, ", long_opts[i].val);
 		else
@@ -491,86 +1439,630 @@ void usage(const char *name)
 }
 #undef DESC_POS
 
+/* Long option without a short one, returns non-zero if arg is invalid */
+static int opt_parse_long(opts_t *opts, const char *name, const char *arg)
+{
+	if (!strcmp(name, "no-csv-header"))
+		opts->no_csv_header = 1;
+	if (!strcmp(name, "histogram"))
+		opts->histogram = 1;
+	if (!strcmp(name, "times"))
+		opts->times = 1;
+	if (!strcmp(name, "frametimes"))
+		opts->frametimes = 1;
+	if (!strcmp(name, "json"))
+		opts->json = 1;
+	if (!strcmp(name, "frame-trace"))
+		opts->frame_trace = arg;
+	if (!strcmp(name, "trace-out"))
+		opts->trace_out = arg;
+	if (!strcmp(name, "interval")) {
+		if (opt_parse_interval(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "cpu"))
+		opts->cpu = 1;
+	if (!strcmp(name, "perf"))
+		opts->perf = 1;
+	if (!strcmp(name, "heatmap"))
+		opts->heatmap = 1;
+	if (!strcmp(name, "jitter"))
+		opts->jitter = 1;
+	if (!strcmp(name, "watchdog")) {
+		if (opt_parse_watchdog(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "slowest")) {
+		if (opt_parse_slowest(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "heatmap-csv"))
+		opts->heatmap_csv = arg;
+	if (!strcmp(name, "per-thread"))
+		opts->per_thread = 1;
+	if (!strcmp(name, "timer")) {
+		if (opt_parse_timer(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "backend")) {
+		if (opt_parse_backend(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "sim-opts")) {
+		if (sim_config_parse(&opts->sim, arg))
+			return 1;
+		opts->backend_sim = 1;
+	}
+	if (!strcmp(name, "duration")) {
+		if (opt_parse_duration(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "no-wrap"))
+		opts->no_wrap = 1;
+	if (!strcmp(name, "burst-pattern")) {
+		if (opt_parse_burst_pattern(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "sweep")) {
+		if (sweep_parse(&opts->sweep, arg))
+			return 1;
+	}
+	if (!strcmp(name, "sweep-p99")) {
+		if (opt_parse_sweep_p99(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "steady")) {
+		if (opt_parse_steady(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "steady-cv")) {
+		if (opt_parse_steady_cv(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "warmup")) {
+		if (opt_parse_warmup(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "cooldown")) {
+		if (opt_parse_cooldown(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "repeat")) {
+		if (opt_parse_repeat(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "baseline"))
+		opts->baseline = arg;
+	if (!strcmp(name, "save-baseline"))
+		opts->save_baseline = arg;
+	if (!strcmp(name, "threshold")) {
+		if (opt_parse_threshold(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "alpha")) {
+		if (opt_parse_alpha(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "job"))
+		opts->job = arg;
+	if (!strcmp(name, "open-loop")) {
+		if (opt_parse_open_loop(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "pattern")) {
+		if (tester_pattern_parse(&opts->pattern, arg))
+			return 1;
+	}
+	if (!strcmp(name, "capacity")) {
+		if (opt_parse_capacity(opts, arg))
+			return 1;
+	}
+	if (!strcmp(name, "capacity-bisect"))
+		opts->capacity_bisect = 1;
+	if (!strcmp(name, "slo")) {
+		if (capacity_parse_slo(&opts->slo, arg))
+			return 1;
+	}
+	if (!strcmp(name, "interfere")) {
+		if (interfere_parse(&opts->interfere, arg))
+			return 1;
+	}
+	if (!strcmp(name, "header")) {
+		if (opt_parse_header_size(opts, arg))
+			return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Option with a short form, returns 1 if arg is invalid and -1 if there's
+ * no such option
+ */
+static int opt_parse_short(opts_t *opts, int c, const char *arg)
+{
+	switch (c) {
+	case 'c':
+		opts->csv = 1;
+		break;
+	case 'v':
+		opts->reverse = 1;
+		break;
+	case 'm':
+		opts->random = 1;
+		break;
+	case 'w':
+		if (opt_parse_write(opts, arg)) {
+			if (opt_parse_profile(opts, arg)) {
+				/* Could not parse profile, just skip */
+			}
+		}
+		opts->mode |= TEST_WRITE;
+		break;
+	case 'e':
+		opts->mode |= TEST_WRITE;
+		opts->mode |= TEST_EMPTY;
+		break;
+	case 'r':
+		opts->mode |= TEST_READ;
+		break;
+	case 's':
+		opts->single_file = 1;
+		opts->path = arg;
+		break;
+	case 't':
+		if (opt_parse_threads(opts, arg))
+			return 1;
+		break;
+	case 'n':
+		if (opt_parse_num_frames(opts, arg))
+			return 1;
+		break;
+	case 'f':
+		if (opt_parse_limit_fps(opts, arg))
+			return 1;
+		break;
+	case 'z':
+		if (opt_parse_frame_size(opts, arg))
+			return 1;
+		break;
+	default:
+		return -1;
+	}
+
+	return 0;
+}
+
+static void opts_init(opts_t *opts)
+{
+	memset(opts, 0, sizeof(*opts));
+	opts->threads = 1;
+	opts->frames = 1800;
+	opts->header_size = 65536;
+	opts->repeat = 1;
+	opts->threshold = 5;
+	opts->alpha = 0.01;
+	opts->steady_cv = 5;
+	opts->slo.late = -1;
+	sim_config_default(&opts->sim);
+}
+
+/* Checks combinations of the options, prints the error if not valid */
+static int opts_check(const opts_t *opts)
+{
+	if (opts->random && opts->reverse) {
+		printf("ERROR: --random and --reverse are mutually exclusive, "
+		       "please define only one.\n");
+		return 1;
+	}
+	if (opts->pattern.stride && (opts->random || opts->reverse)) {
+		printf("ERROR: --pattern sets the order of frames, it can't be "
+		       "used with --random or --reverse.\n");
+		return 1;
+	}
+	if (opts->pattern.speed != 1 && opts->pattern.stride && !opts->fps) {
+		printf("ERROR: --pattern speed needs the frame rate with "
+		       "--fps.\n");
+		return 1;
+	}
+	if (opts->on_ns && (opts->duration_ns || opts->steady_ns)) {
+		printf("ERROR: --burst-pattern sets the run length, it can't "
+		       "be used with --duration or --steady.\n");
+		return 1;
+	}
+	if ((opts->duration_ns || opts->steady_ns || opts->on_ns) &&
+	    (opts->warmup.frames || opts->warmup.ns || opts->cooldown.frames ||
+	     opts->cooldown.ns || opts->frametimes || opts->heatmap ||
+	     opts->heatmap_csv || opts->jitter || opts->trace_out)) {
+		printf("ERROR: --duration, --steady and --burst-pattern keep "
+		       "no per frame times, they can't be used with --warmup, "
+		       "--cooldown, --frametimes, --heatmap, --heatmap-csv, "
+		       "--jitter or --trace-out.\n");
+		return 1;
+	}
+	if ((opts->sweep.threads.cnt || opts->sweep.size.cnt) &&
+	    (opts->json || opts->baseline || opts->save_baseline)) {
+		printf("ERROR: --sweep can't be used with --json, --baseline "
+		       "or --save-baseline.\n");
+		return 1;
+	}
+	if (opts->sweep.size.cnt && !(opts->mode & TEST_WRITE)) {
+		printf("ERROR: size sweep needs a write test.\n");
+		return 1;
+	}
+	if (opts->sched && !opts->fps) {
+		printf("ERROR: --open-loop needs the frame rate with --fps.\n");
+		return 1;
+	}
+	if (opts->capacity && !opts->fps) {
+		printf("ERROR: --capacity needs the frame rate of a stream "
+		       "with --fps.\n");
+		return 1;
+	}
+	if (opts->capacity &&
+	    (opts->sweep.threads.cnt || opts->sweep.size.cnt || opts->json ||
+	     opts->baseline || opts->save_baseline)) {
+		printf("ERROR: --capacity can't be used with --sweep, --json, "
+		       "--baseline or --save-baseline.\n");
+		return 1;
+	}
+	if (opts->interfere.cnt &&
+	    (opts->sweep.threads.cnt || opts->sweep.size.cnt ||
+	     opts->capacity || opts->json || opts->baseline ||
+	     opts->save_baseline)) {
+		printf("ERROR: --interfere can't be used with --sweep, "
+		       "--capacity, --json, --baseline or --save-baseline.\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+/* Case of a job file with its options and results */
+typedef struct job_run_t {
+	const job_case_t *jc;
+	opts_t opts;
+	sweep_result_t results[2];
+	int cleanup;
+	uint64_t thread_id;
+	int started;
+	int res;
+} job_run_t;
+
+static int opt_is_flag(const struct option *opt)
+{
+	const char *c;
+
+	if (!opt->val)
+		return opt->has_arg == no_argument;
+	c = strchr(SHORT_OPTS, opt->val);
+
+	return c && c[1] != ':';
+}
+
+static int job_apply(opts_t *opts, const job_case_t *jc, const char *name)
+{
+	size_t i;
+	size_t j;
+
+	for (i = 0; i < jc->cnt; i++) {
+		const job_kv_t *kv = &jc->kv[i];
+		const struct option *opt = NULL;
+		int on = 1;
+		int res;
+
+		if (!strcmp(kv->key, "path")) {
+			opts->path = kv->value;
+			continue;
+		}
+		for (j = 0; long_opts[j].name; j++) {
+			if (!strcmp(long_opts[j].name, kv->key))
+				opt = &long_opts[j];
+		}
+		if (!opt || !strcmp(kv->key, "job")) {
+			fprintf(stderr, "Unknown option in job %s: %s\n", name,
+				kv->key);
+			return 1;
+		}
+		if (opt_is_flag(opt) && job_bool(kv->value, &on))
+			res = 1;
+		else if (!on)
+			continue;
+		else if (opt->val)
+			res = opt_parse_short(opts, opt->val, kv->value);
+		else
+			res = opt_parse_long(opts, opt->name, kv->value);
+		if (res) {
+			fprintf(stderr,
+				"Invalid argument for %s in job %s: %s\n",
+				kv->key, name, kv->value);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int job_prepare(job_run_t *run, const job_t *job, const opts_t *cmd)
+{
+	opts_t *opts = &run->opts;
+	const char *name = run->jc->name;
+
+	opts_init(opts);
+	opts->path = cmd->path;
+	opts->timer = cmd->timer;
+	if (job_apply(opts, &job->global, name) ||
+	    job_apply(opts, run->jc, name) || opts_check(opts))
+		return 1;
+	if (opts->json || opts->csv || opts->baseline || opts->save_baseline ||
+	    opts->sweep.threads.cnt || opts->sweep.size.cnt || opts->capacity ||
+	    opts->interfere.cnt) {
+		printf("ERROR: job %s: report format, --sweep, --capacity, "
+		       "--interfere and baselines are for the whole job, on "
+		       "the command line.\n",
+		       name);
+		return 1;
+	}
+	if (!opts->path) {
+		printf("ERROR: job %s: no path.\n", name);
+		return 1;
+	}
+	if (opts->backend_sim && *run->jc->group) {
+		/* All simulated tests share the one device model */
+		printf("ERROR: job %s: the simulated backend can't run in a "
+		       "concurrent group.\n", name);
+		return 1;
+	}
+	opts->quiet = 1;
+	opts->results = run->results;
+	run->cleanup = run->jc->cleanup < 0 ? job->global.cleanup :
+					      run->jc->cleanup;
+
+	return 0;
+}
+
+static int job_same_group(const job_run_t *a, const job_run_t *b)
+{
+	if (a == b)
+		return 1;
+
+	return *a->jc->group && !strcmp(a->jc->group, b->jc->group);
+}
+
+static void *job_run_thread(void *arg)
+{
+	job_run_t *run = arg;
+
+	run->res = run_tests(&run->opts);
+
+	return NULL;
+}
+
+/* Removes the frames written by the case */
+static void job_cleanup(const opts_t *opts)
+{
+	char name[PATH_MAX + 1];
+	size_t i;
+
+	if (opts->backend_sim || !(opts->mode & TEST_WRITE))
+		return;
+	if (opts->single_file) {
+		remove(opts->path);
+		return;
+	}
+	/* Writes without wrapping continue past the frame count */
+	for (i = 0; i < opts->frames || opts->no_wrap; i++) {
+		snprintf(name, PATH_MAX, "%s/frame%.6zu.tst", opts->path, i);
+		name[PATH_MAX] = 0;
+		if (remove(name) && i >= opts->frames)
+			break;
+	}
+}
+
+/* Frame buffer shared by the cases of a job needing the same frames */
+typedef struct job_frame_t {
+	frame_t *frm;
+	/* Path of the frames it was sized after, NULL if generated */
+	const char *path;
+	size_t header_size;
+	int sim;
+	/* Used by a case of the running group */
+	int busy;
+} job_frame_t;
+
+static int job_frame_match(const job_frame_t *jf, const opts_t *opts)
+{
+	const profile_t *prof = &jf->frm->profile;
+
+	if (frame_discovered(opts))
+		return jf->path && !strcmp(jf->path, opts->path) &&
+		       jf->header_size == opts->profile.header_size &&
+		       jf->sim == opts->backend_sim;
+
+	return !jf->path && prof->prof == opts->profile.prof &&
+	       !strcmp(prof->name, opts->profile.name) &&
+	       jf->frm->size == profile_size(&opts->profile);
+}
+
+/*
+ * Frame buffer for a case, reusing one of an earlier case instead of
+ * allocating and sizing it again. Cases running concurrently get their
+ * own. NULL leaves it to run_tests.
+ */
+static frame_t *job_frame(job_frame_t *frames, size_t cnt, opts_t *opts)
+{
+	const platform_t *platform = platform_get();
+	job_frame_t *free_jf = NULL;
+	size_t i;
+
+	if (resolve_profile(opts))
+		return NULL;
+	for (i = 0; i < cnt; i++) {
+		job_frame_t *jf = &frames[i];
+
+		if (!jf->frm) {
+			if (!free_jf)
+				free_jf = jf;
+			continue;
+		}
+		if (!jf->busy && job_frame_match(jf, opts)) {
+			jf->busy = 1;
+			return jf->frm;
+		}
+	}
+	if (!free_jf)
+		return NULL;
+
+	/* Memory of the simulated backend comes from the real platform */
+	if (opts->backend_sim && frame_discovered(opts))
+		platform = sim_platform_get(&opts->sim);
+	free_jf->frm = tests_frame(platform, opts);
+	if (!free_jf->frm)
+		return NULL;
+	free_jf->path = frame_discovered(opts) ? opts->path : NULL;
+	free_jf->header_size = opts->profile.header_size;
+	free_jf->sim = opts->backend_sim;
+	free_jf->busy = 1;
+
+	return free_jf->frm;
+}
+
+/*
+ * Frees the frames once the group is done. Frames sized after files a
+ * case wrote over are sized again when needed next time.
+ */
+static void job_frame_release(job_frame_t *frames, size_t cnt,
+			      const opts_t *opts)
+{
+	size_t i;
+
+	for (i = 0; (opts->mode & TEST_WRITE) && i < cnt; i++) {
+		job_frame_t *jf = &frames[i];
+
+		if (jf->frm && jf->path && !strcmp(jf->path, opts->path)) {
+			frame_destroy(platform_get(), jf->frm);
+			memset(jf, 0, sizeof(*jf));
+		}
+	}
+	for (i = 0; i < cnt; i++)
+		frames[i].busy = 0;
+}
+
+static int run_job(const opts_t *cmd)
+{
+	const platform_t *platform = platform_get();
+	job_run_t *runs = NULL;
+	job_frame_t *frames = NULL;
+	opts_t out = *cmd;
+	job_t job;
+	int res;
+	size_t i;
+	size_t j;
+	size_t k;
+
+	res = job_load(&job, cmd->job);
+	if (res) {
+		if (res < 0)
+			fprintf(stderr, "Can't read job file: %s\n", cmd->job);
+		else
+			fprintf(stderr, "Invalid job file %s at line %d\n",
+				cmd->job, res);
+		job_free(&job);
+		return 1;
+	}
+	runs = calloc(job.cnt, sizeof(*runs));
+	frames = calloc(job.cnt, sizeof(*frames));
+	if (!runs || !frames) {
+		free(runs);
+		free(frames);
+		job_free(&job);
+		return 1;
+	}
+	for (i = 0; i < job.cnt; i++) {
+		runs[i].jc = &job.cases[i];
+		if (job_prepare(&runs[i], &job, cmd)) {
+			res = 1;
+			goto out;
+		}
+	}
+
+	if (!out.path)
+		out.path = runs[0].opts.path;
+	print_job_header(&out);
+	for (i = 0; i < job.cnt; i++) {
+		const char *group = runs[i].jc->group;
+
+		if (runs[i].started)
+			continue;
+		/* Cases of the group run together where the first one is */
+		for (j = i; j < job.cnt; j++) {
+			if (!job_same_group(&runs[i], &runs[j]))
+				continue;
+			runs[j].started = 1;
+			runs[j].opts.frm = job_frame(frames, job.cnt,
+						     &runs[j].opts);
+			if (platform->thread_create(&runs[j].thread_id,
+						    job_run_thread, &runs[j])) {
+				runs[j].thread_id = 0;
+				runs[j].res = 1;
+			}
+		}
+		for (j = i; j < job.cnt; j++) {
+			if (!job_same_group(&runs[i], &runs[j]))
+				continue;
+			if (runs[j].thread_id)
+				platform->thread_join(runs[j].thread_id, NULL);
+			if (runs[j].res)
+				res = 1;
+			for (k = 0; k < runs[j].opts.results_cnt; k++)
+				print_job_result(&out, runs[j].jc->name, group,
+						 &runs[j].results[k]);
+			if (runs[j].cleanup)
+				job_cleanup(&runs[j].opts);
+		}
+		for (j = i; j < job.cnt; j++) {
+			if (job_same_group(&runs[i], &runs[j]))
+				job_frame_release(frames, job.cnt,
+						  &runs[j].opts);
+		}
+	}
+	print_job_footer(&out);
+
+out:
+	for (i = 0; i < job.cnt; i++)
+		frame_destroy(platform, frames[i].frm);
+	free(frames);
+	free(runs);
+	job_free(&job);
+
+	return res;
+}
+
 int main(int argc, char **argv)
 {
-	opts_t opts = { 0 };
+	opts_t opts;
 	int c = 0;
 	int opt_index = 0;
+	int res;
 
 	srand(time(NULL));
 	setvbuf(stdout, NULL, _IONBF, 0);
 	setvbuf(stderr, NULL, _IONBF, 0);
-	opts.threads = 1;
-	opts.frames = 1800;
-	opts.header_size = 65536;
+	opts_init(&opts);
 	while (1) {
-		c = getopt_long(argc, argv, "rw:elt:n:f:s:z:vmhVc", long_opts,
-				&opt_index);
+		c = getopt_long(argc, argv, SHORT_OPTS, long_opts, &opt_index);
 		if (c == -1)
 			break;
 
 		switch (c) {
 		case 0:
-			if (!strcmp(long_opts[opt_index].name, "no-csv-header"))
-				opts.no_csv_header = 1;
-			if (!strcmp(long_opts[opt_index].name, "histogram"))
-				opts.histogram = 1;
-			if (!strcmp(long_opts[opt_index].name, "times"))
-				opts.times = 1;
-			if (!strcmp(long_opts[opt_index].name, "frametimes"))
-				opts.frametimes = 1;
-			if (!strcmp(long_opts[opt_index].name, "header")) {
-				if (opt_parse_header_size(&opts, optarg))
-					goto invalid_long;
-			}
+			if (opt_parse_long(&opts, long_opts[opt_index].name,
+					   optarg))
+				goto invalid_long;
 			break;
 		case 'h':
 			usage(argv[0]);
 			return 1;
-		case 'c':
-			opts.csv = 1;
-			break;
-		case 'v':
-			opts.reverse = 1;
-			break;
-		case 'm':
-			opts.random = 1;
-			break;
-		case 'w':
-			if (opt_parse_write(&opts, optarg)) {
-				if (opt_parse_profile(&opts, optarg)) {
-					/* Could not parse profile, just skip */
-				}
-			}
-			opts.mode |= TEST_WRITE;
-			break;
-		case 'e':
-			opts.mode |= TEST_WRITE;
-			opts.mode |= TEST_EMPTY;
-			break;
-		case 'r':
-			opts.mode |= TEST_READ;
-			break;
-		case 's':
-			opts.single_file = 1;
-			opts.path = optarg;
-			break;
-		case 't':
-			if (opt_parse_threads(&opts, optarg))
-				goto invalid_short;
-			break;
-		case 'n':
-			if (opt_parse_num_frames(&opts, optarg))
-				goto invalid_short;
-			break;
-		case 'f':
-			if (opt_parse_limit_fps(&opts, optarg))
-				goto invalid_short;
-			break;
-		case 'z':
-			if (opt_parse_frame_size(&opts, optarg))
-				goto invalid_short;
-			break;
 		case 'l':
 			list_profiles();
 			return 0;
@@ -578,8 +2070,14 @@ int main(int argc, char **argv)
 			version();
 			return 0;
 		default:
-			printf("Invalid option: %c\n", c);
-			return 1;
+			res = opt_parse_short(&opts, c, optarg);
+			if (res < 0) {
+				printf("Invalid option: %c\n", c);
+				return 1;
+			}
+			if (res)
+				goto invalid_short;
+			break;
 		}
 	}
 	if (optind < argc) {
@@ -594,16 +2092,24 @@ int main(int argc, char **argv)
 			}
 		}
 	}
-	if (opts.random && opts.reverse) {
-		printf("ERROR: --random and --reverse are mutually exclusive, "
-		       "please define only one.\n");
-		usage(argv[0]);
+	if (opts_check(&opts))
+		return 1;
+	if (opts.job &&
+	    (opts.sweep.threads.cnt || opts.sweep.size.cnt || opts.capacity ||
+	     opts.interfere.cnt || opts.baseline || opts.save_baseline)) {
+		printf("ERROR: --job can't be used with --sweep, --capacity, "
+		       "--interfere, --baseline or --save-baseline.\n");
 		return 1;
 	}
-	if (!opts.path) {
+	if (!opts.path && !opts.job) {
 		usage(argv[0]);
 		return 1;
 	}
+	if (timing_init(opts.timer) != TIMING_TSC && opts.timer == TIMING_TSC)
+		fprintf(stderr, "Invariant TSC not available, using clock\n");
+
+	if (opts.job)
+		return run_job(&opts);
 
 	return run_tests(&opts);
 
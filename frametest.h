@@ -23,16 +23,57 @@
 
 #include "profile.h"
 #include "frame.h"
+#include "timing.h"
+#include "trace.h"
+#include "sim.h"
+#include "cpu.h"
+#include "perf.h"
+#include "stats.h"
+#include "sweep.h"
+#include "capacity.h"
+#include "interfere.h"
+#include <stdio.h>
 
 #define SEC_IN_NS 1000000000UL
 #define SEC_IN_MS (SEC_IN_NS / 1000UL)
 
+#define XSTRING(x) #x
+#define VERSION_STRING(a, b, c) XSTRING(a) "." XSTRING(b) "." XSTRING(c)
+#define FRAMETEST_VERSION VERSION_STRING(MAJOR, MINOR, PATCH)
+
 enum TestMode {
 	TEST_WRITE = 1 << 0,
 	TEST_READ = 1 << 1,
 	TEST_EMPTY = 1 << 2,
 };
 
+/* When frames are issued, closed loop is right after the previous one */
+enum Schedule {
+	SCHED_CLOSED = 0,
+	/* Open loop, due at fixed frame periods from the start */
+	SCHED_FIXED,
+	/* Open loop, exponentially distributed intervals */
+	SCHED_POISSON,
+	/* Open loop, bursts of frames at once every burst periods */
+	SCHED_BURST,
+};
+
+/* Shuttle, scrub and trick play access pattern, zero stride is none */
+typedef struct test_pattern_t {
+	/* Frames advanced per access, negative plays backwards */
+	long stride;
+	/* Multiplier of the frame rate */
+	double speed;
+	/* Frames played after every seek to a random frame, 0 never seeks */
+	size_t segment;
+} test_pattern_t;
+
+/* Part of a run excluded from the results, in frames or in time */
+typedef struct run_span_t {
+	size_t frames;
+	uint64_t ns;
+} run_span_t;
+
 typedef struct opts_t {
 	enum TestMode mode;
 
@@ -44,11 +85,60 @@ typedef struct opts_t {
 
 	frame_t *frm;
 	const char *path;
+	const char *frame_trace;
+	trace_t *trace;
+	const char *trace_out;
+	struct timeline_t *timeline;
+	const char *heatmap_csv;
+	FILE *heatmap_out;
 
 	size_t threads;
 	size_t frames;
 	size_t fps;
 	size_t header_size;
+	enum TimingSource timer;
+	sim_config_t sim;
+	/* Interval report and telemetry sampling period, 0 is off */
+	uint64_t interval_ns;
+	run_span_t warmup;
+	run_span_t cooldown;
+	/* Run length, looping over the frames, 0 runs them once */
+	uint64_t duration_ns;
+	/* Burst pattern, time on and off and number of bursts, 0 is off */
+	uint64_t on_ns;
+	uint64_t off_ns;
+	size_t bursts;
+	/* Steady state to measure before stopping, 0 is off */
+	uint64_t steady_ns;
+	/* Steady state variation limit in percent */
+	double steady_cv;
+	/* Configurations to try, and their latency limit, 0 is none */
+	sweep_t sweep;
+	uint64_t sweep_p99_ns;
+	/* Frame issue schedule with --fps, and frames per burst */
+	enum Schedule sched;
+	size_t burst;
+	test_pattern_t pattern;
+	/* Largest stream count of capacity search, 0 is off */
+	size_t capacity;
+	capacity_slo_t slo;
+	/* Background workers run next to the tests, none if cnt is 0 */
+	interfere_cfg_t interfere;
+	/* Job file to run instead of the options */
+	const char *job;
+	/* Results of the job cases, rows are added by run_tests */
+	sweep_result_t *results;
+	size_t results_cnt;
+	/* Stall watchdog threshold, 0 is off */
+	uint64_t watchdog_ns;
+	size_t repeat;
+	/* Number of slowest frames to show, 0 is off */
+	size_t slowest;
+	const char *baseline;
+	const char *save_baseline;
+	/* Regression limit in percent and significance level */
+	double threshold;
+	double alpha;
 
 	unsigned int reverse : 1;
 	unsigned int random : 1;
@@ -58,6 +148,17 @@ typedef struct opts_t {
 	unsigned int frametimes : 1;
 	unsigned int histogram : 1;
 	unsigned int single_file : 1;
+	unsigned int json : 1;
+	unsigned int per_thread : 1;
+	unsigned int backend_sim : 1;
+	unsigned int cpu : 1;
+	unsigned int perf : 1;
+	unsigned int heatmap : 1;
+	unsigned int jitter : 1;
+	unsigned int no_wrap : 1;
+	unsigned int capacity_bisect : 1;
+	/* Results are collected by the caller instead of printed */
+	unsigned int quiet : 1;
 } opts_t;
 
 typedef struct test_completion_t {
@@ -66,13 +167,93 @@ typedef struct test_completion_t {
 	uint64_t io;
 	uint64_t close;
 	uint64_t frame;
+	/* Frame number */
+	uint64_t num;
+	/* Thread CPU time spent on the frame, only with --cpu */
+	uint64_t cpu;
+	/* Time the frame was due in open loop runs, 0 otherwise */
+	uint64_t sched;
 } test_completion_t;
 
+enum CompletionStat {
+	COMP_FRAME = 0,
+	COMP_OPEN,
+	COMP_IO,
+	COMP_CLOSE,
+	COMP_CPU,
+	COMP_OFF_CPU,
+	/* From the time the frame was due, corrected for the backlog */
+	COMP_SCHED,
+	COMP_STAT_CNT,
+};
+
+static inline uint64_t completion_value(const test_completion_t *comp,
+					enum CompletionStat stat)
+{
+	switch (stat) {
+	case COMP_OPEN:
+		return comp->open - comp->start;
+	case COMP_IO:
+		return comp->io - comp->open;
+	case COMP_CLOSE:
+		return comp->close - comp->io;
+	case COMP_CPU:
+		return comp->cpu;
+	case COMP_OFF_CPU:
+		if (comp->frame - comp->start < comp->cpu)
+			return 0;
+		return comp->frame - comp->start - comp->cpu;
+	case COMP_SCHED:
+		if (!comp->sched)
+			return comp->frame - comp->start;
+		return comp->frame - comp->sched;
+	default:
+	case COMP_FRAME:
+		return comp->frame - comp->start;
+	}
+}
+
+/* Latencies of a burst pattern run */
+enum BurstStat {
+	/* First frames of bursts after idle */
+	BURST_FIRST = 0,
+	/* The other frames of bursts */
+	BURST_REST,
+	BURST_STAT_CNT,
+};
+
+/* Latencies of a trick play pattern run */
+enum SeekStat {
+	/* First frames after seeking, lag perceived by the user */
+	SEEK_FIRST = 0,
+	/* The frames played after them */
+	SEEK_REST,
+	SEEK_STAT_CNT,
+};
+
 typedef struct test_result_t {
 	uint64_t frames_written;
 	uint64_t bytes_written;
 	uint64_t time_taken_ns;
+	/* Frames completed after their deadline, only with an fps limit */
+	uint64_t late;
+	/* Timestamps of the first frame start and last frame completion */
+	uint64_t started;
+	uint64_t finished;
+	/* Thread CPU time, and process usage for aggregated results */
+	uint64_t cpu_ns;
+	cpu_usage_t usage;
+	perf_counters_t perf;
 	test_completion_t *completion;
+	/*
+	 * Statistics of every COMP_* value, used instead of completion in
+	 * duration runs to keep the memory use bounded
+	 */
+	stats_t *stats;
+	/* BURST_* latencies, only with a burst pattern */
+	stats_t *burst;
+	/* SEEK_* latencies, only with a trick play pattern */
+	stats_t *seek;
 } test_result_t;
 
 #endif
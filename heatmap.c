@@ -0,0 +1,210 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "heatmap.h"
+
+/* Glyphs by increasing density, log scaled to the busiest cell */
+static const char heatmap_glyphs[] = " .:-=+*#%@";
+#define HEATMAP_GLYPHS (sizeof(heatmap_glyphs) - 1)
+
+void heatmap_init(heatmap_t *hm, uint64_t start)
+{
+	memset(hm, 0, sizeof(*hm));
+	hm->start = start;
+	hm->window_ns = HEATMAP_WINDOW_NS;
+}
+
+size_t heatmap_row(uint64_t lat)
+{
+	size_t row = 0;
+
+	lat >>= HEATMAP_MIN_SHIFT - 1;
+	while (lat > 1 && row < HEATMAP_ROWS - 1) {
+		lat >>= 1;
+		++row;
+	}
+
+	return row;
+}
+
+uint64_t heatmap_row_max(size_t row)
+{
+	if (row >= HEATMAP_ROWS - 1)
+		return UINT64_MAX;
+	return (1ULL << (HEATMAP_MIN_SHIFT + row)) - 1;
+}
+
+/* Halve the resolution by merging neighbouring windows */
+static void heatmap_shrink(heatmap_t *hm)
+{
+	size_t i;
+	size_t j;
+
+	for (i = 0; i < HEATMAP_MAX_COLS / 2; i++) {
+		for (j = 0; j < HEATMAP_ROWS; j++)
+			hm->cnt[i][j] = hm->cnt[2 * i][j] +
+					hm->cnt[2 * i + 1][j];
+	}
+	memset(hm->cnt[HEATMAP_MAX_COLS / 2], 0,
+	       sizeof(hm->cnt[0]) * (HEATMAP_MAX_COLS / 2));
+	hm->window_ns *= 2;
+	hm->cols = (hm->cols + 1) / 2;
+}
+
+void heatmap_add(heatmap_t *hm, uint64_t time, uint64_t lat)
+{
+	uint64_t col;
+
+	time = time > hm->start ? time - hm->start : 0;
+	col = time / hm->window_ns;
+	while (col >= HEATMAP_MAX_COLS) {
+		heatmap_shrink(hm);
+		col = time / hm->window_ns;
+	}
+
+	++hm->cnt[col][heatmap_row(lat)];
+	if (col >= hm->cols)
+		hm->cols = col + 1;
+}
+
+void heatmap_add_results(heatmap_t *hm, const test_result_t *thread_res,
+			 size_t threads)
+{
+	size_t i;
+	uint64_t j;
+
+	for (i = 0; i < threads; i++) {
+		const test_result_t *res = &thread_res[i];
+
+		for (j = 0; res->completion && j < res->frames_written; j++) {
+			const test_completion_t *c = &res->completion[j];
+
+			heatmap_add(hm, c->frame, c->frame - c->start);
+		}
+	}
+}
+
+static void heatmap_label(char *buf, size_t len, uint64_t ns)
+{
+	if (ns == UINT64_MAX)
+		snprintf(buf, len, "inf");
+	else if (ns < 1000)
+		snprintf(buf, len, "%" PRIu64 "ns", ns);
+	else if (ns < 1000000)
+		snprintf(buf, len, "%.3gus", ns / 1e3);
+	else if (ns < 1000000000)
+		snprintf(buf, len, "%.3gms", ns / 1e6);
+	else
+		snprintf(buf, len, "%.3gs", ns / 1e9);
+}
+
+void heatmap_print(const heatmap_t *hm, const char *tcase)
+{
+	uint64_t cells[HEATMAP_WIDTH][HEATMAP_ROWS] = { { 0 } };
+	size_t group;
+	size_t width;
+	size_t lo = HEATMAP_ROWS;
+	size_t hi = 0;
+	uint64_t max = 0;
+	size_t i;
+	size_t j;
+
+	if (!hm->cols)
+		return;
+
+	/* Squeeze the windows to fit the terminal */
+	group = (hm->cols + HEATMAP_WIDTH - 1) / HEATMAP_WIDTH;
+	width = (hm->cols + group - 1) / group;
+	for (i = 0; i < hm->cols; i++) {
+		for (j = 0; j < HEATMAP_ROWS; j++)
+			cells[i / group][j] += hm->cnt[i][j];
+	}
+	for (i = 0; i < width; i++) {
+		for (j = 0; j < HEATMAP_ROWS; j++) {
+			if (!cells[i][j])
+				continue;
+			if (j < lo)
+				lo = j;
+			if (j > hi)
+				hi = j;
+			if (cells[i][j] > max)
+				max = cells[i][j];
+		}
+	}
+	if (!max)
+		return;
+
+	printf("\nHeatmap %s (%.1lf ms per column):\n", tcase,
+	       (double)hm->window_ns * group / SEC_IN_MS);
+	for (j = hi + 1; j-- > lo;) {
+		char label[16];
+
+		heatmap_label(label, sizeof(label), heatmap_row_max(j));
+		printf("%8s |", label);
+		for (i = 0; i < width; i++) {
+			size_t g = 0;
+
+			if (cells[i][j] && max > 1)
+				g = 1 + (size_t)((HEATMAP_GLYPHS - 2) *
+						 log((double)cells[i][j]) /
+						 log((double)max));
+			else if (cells[i][j])
+				g = HEATMAP_GLYPHS - 1;
+			printf("%c", heatmap_glyphs[g]);
+		}
+		printf("\n");
+	}
+	printf("%8s +", "");
+	for (i = 0; i < width; i++)
+		printf("-");
+	printf("\n%8s  0s%*s%.1lfs\n", "", (int)(width > 6 ? width - 6 : 0),
+	       "", (double)hm->window_ns * hm->cols / SEC_IN_NS);
+}
+
+void heatmap_write_csv_header(FILE *f)
+{
+	size_t j;
+
+	/* Columns are named by upper limit of the row in ns */
+	fprintf(f, "case,start_ms,end_ms");
+	for (j = 0; j < HEATMAP_ROWS - 1; j++)
+		fprintf(f, ",le_%" PRIu64, heatmap_row_max(j));
+	fprintf(f, ",le_inf\n");
+}
+
+void heatmap_write_csv(FILE *f, const heatmap_t *hm, const char *tcase)
+{
+	size_t i;
+	size_t j;
+
+	for (i = 0; i < hm->cols; i++) {
+		fprintf(f, "%s,%.3lf,%.3lf", tcase,
+			(double)hm->window_ns * i / SEC_IN_MS,
+			(double)hm->window_ns * (i + 1) / SEC_IN_MS);
+		for (j = 0; j < HEATMAP_ROWS; j++)
+			fprintf(f, ",%" PRIu64, hm->cnt[i][j]);
+		fprintf(f, "\n");
+	}
+}
@@ -0,0 +1,63 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_HEATMAP_H
+#define FRAMETEST_HEATMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "frametest.h"
+
+/*
+ * Frame latency over time. Rows are power of two latency buckets, the
+ * first one holds everything below 2^HEATMAP_MIN_SHIFT ns and the last one
+ * is open ended. Columns are time windows by frame completion. When the
+ * run outgrows HEATMAP_MAX_COLS windows, neighbouring windows are merged
+ * and the window doubles, so memory stays fixed however long the run is.
+ */
+#define HEATMAP_MIN_SHIFT 10
+#define HEATMAP_ROWS 25
+#define HEATMAP_MAX_COLS 256
+#define HEATMAP_WINDOW_NS (10 * SEC_IN_MS)
+/* Columns of the terminal rendering */
+#define HEATMAP_WIDTH 64
+
+typedef struct heatmap_t {
+	uint64_t start;
+	uint64_t window_ns;
+	size_t cols;
+	uint64_t cnt[HEATMAP_MAX_COLS][HEATMAP_ROWS];
+} heatmap_t;
+
+void heatmap_init(heatmap_t *hm, uint64_t start);
+void heatmap_add(heatmap_t *hm, uint64_t time, uint64_t lat);
+void heatmap_add_results(heatmap_t *hm, const test_result_t *thread_res,
+			 size_t threads);
+
+size_t heatmap_row(uint64_t lat);
+/* Upper limit of the row, UINT64_MAX for the last one */
+uint64_t heatmap_row_max(size_t row);
+
+void heatmap_print(const heatmap_t *hm, const char *tcase);
+void heatmap_write_csv_header(FILE *f);
+void heatmap_write_csv(FILE *f, const heatmap_t *hm, const char *tcase);
+
+#endif
@@ -75,23 +75,39 @@ static inline size_t time_get_sub_bucket(size_t bucket, uint64_t time)
 	return (time * SUB_BUCKET_CNT) / (max - min + 1);
 }
 
+static inline void hist_add(uint64_t *cnts, uint64_t frametime, uint64_t cnt)
+{
+	size_t b = time_get_bucket(frametime);
+	size_t sb = time_get_sub_bucket(b, frametime);
+
+	cnts[b * SUB_BUCKET_CNT + sb] += cnt;
+}
+
 static inline void hist_collect_cnts(const test_result_t *res, uint64_t *cnts)
 {
 	size_t i;
 
+	/* Without completions use the lower edges of the statistics buckets */
+	if (!res->completion) {
+		const stats_t *st = &res->stats[COMP_FRAME];
+
+		for (i = 0; i < STATS_BUCKETS; i++) {
+			if (st->buckets[i])
+				hist_add(cnts, stats_bucket_min(i),
+					 st->buckets[i]);
+		}
+		return;
+	}
+
 	/*
 	 * Categorize the completion times in buckets and sub buckets.
 	 * Every bucket has SUB_BUCKET_CNT sub buckets, so divide the result
 	 * into proper one.
 	 */
-	for (i = 0; i < res->frames_written; i++) {
-		size_t frametime =
-			res->completion[i].frame - res->completion[i].start;
-		size_t b = time_get_bucket(frametime);
-		size_t sb = time_get_sub_bucket(b, frametime);
-
-		++cnts[b * SUB_BUCKET_CNT + sb];
-	}
+	for (i = 0; i < res->frames_written; i++)
+		hist_add(cnts,
+			 res->completion[i].frame - res->completion[i].start,
+			 1);
 }
 
 static inline uint64_t hist_cnts_max(uint64_t *cnts, size_t sbcnt)
@@ -112,6 +128,42 @@ static inline size_t hist_cnts(void)
 	return SUB_BUCKET_CNT * buckets_cnt;
 }
 
+size_t histogram_size(void)
+{
+	return hist_cnts();
+}
+
+void histogram_collect(const test_result_t *res, uint64_t *cnts)
+{
+	if (!res || (!res->completion && !res->stats) || !cnts)
+		return;
+
+	hist_collect_cnts(res, cnts);
+}
+
+void histogram_range(size_t idx, uint64_t *min, uint64_t *max)
+{
+	size_t b = idx / SUB_BUCKET_CNT;
+	size_t sb = idx % SUB_BUCKET_CNT;
+	uint64_t bmin;
+	uint64_t width;
+
+	if (b + 1 >= buckets_cnt) {
+		/* The last bucket has no upper limit */
+		*min = buckets[buckets_cnt - 1];
+		*max = UINT64_MAX;
+		return;
+	}
+
+	bmin = buckets[b];
+	width = buckets[b + 1] - bmin + 1;
+
+	/* Inverse of time_get_sub_bucket() */
+	*min = bmin + (sb * width + SUB_BUCKET_CNT - 1) / SUB_BUCKET_CNT;
+	*max = bmin +
+	       ((sb + 1) * width + SUB_BUCKET_CNT - 1) / SUB_BUCKET_CNT - 1;
+}
+
 void print_histogram(const test_result_t *res)
 {
 	uint64_t cnts[SUB_BUCKET_CNT * (buckets_cnt + 1)] = { 0 };
@@ -119,7 +171,7 @@ void print_histogram(const test_result_t *res)
 	size_t i, j;
 	size_t sbcnt;
 
-	if (!res->completion)
+	if (!res->completion && !res->stats)
 		return;
 
 	sbcnt = hist_cnts();
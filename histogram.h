@@ -25,4 +25,8 @@
 
 extern void print_histogram(const test_result_t *res);
 
+extern size_t histogram_size(void);
+extern void histogram_collect(const test_result_t *res, uint64_t *cnts);
+extern void histogram_range(size_t idx, uint64_t *min, uint64_t *max);
+
 #endif
@@ -0,0 +1,369 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "interfere.h"
+#include "timing.h"
+
+#define INTERFERE_SEC_NS 1000000000ULL
+/* Direct I/O alignment, block sizes must be multiples of it */
+#define INTERFERE_ALIGN 4096
+/* Write size of filling the scratch files */
+#define INTERFERE_FILL_SIZE (1024 * 1024)
+/* Longest sleep of rate limiting, so stopping isn't delayed */
+#define INTERFERE_SLEEP_US 10000
+#define INTERFERE_RNG_MUL 0x9e3779b97f4a7c15ULL
+
+static const char *interfere_names[] = {
+	[INTERFERE_RAND_READ] = "randread",
+	[INTERFERE_RAND_WRITE] = "randwrite",
+	[INTERFERE_SCAN] = "scan",
+	[INTERFERE_META] = "meta",
+};
+#define INTERFERE_TYPES (sizeof(interfere_names) / sizeof(interfere_names[0]))
+
+const char *interfere_name(enum InterfereType type)
+{
+	return interfere_names[type];
+}
+
+static int interfere_parse_num(const char *str, size_t *val, int size)
+{
+	char *endp = NULL;
+	unsigned long long num;
+
+	if (*str < '0' || *str > '9')
+		return 1;
+	num = strtoull(str, &endp, 10);
+	if (size && (*endp == 'k' || *endp == 'K')) {
+		num *= 1024;
+		endp++;
+	} else if (size && (*endp == 'm' || *endp == 'M')) {
+		num *= 1024 * 1024;
+		endp++;
+	}
+	if (*endp)
+		return 1;
+	*val = num;
+
+	return 0;
+}
+
+int interfere_parse(interfere_cfg_t *cfg, const char *str)
+{
+	char buf[256];
+	char *tok;
+	char *save = NULL;
+
+	if (!cfg || !str)
+		return 1;
+	if (snprintf(buf, sizeof(buf), "%s", str) >= (int)sizeof(buf))
+		return 1;
+
+	memset(cfg, 0, sizeof(*cfg));
+	for (tok = strtok_r(buf, ",", &save); tok;
+	     tok = strtok_r(NULL, ",", &save)) {
+		interfere_spec_t *spec;
+		char *bs = strchr(tok, ':');
+		char *rate = NULL;
+		size_t i;
+
+		if (cfg->cnt >= INTERFERE_MAX)
+			return 1;
+		spec = &cfg->specs[cfg->cnt++];
+		if (bs) {
+			*bs++ = 0;
+			rate = strchr(bs, ':');
+			if (rate)
+				*rate++ = 0;
+		}
+		for (i = 0; i < INTERFERE_TYPES; i++) {
+			if (!strcmp(tok, interfere_names[i]))
+				break;
+		}
+		if (i == INTERFERE_TYPES)
+			return 1;
+		spec->type = (enum InterfereType)i;
+		spec->bs = i == INTERFERE_SCAN ? INTERFERE_FILL_SIZE :
+						 INTERFERE_ALIGN;
+		if (spec->type == INTERFERE_META) {
+			/* Only the rate */
+			if (rate)
+				return 1;
+			rate = bs;
+			bs = NULL;
+			spec->bs = 0;
+		}
+		if (bs && (interfere_parse_num(bs, &spec->bs, 1) || !spec->bs ||
+			   spec->bs % INTERFERE_ALIGN ||
+			   spec->bs > INTERFERE_FILE_SIZE))
+			return 1;
+		if (rate && interfere_parse_num(rate, &spec->rate, 0))
+			return 1;
+	}
+
+	return cfg->cnt ? 0 : 1;
+}
+
+static inline uint64_t interfere_random(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+
+	return *state;
+}
+
+/* Creates, stats and removes a file */
+static int interfere_meta(interfere_worker_t *w)
+{
+	const interfere_t *bg = w->bg;
+	char name[INTERFERE_NAME_MAX];
+	platform_stat_t st;
+	platform_handle_t f;
+	int res;
+
+	res = snprintf(name, sizeof(name), "%s%zu-%" PRIu64 ".tst",
+		       bg->prefix, w->id, w->ops + w->errors);
+	if (res < 0 || res >= (int)sizeof(name))
+		return 1;
+	f = bg->platform->open(name,
+			       PLATFORM_OPEN_CREATE | PLATFORM_OPEN_WRITE,
+			       0666);
+	if (f <= 0)
+		return 1;
+	res = bg->platform->close(f) != 0;
+	if (bg->platform->stat(name, &st))
+		res = 1;
+	if (bg->remove && bg->remove(name))
+		res = 1;
+
+	return res;
+}
+
+int interfere_op(interfere_worker_t *w)
+{
+	const platform_t *platform = w->bg->platform;
+	const interfere_spec_t *spec = w->spec;
+	platform_off_t off;
+	size_t ret;
+
+	switch (spec->type) {
+	case INTERFERE_META:
+		return interfere_meta(w);
+	case INTERFERE_SCAN:
+		if (w->pos + spec->bs > INTERFERE_FILE_SIZE)
+			w->pos = 0;
+		off = w->pos;
+		w->pos += spec->bs;
+		break;
+	default:
+		off = interfere_random(&w->rng) %
+		      (INTERFERE_FILE_SIZE / spec->bs) * spec->bs;
+		break;
+	}
+
+	if (platform->seek(w->f, off, PLATFORM_SEEK_SET) != off)
+		return 1;
+	if (spec->type == INTERFERE_RAND_WRITE)
+		ret = platform->write(w->f, w->buf, spec->bs);
+	else
+		ret = platform->read(w->f, w->buf, spec->bs);
+
+	return ret != spec->bs;
+}
+
+static void *interfere_thread(void *arg)
+{
+	interfere_worker_t *w = arg;
+	const interfere_t *bg = w->bg;
+	uint64_t period = w->spec->rate ? INTERFERE_SEC_NS / w->spec->rate : 0;
+	uint64_t due = timing_time();
+
+	while (!bg->stop) {
+		uint64_t now = timing_time();
+
+		if (now < due) {
+			uint64_t us = (due - now) / 1000;
+
+			bg->platform->usleep(us < INTERFERE_SLEEP_US ?
+						     us :
+						     INTERFERE_SLEEP_US);
+			continue;
+		}
+		if (interfere_op(w))
+			w->errors++;
+		else
+			w->ops++;
+		/* No catching up after falling behind, it would be a burst */
+		due += period;
+		if (due < now)
+			due = now;
+	}
+
+	return NULL;
+}
+
+/* Scratch file filled up front, so that reads hit the storage */
+static int interfere_worker_init(interfere_t *bg, size_t i)
+{
+	const platform_t *platform = bg->platform;
+	interfere_worker_t *w = &bg->workers[i];
+	size_t size;
+	size_t done;
+	int len;
+
+	w->bg = bg;
+	w->spec = &bg->cfg.specs[i];
+	w->id = i;
+	w->rng = (i + 1) * INTERFERE_RNG_MUL;
+	if (w->spec->type == INTERFERE_META)
+		return 0;
+
+	len = snprintf(w->name, sizeof(w->name), "%s%zu.tst", bg->prefix, i);
+	if (len < 0 || len >= (int)sizeof(w->name))
+		return 1;
+	size = w->spec->bs > INTERFERE_FILL_SIZE ? w->spec->bs :
+						   INTERFERE_FILL_SIZE;
+	if (platform->aligned_alloc((void **)&w->buf, INTERFERE_ALIGN, size)) {
+		w->buf = NULL;
+		return 1;
+	}
+	memset(w->buf, 0xa5, size);
+
+	w->f = platform->open(w->name,
+			      PLATFORM_OPEN_CREATE | PLATFORM_OPEN_READ |
+				      PLATFORM_OPEN_WRITE |
+				      PLATFORM_OPEN_DIRECT,
+			      0666);
+	if (w->f <= 0) {
+		w->f = 0;
+		return 1;
+	}
+	for (done = 0; done < INTERFERE_FILE_SIZE; done += size) {
+		if (platform->write(w->f, w->buf, size) != size)
+			return 1;
+	}
+
+	return 0;
+}
+
+int interfere_init(interfere_t *bg, const platform_t *platform,
+		   const char *prefix, const interfere_cfg_t *cfg,
+		   int (*remove)(const char *name))
+{
+	size_t i;
+	int len;
+
+	memset(bg, 0, sizeof(*bg));
+	bg->platform = platform;
+	bg->cfg = *cfg;
+	bg->remove = remove;
+	len = snprintf(bg->prefix, sizeof(bg->prefix), "%s", prefix);
+	if (len < 0 || len >= (int)sizeof(bg->prefix))
+		return 1;
+
+	bg->workers = platform->calloc(cfg->cnt, sizeof(*bg->workers));
+	if (!bg->workers)
+		return 1;
+	bg->cnt = cfg->cnt;
+	for (i = 0; i < bg->cnt; i++) {
+		if (interfere_worker_init(bg, i))
+			return 1;
+	}
+
+	return 0;
+}
+
+int interfere_start(interfere_t *bg)
+{
+	size_t i;
+
+	bg->stop = 0;
+	bg->start = timing_start();
+	for (i = 0; i < bg->cnt; i++) {
+		interfere_worker_t *w = &bg->workers[i];
+
+		w->ops = 0;
+		w->errors = 0;
+		if (bg->platform->thread_create(&w->thread, interfere_thread,
+						w)) {
+			interfere_stop(bg);
+			return 1;
+		}
+		w->running = 1;
+	}
+
+	return 0;
+}
+
+void interfere_stop(interfere_t *bg)
+{
+	size_t i;
+
+	bg->stop = 1;
+	for (i = 0; i < bg->cnt; i++) {
+		interfere_worker_t *w = &bg->workers[i];
+		void *ret;
+
+		if (!w->running)
+			continue;
+		bg->platform->thread_join(w->thread, &ret);
+		w->running = 0;
+	}
+	bg->elapsed = timing_elapsed(bg->start);
+}
+
+void interfere_free(interfere_t *bg)
+{
+	size_t i;
+
+	for (i = 0; bg->workers && i < bg->cnt; i++) {
+		interfere_worker_t *w = &bg->workers[i];
+
+		if (w->f > 0) {
+			bg->platform->close(w->f);
+			if (bg->remove)
+				bg->remove(w->name);
+		}
+		bg->platform->free(w->buf);
+	}
+	if (bg->workers)
+		bg->platform->free(bg->workers);
+	bg->workers = NULL;
+	bg->cnt = 0;
+}
+
+double interfere_rate(const interfere_t *bg, size_t i)
+{
+	if (i >= bg->cnt || !bg->elapsed)
+		return 0;
+
+	return (double)bg->workers[i].ops * INTERFERE_SEC_NS / bg->elapsed;
+}
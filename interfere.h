@@ -0,0 +1,113 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_INTERFERE_H
+#define FRAMETEST_INTERFERE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "platform.h"
+
+#define INTERFERE_MAX 8
+#define INTERFERE_NAME_MAX 1024
+/* Size of the scratch file of random I/O and scan workers */
+#define INTERFERE_FILE_SIZE (64 * 1024 * 1024)
+
+enum InterfereType {
+	INTERFERE_RAND_READ,
+	INTERFERE_RAND_WRITE,
+	INTERFERE_SCAN,
+	INTERFERE_META,
+};
+
+typedef struct interfere_spec_t {
+	enum InterfereType type;
+	/* Block size, unused by metadata storm */
+	size_t bs;
+	/* Operations per second, 0 is as fast as possible */
+	size_t rate;
+} interfere_spec_t;
+
+typedef struct interfere_cfg_t {
+	size_t cnt;
+	interfere_spec_t specs[INTERFERE_MAX];
+} interfere_cfg_t;
+
+struct interfere_t;
+
+/* Background worker running one pattern */
+typedef struct interfere_worker_t {
+	struct interfere_t *bg;
+	const interfere_spec_t *spec;
+	size_t id;
+	uint64_t thread;
+	int running;
+
+	char name[INTERFERE_NAME_MAX];
+	platform_handle_t f;
+	char *buf;
+	uint64_t rng;
+	uint64_t pos;
+	uint64_t ops;
+	uint64_t errors;
+} interfere_worker_t;
+
+/*
+ * Background workers generating interference next to the tested frame
+ * streams: random small block reads or writes and a sequential scan over
+ * a scratch file each, or a metadata storm creating, stating and removing
+ * files. Files are named by the prefix.
+ */
+typedef struct interfere_t {
+	const platform_t *platform;
+	interfere_cfg_t cfg;
+	char prefix[INTERFERE_NAME_MAX];
+	/* There's no unlink in the platform, NULL leaves files in place */
+	int (*remove)(const char *name);
+	volatile int stop;
+
+	size_t cnt;
+	interfere_worker_t *workers;
+	uint64_t start;
+	uint64_t elapsed;
+} interfere_t;
+
+/*
+ * Comma separated patterns: randread[:BS[:IOPS]], randwrite[:BS[:IOPS]],
+ * scan[:BS[:IOPS]] and meta[:OPS], sizes with k and m suffixes
+ */
+int interfere_parse(interfere_cfg_t *cfg, const char *str);
+const char *interfere_name(enum InterfereType type);
+
+/* Creates the scratch files */
+int interfere_init(interfere_t *bg, const platform_t *platform,
+		   const char *prefix, const interfere_cfg_t *cfg,
+		   int (*remove)(const char *name));
+int interfere_start(interfere_t *bg);
+void interfere_stop(interfere_t *bg);
+/* Removes the scratch files */
+void interfere_free(interfere_t *bg);
+
+/* One operation of the worker's pattern, returns non-zero on error */
+int interfere_op(interfere_worker_t *w);
+/* Operations per second of a worker in the last run */
+double interfere_rate(const interfere_t *bg, size_t i);
+
+#endif
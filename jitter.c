@@ -0,0 +1,115 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "jitter.h"
+
+#define JITTER_NONE UINT64_MAX
+
+size_t jitter_bin(uint64_t interval, uint64_t period)
+{
+	uint64_t bin;
+
+	if (!period)
+		return 0;
+
+	/* Rounded to the nearest whole number of periods */
+	bin = (interval + period / 2) / period;
+
+	return bin < JITTER_BINS - 1 ? bin : JITTER_BINS - 1;
+}
+
+int jitter_collect(jitter_t *jt, const test_result_t *thread_res,
+		   size_t thread_cnt, uint64_t period)
+{
+	uint64_t first = UINT64_MAX;
+	uint64_t last = 0;
+	uint64_t *done;
+	uint64_t delivered = 0;
+	uint64_t prev = 0;
+	uint64_t cnt;
+	uint64_t i;
+	size_t t;
+
+	memset(jt, 0, sizeof(*jt));
+	stats_init(&jt->st);
+
+	for (t = 0; t < thread_cnt; t++) {
+		const test_result_t *res = &thread_res[t];
+
+		for (i = 0; res->completion && i < res->frames_written; i++) {
+			uint64_t num = res->completion[i].num;
+
+			if (num < first)
+				first = num;
+			if (num > last)
+				last = num;
+		}
+	}
+	if (first >= last)
+		return 1;
+
+	cnt = last - first + 1;
+	done = calloc(cnt, sizeof(*done));
+	if (!done)
+		return 1;
+	for (t = 0; t < thread_cnt; t++) {
+		const test_result_t *res = &thread_res[t];
+
+		for (i = 0; res->completion && i < res->frames_written; i++) {
+			const test_completion_t *c = &res->completion[i];
+
+			done[c->num - first] = c->frame;
+		}
+	}
+
+	/* Replace completion times with delivery intervals */
+	for (i = 0; i < cnt; i++) {
+		uint64_t iv = JITTER_NONE;
+
+		/* Frames which failed are skipped by the player */
+		if (!done[i]) {
+			done[i] = JITTER_NONE;
+			continue;
+		}
+		if (done[i] > delivered)
+			delivered = done[i];
+		if (prev) {
+			iv = delivered - prev;
+			stats_add(&jt->st, iv);
+			if (iv >= jt->st.max)
+				jt->max_gap_frame = first + i;
+		}
+		prev = delivered;
+		done[i] = iv;
+	}
+
+	jt->nominal = period ? 1 : 0;
+	jt->period = period ? period : (uint64_t)stats_mean(&jt->st);
+	for (i = 0; i < cnt; i++) {
+		if (done[i] != JITTER_NONE)
+			++jt->bins[jitter_bin(done[i], jt->period)];
+	}
+	free(done);
+
+	return jt->st.cnt ? 0 : 1;
+}
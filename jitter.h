@@ -0,0 +1,52 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_JITTER_H
+#define FRAMETEST_JITTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "frametest.h"
+#include "stats.h"
+
+/*
+ * Intervals between frame deliveries as a player consuming the frames in
+ * frame number order sees them: a frame is delivered once it and all the
+ * frames before it are complete. Histogram bins count intervals in whole
+ * frame periods, so bin 1 is on time and bin 3 means two frames late.
+ */
+#define JITTER_BINS 8
+
+typedef struct jitter_t {
+	stats_t st;
+	/* Nominal frame period, or the mean interval without --fps */
+	uint64_t period;
+	unsigned int nominal : 1;
+	uint64_t bins[JITTER_BINS];
+	/* Frame delivered after the longest gap */
+	uint64_t max_gap_frame;
+} jitter_t;
+
+/* Returns non-zero if there were fewer than two frames */
+int jitter_collect(jitter_t *jt, const test_result_t *thread_res,
+		   size_t thread_cnt, uint64_t period);
+size_t jitter_bin(uint64_t interval, uint64_t period);
+
+#endif
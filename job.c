@@ -0,0 +1,173 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "job.h"
+
+static char *job_trim(char *str)
+{
+	char *end;
+
+	while (isspace((unsigned char)*str))
+		str++;
+	end = str + strlen(str);
+	while (end > str && isspace((unsigned char)end[-1]))
+		*--end = 0;
+
+	return str;
+}
+
+int job_bool(const char *str, int *val)
+{
+	if (!*str || !strcmp(str, "1") || !strcmp(str, "yes") ||
+	    !strcmp(str, "true"))
+		*val = 1;
+	else if (!strcmp(str, "0") || !strcmp(str, "no") ||
+		 !strcmp(str, "false"))
+		*val = 0;
+	else
+		return 1;
+
+	return 0;
+}
+
+static job_case_t *job_section(job_t *job, const char *name)
+{
+	job_case_t *cases;
+	size_t i;
+
+	if (!*name || strlen(name) >= JOB_MAX_NAME)
+		return NULL;
+	if (!strcmp(name, "global"))
+		return &job->global;
+	for (i = 0; i < job->cnt; i++) {
+		if (!strcmp(job->cases[i].name, name))
+			return NULL;
+	}
+
+	cases = realloc(job->cases, (job->cnt + 1) * sizeof(*cases));
+	if (!cases)
+		return NULL;
+	job->cases = cases;
+	memset(&cases[job->cnt], 0, sizeof(*cases));
+	strcpy(cases[job->cnt].name, name);
+	cases[job->cnt].cleanup = -1;
+
+	return &cases[job->cnt++];
+}
+
+static int job_add(job_case_t *sect, char *key, char *val)
+{
+	job_kv_t *kv;
+
+	if (!*key || strlen(key) >= JOB_MAX_NAME ||
+	    strlen(val) >= JOB_MAX_VALUE)
+		return 1;
+	if (!strcmp(key, "group")) {
+		if (strlen(val) >= JOB_MAX_NAME)
+			return 1;
+		strcpy(sect->group, val);
+		return 0;
+	}
+	if (!strcmp(key, "cleanup"))
+		return job_bool(val, &sect->cleanup);
+	if (sect->cnt == JOB_MAX_KEYS)
+		return 1;
+
+	kv = &sect->kv[sect->cnt++];
+	strcpy(kv->key, key);
+	strcpy(kv->value, val);
+
+	return 0;
+}
+
+int job_parse(job_t *job, FILE *f)
+{
+	char buf[JOB_MAX_NAME + JOB_MAX_VALUE + 2];
+	job_case_t *sect = NULL;
+	int line = 0;
+
+	if (!job || !f)
+		return -1;
+	memset(job, 0, sizeof(*job));
+
+	while (fgets(buf, sizeof(buf), f)) {
+		char *str;
+		char *val;
+
+		line++;
+		if (!strchr(buf, '\n') && !feof(f))
+			return line;
+		str = job_trim(buf);
+		if (!*str || *str == '#' || *str == ';')
+			continue;
+
+		if (*str == '[') {
+			char *end = strchr(str, ']');
+
+			if (!end || end[1])
+				return line;
+			*end = 0;
+			sect = job_section(job, job_trim(str + 1));
+			if (!sect)
+				return line;
+			continue;
+		}
+		if (!sect)
+			return line;
+
+		val = strchr(str, '=');
+		if (val)
+			*val++ = 0;
+		if (job_add(sect, job_trim(str), val ? job_trim(val) : ""))
+			return line;
+	}
+	if (!job->cnt)
+		return line ? line : 1;
+
+	return 0;
+}
+
+int job_load(job_t *job, const char *fname)
+{
+	FILE *f;
+	int res;
+
+	memset(job, 0, sizeof(*job));
+	f = fopen(fname, "r");
+	if (!f)
+		return -1;
+	res = job_parse(job, f);
+	fclose(f);
+
+	return res;
+}
+
+void job_free(job_t *job)
+{
+	if (!job)
+		return;
+	free(job->cases);
+	job->cases = NULL;
+	job->cnt = 0;
+}
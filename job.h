@@ -0,0 +1,68 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_JOB_H
+#define FRAMETEST_JOB_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#define JOB_MAX_NAME 64
+#define JOB_MAX_VALUE 1024
+#define JOB_MAX_KEYS 32
+
+typedef struct job_kv_t {
+	char key[JOB_MAX_NAME];
+	char value[JOB_MAX_VALUE];
+} job_kv_t;
+
+/* Section of a job file, keys are long option names */
+typedef struct job_case_t {
+	char name[JOB_MAX_NAME];
+	/* Cases of the same group run concurrently, empty runs alone */
+	char group[JOB_MAX_NAME];
+	/* Remove the frames after the case, -1 inherits from [global] */
+	int cleanup;
+	size_t cnt;
+	job_kv_t kv[JOB_MAX_KEYS];
+} job_case_t;
+
+typedef struct job_t {
+	/* Options shared by every case */
+	job_case_t global;
+	size_t cnt;
+	job_case_t *cases;
+} job_t;
+
+/*
+ * INI style job file: [name] starts a case, [global] holds the shared
+ * options, key=value or plain key lines set options, # and ; start a
+ * comment. Keys group and cleanup are for the job itself. Returns 0 on
+ * success, -1 if the file can't be read, otherwise the number of the
+ * offending line. The job needs job_free() in either case.
+ */
+int job_parse(job_t *job, FILE *f);
+int job_load(job_t *job, const char *fname);
+void job_free(job_t *job);
+
+/* Boolean value of a key, returns non-zero if it's not one */
+int job_bool(const char *str, int *val);
+
+#endif
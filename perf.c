@@ -0,0 +1,177 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+#include <string.h>
+
+#include "perf.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const struct {
+	uint32_t type;
+	uint64_t config;
+} perf_events[PERF_EVENT_CNT] = {
+	[PERF_PAGE_FAULTS] = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+	[PERF_CONTEXT_SWITCHES] = { PERF_TYPE_SOFTWARE,
+				    PERF_COUNT_SW_CONTEXT_SWITCHES },
+	[PERF_CPU_MIGRATIONS] = { PERF_TYPE_SOFTWARE,
+				  PERF_COUNT_SW_CPU_MIGRATIONS },
+	[PERF_CYCLES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+	[PERF_INSTRUCTIONS] = { PERF_TYPE_HARDWARE,
+				PERF_COUNT_HW_INSTRUCTIONS },
+	[PERF_LLC_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+};
+
+static int perf_event_open(enum PerfEvent ev, int exclude_kernel)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = perf_events[ev].type;
+	attr.config = perf_events[ev].config;
+	attr.disabled = 1;
+	attr.exclude_hv = 1;
+	attr.exclude_kernel = exclude_kernel;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+			   PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	/* Calling thread on any CPU */
+	return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+int perf_open(perf_t *perf)
+{
+	int opened = 0;
+	int i;
+
+	for (i = 0; i < PERF_EVENT_CNT; i++) {
+		/* perf_event_paranoid >= 2 allows only user space counting */
+		perf->fd[i] = perf_event_open(i, 0);
+		if (perf->fd[i] < 0)
+			perf->fd[i] = perf_event_open(i, 1);
+		if (perf->fd[i] >= 0)
+			++opened;
+	}
+
+	return opened ? 0 : 1;
+}
+
+void perf_start(perf_t *perf)
+{
+	int i;
+
+	for (i = 0; i < PERF_EVENT_CNT; i++) {
+		if (perf->fd[i] < 0)
+			continue;
+		ioctl(perf->fd[i], PERF_EVENT_IOC_RESET, 0);
+		ioctl(perf->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+	}
+}
+
+void perf_read(perf_t *perf, perf_counters_t *res)
+{
+	int i;
+
+	memset(res, 0, sizeof(*res));
+	for (i = 0; i < PERF_EVENT_CNT; i++) {
+		uint64_t buf[3];
+
+		if (perf->fd[i] < 0)
+			continue;
+		ioctl(perf->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+		if (read(perf->fd[i], buf, sizeof(buf)) != sizeof(buf))
+			continue;
+
+		/* Scale if the counter was multiplexed */
+		if (buf[2] && buf[2] < buf[1])
+			res->val[i] = (double)buf[0] * buf[1] / buf[2];
+		else
+			res->val[i] = buf[0];
+		/* Never scheduled, the PMU is probably busy or missing */
+		if (!buf[2])
+			continue;
+		res->valid |= 1U << i;
+	}
+}
+
+void perf_close(perf_t *perf)
+{
+	int i;
+
+	for (i = 0; i < PERF_EVENT_CNT; i++) {
+		if (perf->fd[i] >= 0)
+			close(perf->fd[i]);
+		perf->fd[i] = -1;
+	}
+}
+#else
+int perf_open(perf_t *perf)
+{
+	int i;
+
+	for (i = 0; i < PERF_EVENT_CNT; i++)
+		perf->fd[i] = -1;
+	return 1;
+}
+
+void perf_start(perf_t *perf)
+{
+	(void)perf;
+}
+
+void perf_read(perf_t *perf, perf_counters_t *res)
+{
+	(void)perf;
+	memset(res, 0, sizeof(*res));
+}
+
+void perf_close(perf_t *perf)
+{
+	(void)perf;
+}
+#endif
+
+const char *perf_event_name(enum PerfEvent ev)
+{
+	switch (ev) {
+	case PERF_PAGE_FAULTS:
+		return "page_faults";
+	case PERF_CONTEXT_SWITCHES:
+		return "context_switches";
+	case PERF_CPU_MIGRATIONS:
+		return "cpu_migrations";
+	case PERF_CYCLES:
+		return "cycles";
+	case PERF_INSTRUCTIONS:
+		return "instructions";
+	case PERF_LLC_MISSES:
+		return "llc_misses";
+	default:
+		return "unknown";
+	}
+}
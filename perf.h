@@ -0,0 +1,66 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_PERF_H
+#define FRAMETEST_PERF_H
+
+#include <stdint.h>
+
+/* Software events come first, they're available with stricter settings */
+enum PerfEvent {
+	PERF_PAGE_FAULTS = 0,
+	PERF_CONTEXT_SWITCHES,
+	PERF_CPU_MIGRATIONS,
+	PERF_CYCLES,
+	PERF_INSTRUCTIONS,
+	PERF_LLC_MISSES,
+	PERF_EVENT_CNT,
+};
+
+typedef struct perf_counters_t {
+	uint64_t val[PERF_EVENT_CNT];
+	/* Bit mask of events which could be counted */
+	unsigned int valid;
+} perf_counters_t;
+
+/* Counters of the calling thread */
+typedef struct perf_t {
+	int fd[PERF_EVENT_CNT];
+} perf_t;
+
+/* Counters are opened disabled, perf_start resets and enables them */
+int perf_open(perf_t *perf);
+void perf_start(perf_t *perf);
+void perf_read(perf_t *perf, perf_counters_t *res);
+void perf_close(perf_t *perf);
+
+const char *perf_event_name(enum PerfEvent ev);
+
+static inline void perf_counters_add(perf_counters_t *dst,
+				     const perf_counters_t *src)
+{
+	int i;
+
+	for (i = 0; i < PERF_EVENT_CNT; i++)
+		dst->val[i] += src->val[i];
+	dst->valid |= src->valid;
+}
+
+#endif
@@ -282,6 +282,63 @@ int generic_thread_join(uint64_t thread_id, void **retval)
 
 #endif
 
+struct platform_gate_t {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	int open;
+};
+
+static platform_gate_t *pthread_gate_new(void)
+{
+	platform_gate_t *gate = calloc(1, sizeof(*gate));
+
+	if (!gate)
+		return NULL;
+	if (pthread_mutex_init(&gate->lock, NULL)) {
+		free(gate);
+		return NULL;
+	}
+	if (pthread_cond_init(&gate->cond, NULL)) {
+		pthread_mutex_destroy(&gate->lock);
+		free(gate);
+		return NULL;
+	}
+
+	return gate;
+}
+
+static void pthread_gate_unlock(void *lock)
+{
+	pthread_mutex_unlock(lock);
+}
+
+static void pthread_gate_wait(platform_gate_t *gate)
+{
+	pthread_mutex_lock(&gate->lock);
+	/* Waiters may be cancelled if the rest can't be started */
+	pthread_cleanup_push(pthread_gate_unlock, &gate->lock);
+	while (!gate->open)
+		pthread_cond_wait(&gate->cond, &gate->lock);
+	pthread_cleanup_pop(1);
+}
+
+static void pthread_gate_open(platform_gate_t *gate)
+{
+	pthread_mutex_lock(&gate->lock);
+	gate->open = 1;
+	pthread_cond_broadcast(&gate->cond);
+	pthread_mutex_unlock(&gate->lock);
+}
+
+static void pthread_gate_free(platform_gate_t *gate)
+{
+	if (!gate)
+		return;
+	pthread_cond_destroy(&gate->cond);
+	pthread_mutex_destroy(&gate->lock);
+	free(gate);
+}
+
 static platform_t default_platform = {
 #if defined(_WIN32)
 	.open = win_open,
@@ -316,6 +373,11 @@ static platform_t default_platform = {
 	.thread_cancel = generic_thread_cancel,
 	.thread_join = generic_thread_join,
 #endif
+
+	.gate_new = pthread_gate_new,
+	.gate_wait = pthread_gate_wait,
+	.gate_open = pthread_gate_open,
+	.gate_free = pthread_gate_free,
 };
 
 const platform_t *platform_get(void)
@@ -54,6 +54,9 @@ typedef struct platform_stat_t {
 	uint64_t blocks;
 } platform_stat_t;
 
+/* One shot gate, waiters block until it's opened */
+typedef struct platform_gate_t platform_gate_t;
+
 typedef struct platform_t {
 	platform_handle_t (*open)(const char *fname,
 				  platform_open_flags_t flags, int mode);
@@ -75,6 +78,11 @@ typedef struct platform_t {
 	int (*thread_cancel)(uint64_t thread_id);
 	int (*thread_join)(uint64_t thread_id, void **retval);
 
+	platform_gate_t *(*gate_new)(void);
+	void (*gate_wait)(platform_gate_t *gate);
+	void (*gate_open)(platform_gate_t *gate);
+	void (*gate_free)(platform_gate_t *gate);
+
 	void *priv;
 } platform_t;
 
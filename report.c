@@ -19,16 +19,39 @@
  */
 
 #include <inttypes.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "baseline.h"
 #include "frametest.h"
+#include "histogram.h"
+#include "jitter.h"
+#include "report.h"
+#include "stats.h"
+#include "sysinfo.h"
+#include "telemetry.h"
+#include "timing.h"
+#include "topk.h"
 
-enum CompletionStat {
-	COMP_FRAME = 0,
-	COMP_OPEN,
-	COMP_IO,
-	COMP_CLOSE,
-};
+static void result_stats(const test_result_t *res, enum CompletionStat stat,
+			 stats_t *st)
+{
+	size_t i;
+
+	if (res->stats) {
+		*st = res->stats[stat];
+		return;
+	}
+	stats_init(st);
+	if (!res->completion)
+		return;
+
+	for (i = 0; i < res->frames_written; i++)
+		stats_add(st, completion_value(&res->completion[i], stat));
+}
 
 static void print_stat_about(const test_result_t *res, const char *label,
 			     enum CompletionStat stat, int csv)
@@ -36,30 +59,16 @@ static void print_stat_about(const test_result_t *res, const char *label,
 	uint64_t min = SIZE_MAX;
 	uint64_t max = 0;
 	uint64_t total = 0;
+	double avg;
 	size_t i;
 
-	for (i = 0; i < res->frames_written; i++) {
-		size_t val;
-
-		switch (stat) {
-		case COMP_OPEN:
-			val = res->completion[i].open;
-			val -= res->completion[i].start;
-			break;
-		case COMP_IO:
-			val = res->completion[i].io;
-			val -= res->completion[i].open;
-			break;
-		case COMP_CLOSE:
-			val = res->completion[i].close;
-			val -= res->completion[i].io;
-			break;
-		default:
-		case COMP_FRAME:
-			val = res->completion[i].frame;
-			val -= res->completion[i].start;
-			break;
-		}
+	if (res->stats) {
+		min = res->stats[stat].min;
+		max = res->stats[stat].max;
+		total = res->stats[stat].sum;
+	}
+	for (i = 0; res->completion && i < res->frames_written; i++) {
+		size_t val = completion_value(&res->completion[i], stat);
 
 		if (val < min)
 			min = val;
@@ -67,24 +76,131 @@ static void print_stat_about(const test_result_t *res, const char *label,
 			max = val;
 		total += val;
 	}
+	avg = res->frames_written ? (double)total / res->frames_written : 0;
 	if (csv) {
 		printf("%" PRIu64 ",", min);
-		printf("%lf,", (double)total / res->frames_written);
+		printf("%lf,", avg);
 		printf("%" PRIu64 ",", max);
 	} else {
 		printf("%s:\n", label);
 		printf(" min   : %lf ms\n", (double)min / SEC_IN_MS);
-		printf(" avg   : %lf ms\n",
-		       (double)total / res->frames_written / SEC_IN_MS);
+		printf(" avg   : %lf ms\n", avg / SEC_IN_MS);
 		printf(" max   : %lf ms\n", (double)max / SEC_IN_MS);
 	}
 }
 
+static const double sched_pcts[] = { 50, 99, 99.9 };
+#define SCHED_PCTS (sizeof(sched_pcts) / sizeof(sched_pcts[0]))
+
+/* Late frames, percentiles from frame start and from when frames were due */
+static void print_sched_latency_csv(const test_result_t *res,
+				    const opts_t *opts)
+{
+	stats_t *st;
+	size_t i;
+
+	if (!opts->sched)
+		return;
+	printf("%" PRIu64 ",", res->late);
+	st = malloc(sizeof(*st));
+	if (!st) {
+		printf(",,,,,,");
+		return;
+	}
+	result_stats(res, COMP_FRAME, st);
+	for (i = 0; i < SCHED_PCTS; i++)
+		printf("%" PRIu64 ",", stats_percentile(st, sched_pcts[i]));
+	result_stats(res, COMP_SCHED, st);
+	for (i = 0; i < SCHED_PCTS; i++)
+		printf("%" PRIu64 ",", stats_percentile(st, sched_pcts[i]));
+	free(st);
+}
+
+static void print_sched_latency(const test_result_t *res, const opts_t *opts)
+{
+	static const double pcts[] = { 50, 90, 99, 99.9, 99.99 };
+	stats_t *st;
+	stats_t *sched;
+	size_t i;
+
+	if (!opts->sched || (!res->completion && !res->stats))
+		return;
+	st = malloc(sizeof(*st) * 2);
+	if (!st)
+		return;
+	sched = &st[1];
+	result_stats(res, COMP_FRAME, st);
+	result_stats(res, COMP_SCHED, sched);
+
+	printf("Open loop latency, %" PRIu64 " late frames:\n", res->late);
+	printf("         from start   from schedule\n");
+	for (i = 0; i < sizeof(pcts) / sizeof(pcts[0]); i++) {
+		char label[16];
+
+		snprintf(label, sizeof(label), "p%g", pcts[i]);
+		printf(" %-6s: %10.3lf ms %12.3lf ms\n", label,
+		       (double)stats_percentile(st, pcts[i]) / SEC_IN_MS,
+		       (double)stats_percentile(sched, pcts[i]) / SEC_IN_MS);
+	}
+	printf(" max   : %10.3lf ms %12.3lf ms\n",
+	       (double)st->max / SEC_IN_MS, (double)sched->max / SEC_IN_MS);
+	free(st);
+}
+
+static void print_split_stat(const char *label, const stats_t *st)
+{
+	printf("%s, %" PRIu64 " frames:\n", label, st->cnt);
+	if (!st->cnt)
+		return;
+	printf(" min   : %lf ms\n", (double)st->min / SEC_IN_MS);
+	printf(" avg   : %lf ms\n", stats_mean(st) / SEC_IN_MS);
+	printf(" p99   : %lf ms\n",
+	       (double)stats_percentile(st, 99) / SEC_IN_MS);
+	printf(" max   : %lf ms\n", (double)st->max / SEC_IN_MS);
+}
+
+/* Frames waking up from idle apart from the rest of the bursts */
+static void print_burst(const test_result_t *res)
+{
+	if (!res->burst)
+		return;
+	print_split_stat("First frames after idle", &res->burst[BURST_FIRST]);
+	print_split_stat("Frames in bursts", &res->burst[BURST_REST]);
+}
+
+/* Seeks apart from playing, the lag of seeking is what users notice */
+static void print_seek(const test_result_t *res)
+{
+	if (!res->seek)
+		return;
+	print_split_stat("Seek to first frame", &res->seek[SEEK_FIRST]);
+	print_split_stat("Frames played after seeks", &res->seek[SEEK_REST]);
+}
+
+/* Mean, p99 and max of the stats of a split, or empty ones */
+static void print_split_csv(const stats_t *sts, size_t cnt)
+{
+	size_t i;
+
+	for (i = 0; i < cnt; i++) {
+		const stats_t *st = sts ? &sts[i] : NULL;
+
+		if (!st || !st->cnt) {
+			printf(",,,");
+			continue;
+		}
+		printf("%lf,%" PRIu64 ",%" PRIu64 ",", stats_mean(st),
+		       stats_percentile(st, 99), st->max);
+	}
+}
+
 static void print_frames_stat(const test_result_t *res, const opts_t *opts)
 {
-	if (!res->completion) {
+	if (!res->completion && !res->stats) {
 		if (opts->csv)
-			printf(",,,");
+			printf(",,,%s%s%s", opts->sched ? ",,,,,,," : "",
+			       opts->on_ns ? ",,,,,," : "",
+			       opts->pattern.stride ? ",,,,,," : "");
 		return;
 	}
 
@@ -95,6 +211,11 @@ static void print_frames_stat(const test_result_t *res, const opts_t *opts)
 			print_stat_about(res, "", COMP_IO, 1);
 			print_stat_about(res, "", COMP_CLOSE, 1);
 		}
+		print_sched_latency_csv(res, opts);
+		if (opts->on_ns)
+			print_split_csv(res->burst, BURST_STAT_CNT);
+		if (opts->pattern.stride)
+			print_split_csv(res->seek, SEEK_STAT_CNT);
 	} else {
 		print_stat_about(res, "Completion times", COMP_FRAME, 0);
 		if (opts->times) {
@@ -105,6 +226,95 @@ static void print_frames_stat(const test_result_t *res, const opts_t *opts)
 	}
 }
 
+/* Process usage when available, otherwise the sum of the test threads */
+static inline uint64_t result_cpu_ns(const test_result_t *res)
+{
+	uint64_t ns = res->usage.user_ns + res->usage.sys_ns;
+
+	return ns ? ns : res->cpu_ns;
+}
+
+static inline double result_cpu_per_gib(const test_result_t *res)
+{
+	if (!res->bytes_written)
+		return 0;
+	return (double)result_cpu_ns(res) / SEC_IN_NS /
+	       ((double)res->bytes_written / (1024 * 1024 * 1024));
+}
+
+static void print_cpu(const test_result_t *res, const opts_t *opts)
+{
+	if (!opts->cpu)
+		return;
+
+	printf("CPU:\n");
+	printf(" user  : %lf s\n", (double)res->usage.user_ns / SEC_IN_NS);
+	printf(" system: %lf s\n", (double)res->usage.sys_ns / SEC_IN_NS);
+	printf(" thread: %lf s\n", (double)res->cpu_ns / SEC_IN_NS);
+	printf(" s/GiB : %lf\n", result_cpu_per_gib(res));
+	printf(" csw   : %" PRIu64 " voluntary, %" PRIu64 " involuntary\n",
+	       res->usage.vol_csw, res->usage.invol_csw);
+	if ((!res->completion && !res->stats) || !res->frames_written)
+		return;
+	print_stat_about(res, "On-CPU times", COMP_CPU, 0);
+	print_stat_about(res, "Off-CPU times", COMP_OFF_CPU, 0);
+}
+
+static void print_cpu_csv(const test_result_t *res, const opts_t *opts)
+{
+	if (!opts->cpu)
+		return;
+
+	printf("%lf,%lf,", (double)result_cpu_ns(res) / SEC_IN_NS,
+	       result_cpu_per_gib(res));
+	printf("%lf,%lf,", (double)res->usage.user_ns / SEC_IN_NS,
+	       (double)res->usage.sys_ns / SEC_IN_NS);
+	printf("%" PRIu64 ",%" PRIu64 ",", res->usage.vol_csw,
+	       res->usage.invol_csw);
+}
+
+static inline double result_per_gib(const test_result_t *res, uint64_t val)
+{
+	if (!res->bytes_written)
+		return 0;
+	return (double)val * 1024 * 1024 * 1024 / res->bytes_written;
+}
+
+static void print_perf(const test_result_t *res, const opts_t *opts)
+{
+	int i;
+
+	if (!opts->perf)
+		return;
+
+	printf("Counters:\n");
+	for (i = 0; i < PERF_EVENT_CNT; i++) {
+		if (!(res->perf.valid & (1U << i)))
+			continue;
+		printf(" %-16s: %" PRIu64 ", %lf per GiB\n",
+		       perf_event_name(i), res->perf.val[i],
+		       result_per_gib(res, res->perf.val[i]));
+	}
+	if (!res->perf.valid)
+		printf(" not available, see perf_event_paranoid\n");
+	else if (!(res->perf.valid & (1U << PERF_CYCLES)))
+		printf(" hardware counters not available\n");
+}
+
+static void print_perf_csv(const test_result_t *res, const opts_t *opts)
+{
+	int i;
+
+	if (!opts->perf)
+		return;
+
+	for (i = 0; i < PERF_EVENT_CNT; i++) {
+		if (res->perf.valid & (1U << i))
+			printf("%" PRIu64, res->perf.val[i]);
+		printf(",");
+	}
+}
+
 static void print_frame_times(const test_result_t *res, const opts_t *opts)
 {
 	if (!opts->frametimes)
@@ -112,7 +322,7 @@ static void print_frame_times(const test_result_t *res, const opts_t *opts)
 	size_t i;
 
 	printf("frame,start,open,io,close,frame\n");
-	for (i = 0; i < res->frames_written; i++) {
+	for (i = 0; res->completion && i < res->frames_written; i++) {
 		printf("%zu,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
 		       ",%" PRIu64 "\n",
 		       i, res->completion[i].start, res->completion[i].open,
@@ -121,8 +331,339 @@ static void print_frame_times(const test_result_t *res, const opts_t *opts)
 	}
 }
 
+/* Completions between two consecutive telemetry samples */
+typedef struct interval_t {
+	uint64_t frames;
+	uint64_t lat_max;
+} interval_t;
+
+static interval_t *intervals_collect(const test_result_t *res,
+				     const telemetry_t *tm)
+{
+	interval_t *iv;
+	uint64_t i;
+
+	if (!tm || tm->cnt < 2)
+		return NULL;
+
+	iv = calloc(tm->cnt - 1, sizeof(*iv));
+	if (!iv)
+		return NULL;
+
+	for (i = 0; res->completion && i < res->frames_written; i++) {
+		const test_completion_t *c = &res->completion[i];
+		size_t lo = 0;
+		size_t hi = tm->cnt - 1;
+
+		if (c->frame < tm->samples[0].time ||
+		    c->frame >= tm->samples[hi].time)
+			continue;
+		/* Find the last sample taken before the completion */
+		while (hi - lo > 1) {
+			size_t mid = lo + (hi - lo) / 2;
+
+			if (tm->samples[mid].time <= c->frame)
+				lo = mid;
+			else
+				hi = mid;
+		}
+		++iv[lo].frames;
+		if (c->frame - c->start > iv[lo].lat_max)
+			iv[lo].lat_max = c->frame - c->start;
+	}
+
+	return iv;
+}
+
+static inline double interval_frame_size(const test_result_t *res)
+{
+	if (!res->frames_written)
+		return 0;
+	return (double)res->bytes_written / res->frames_written;
+}
+
+static inline double interval_pct(uint64_t a, uint64_t b, uint64_t scale,
+				  uint64_t ns)
+{
+	if (b < a || !ns)
+		return 0;
+	return (double)(b - a) * scale * 100 / ns;
+}
+
+void print_intervals(const char *tcase, const test_result_t *res,
+		     const telemetry_t *tm)
+{
+	double frame_size = interval_frame_size(res);
+	interval_t *iv;
+	size_t i;
+
+	iv = intervals_collect(res, tm);
+	if (!iv)
+		return;
+
+	printf("Intervals %s:\n", tcase);
+	printf("%10s %10s %10s %10s", "time_ms", "fps", "MiB/s", "lat_max_ms");
+	if (tm->sources & TELEMETRY_DISK)
+		printf(" %10s %6s %6s", "dev_MiB/s", "aqu", "util%");
+	if (tm->sources & TELEMETRY_MEM)
+		printf(" %10s %10s", "dirty_MiB", "wback_MiB");
+	if (tm->sources & TELEMETRY_PSI)
+		printf(" %6s %6s", "some%", "full%");
+	printf("\n");
+
+	for (i = 0; i + 1 < tm->cnt; i++) {
+		const telemetry_sample_t *a = &tm->samples[i];
+		const telemetry_sample_t *b = &tm->samples[i + 1];
+		uint64_t ns = b->time - a->time;
+		double secs = (double)ns / SEC_IN_NS;
+		double fps = secs > 0 ? iv[i].frames / secs : 0;
+
+		printf("%10.1lf %10.2lf %10.2lf %10.3lf",
+		       a->time > res->started ?
+			       (double)(a->time - res->started) / SEC_IN_MS :
+			       0,
+		       fps, fps * frame_size / (1024 * 1024),
+		       (double)iv[i].lat_max / SEC_IN_MS);
+		if (tm->sources & TELEMETRY_DISK) {
+			uint64_t sect = b->rd_sectors + b->wr_sectors -
+					a->rd_sectors - a->wr_sectors;
+
+			printf(" %10.2lf %6.2lf %6.1lf",
+			       secs > 0 ? sect * 512 / (1024 * 1024) / secs : 0,
+			       interval_pct(a->queue_ms, b->queue_ms,
+					    SEC_IN_MS, ns) / 100,
+			       interval_pct(a->io_ticks_ms, b->io_ticks_ms,
+					    SEC_IN_MS, ns));
+		}
+		if (tm->sources & TELEMETRY_MEM)
+			printf(" %10.1lf %10.1lf", (double)b->dirty_kb / 1024,
+			       (double)b->writeback_kb / 1024);
+		if (tm->sources & TELEMETRY_PSI)
+			printf(" %6.1lf %6.1lf",
+			       interval_pct(a->psi_some_us, b->psi_some_us,
+					    1000, ns),
+			       interval_pct(a->psi_full_us, b->psi_full_us,
+					    1000, ns));
+		printf("\n");
+	}
+	free(iv);
+}
+
+typedef struct fairness_t {
+	double jain;
+	double max_min;
+	uint64_t slowest_finish;
+	uint64_t median_finish;
+} fairness_t;
+
+static inline double result_bps(const test_result_t *res)
+{
+	if (!res->time_taken_ns)
+		return 0;
+	return (double)res->bytes_written * SEC_IN_NS / res->time_taken_ns;
+}
+
+static inline uint64_t result_finish(const test_result_t *res,
+				     const test_result_t *thread_res)
+{
+	if (!thread_res->finished || thread_res->finished < res->started)
+		return 0;
+	return thread_res->finished - res->started;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static void fairness_calc(const test_result_t *res,
+			  const test_result_t *thread_res, size_t thread_cnt,
+			  fairness_t *fair)
+{
+	double sum = 0;
+	double sum_sq = 0;
+	double min = 0;
+	double max = 0;
+	uint64_t *finish;
+	size_t i;
+
+	memset(fair, 0, sizeof(*fair));
+	if (!thread_cnt)
+		return;
+
+	for (i = 0; i < thread_cnt; i++) {
+		double bps = result_bps(&thread_res[i]);
+
+		sum += bps;
+		sum_sq += bps * bps;
+		if (!i || bps < min)
+			min = bps;
+		if (bps > max)
+			max = bps;
+	}
+	/* Jain's fairness index: 1 is perfectly fair, 1/n worst */
+	if (sum_sq > 0)
+		fair->jain = sum * sum / (thread_cnt * sum_sq);
+	if (min > 0)
+		fair->max_min = max / min;
+
+	finish = malloc(sizeof(*finish) * thread_cnt);
+	if (!finish)
+		return;
+	for (i = 0; i < thread_cnt; i++)
+		finish[i] = result_finish(res, &thread_res[i]);
+	qsort(finish, thread_cnt, sizeof(*finish), cmp_u64);
+	fair->slowest_finish = finish[thread_cnt - 1];
+	/* Mean of the middle two with an even count */
+	if (thread_cnt % 2)
+		fair->median_finish = finish[thread_cnt / 2];
+	else
+		fair->median_finish = (finish[thread_cnt / 2 - 1] +
+				       finish[thread_cnt / 2]) / 2;
+	free(finish);
+}
+
+/* Frame latency percentiles of the per thread CSV columns */
+static const double thread_pcts[] = { 50, 95, 99, 99.9 };
+#define THREAD_PCTS (sizeof(thread_pcts) / sizeof(thread_pcts[0]))
+
+static void print_thread_pcts_csv(const test_result_t *res)
+{
+	stats_t *st;
+	size_t i;
+
+	st = malloc(sizeof(*st));
+	if (!st) {
+		printf(",,,,");
+		return;
+	}
+	result_stats(res, COMP_FRAME, st);
+	for (i = 0; i < THREAD_PCTS; i++)
+		printf("%" PRIu64 ",", stats_percentile(st, thread_pcts[i]));
+	free(st);
+}
+
+static void print_threads(const char *tcase, const test_result_t *res,
+			  const test_result_t *thread_res, size_t thread_cnt)
+{
+	fairness_t fair;
+	stats_t *st;
+	size_t i;
+
+	st = malloc(sizeof(*st));
+	if (!st)
+		return;
+
+	printf("Threads %s:\n", tcase);
+	printf(" id     frames          fps        MiB/s     p50 ms     "
+	       "p99 ms     max ms    done ms\n");
+	for (i = 0; i < thread_cnt; i++) {
+		const test_result_t *tr = &thread_res[i];
+		double secs = (double)tr->time_taken_ns / SEC_IN_NS;
+
+		result_stats(tr, COMP_FRAME, st);
+		printf(" %-4zu %8" PRIu64 " %12lf %12lf %10lf %10lf %10lf "
+		       "%10lf\n",
+		       i, tr->frames_written,
+		       secs > 0 ? tr->frames_written / secs : 0,
+		       result_bps(tr) / (1024 * 1024),
+		       (double)stats_percentile(st, 50) / SEC_IN_MS,
+		       (double)stats_percentile(st, 99) / SEC_IN_MS,
+		       (double)st->max / SEC_IN_MS,
+		       (double)result_finish(res, tr) / SEC_IN_MS);
+	}
+	free(st);
+
+	fairness_calc(res, thread_res, thread_cnt, &fair);
+	printf("Fairness:\n");
+	printf(" jain index     : %lf\n", fair.jain);
+	printf(" max/min        : %lf\n", fair.max_min);
+	printf(" slowest done   : %lf ms\n",
+	       (double)fair.slowest_finish / SEC_IN_MS);
+	printf(" median done    : %lf ms\n",
+	       (double)fair.median_finish / SEC_IN_MS);
+	printf(" slowest/median : %lf\n",
+	       fair.median_finish ?
+		       (double)fair.slowest_finish / fair.median_finish :
+		       0);
+}
+
+static inline uint64_t jitter_period(const opts_t *opts)
+{
+	return opts->fps ? SEC_IN_NS / opts->fps : 0;
+}
+
+static jitter_t *jitter_get(const opts_t *opts,
+			    const test_result_t *thread_res, size_t thread_cnt)
+{
+	jitter_t *jt;
+
+	if (!opts->jitter)
+		return NULL;
+	jt = malloc(sizeof(*jt));
+	if (!jt)
+		return NULL;
+	if (jitter_collect(jt, thread_res, thread_cnt, jitter_period(opts))) {
+		free(jt);
+		return NULL;
+	}
+
+	return jt;
+}
+
+static void print_jitter_value(const char *label, double ns,
+			       const jitter_t *jt)
+{
+	printf(" %-6s: %lf ms", label, ns / SEC_IN_MS);
+	if (jt->nominal)
+		printf(" (%.2lf periods)", ns / jt->period);
+	printf("\n");
+}
+
+static void print_jitter(const char *tcase, const opts_t *opts,
+			 const test_result_t *thread_res, size_t thread_cnt)
+{
+	jitter_t *jt = jitter_get(opts, thread_res, thread_cnt);
+	uint64_t max = 0;
+	size_t i;
+
+	if (!jt)
+		return;
+
+	printf("Delivery intervals %s:\n", tcase);
+	print_jitter_value("mean", stats_mean(&jt->st), jt);
+	print_jitter_value("stddev", stats_stddev(&jt->st), jt);
+	print_jitter_value("p50", stats_percentile(&jt->st, 50), jt);
+	print_jitter_value("p90", stats_percentile(&jt->st, 90), jt);
+	print_jitter_value("p99", stats_percentile(&jt->st, 99), jt);
+	print_jitter_value("p99.9", stats_percentile(&jt->st, 99.9), jt);
+	print_jitter_value("max", jt->st.max, jt);
+	printf(" longest gap before frame %" PRIu64 "\n", jt->max_gap_frame);
+
+	for (i = 0; i < JITTER_BINS; i++) {
+		if (jt->bins[i] > max)
+			max = jt->bins[i];
+	}
+	printf(" %s periods:\n", jt->nominal ? "frame" : "mean");
+	for (i = 0; max && i < JITTER_BINS; i++) {
+		size_t bar = jt->bins[i] * 40 / max;
+
+		if (!bar && jt->bins[i])
+			bar = 1;
+		printf(" %2zu%s |%-40.*s %" PRIu64 "\n", i,
+		       i == JITTER_BINS - 1 ? "+" : " ", (int)bar,
+		       "########################################",
+		       jt->bins[i]);
+	}
+	free(jt);
+}
+
 void print_results(const char *tcase, const opts_t *opts,
-		   const test_result_t *res)
+		   const test_result_t *res, const test_result_t *thread_res,
+		   size_t thread_cnt)
 {
 	if (!res)
 		return;
@@ -140,32 +681,56 @@ void print_results(const char *tcase, const opts_t *opts,
 	printf(" MiB/s : %lf\n", (double)res->bytes_written * SEC_IN_NS /
 					 (1024 * 1024) / res->time_taken_ns);
 	print_frames_stat(res, opts);
+	print_sched_latency(res, opts);
+	print_burst(res);
+	print_seek(res);
+	print_cpu(res, opts);
+	print_perf(res, opts);
+	if (opts->per_thread && thread_cnt)
+		print_threads(tcase, res, thread_res, thread_cnt);
+	print_jitter(tcase, opts, thread_res, thread_cnt);
 	print_frame_times(res, opts);
 }
 
+void print_timer(void)
+{
+	timing_info_t info;
+
+	timing_get_info(&info);
+	printf("Timer: %s, cost %.1lf ns, resolution %" PRIu64 " ns\n",
+	       info.name, info.cost_ns, info.resolution_ns);
+}
+
 void print_header_csv(const opts_t *opts)
 {
 	const char *extra = "";
+	int i;
 
 	if (opts->times)
 		extra = ",omin,oavg,omax,iomin,ioavg,iomax,cmin,cavg,cmax";
 
 	printf("case,profile,threads,frames,bytes,time,fps,bps,mibps,"
-	       "fmin,favg,fmax%s\n",
-	       extra);
+	       "fmin,favg,fmax%s%s%s%s%s",
+	       extra,
+	       opts->sched ? ",late,p50,p99,p99.9,sp50,sp99,sp99.9" : "",
+	       opts->on_ns ? ",wavg,wp99,wmax,bavg,bp99,bmax" : "",
+	       opts->pattern.stride ?
+		       ",seekavg,seekp99,seekmax,playavg,playp99,playmax" :
+		       "",
+	       opts->cpu ? ",cpu,cpugib,user,sys,vcsw,ivcsw" : "");
+	for (i = 0; opts->perf && i < PERF_EVENT_CNT; i++)
+		printf(",%s", perf_event_name(i));
+	printf("%s\n", opts->per_thread ?
+			       ",fp50,fp95,fp99,fp99.9,jain,maxmin,slowmed" :
+			       "");
 }
 
-void print_results_csv(const char *tcase, const opts_t *opts,
-		       const test_result_t *res)
+static void print_row_csv(const char *tcase, const opts_t *opts,
+			  size_t threads, const test_result_t *res)
 {
-	if (!res)
-		return;
-	if (!res->time_taken_ns)
-		return;
-
 	printf("\"%s\",", tcase);
 	printf("\"%s\",", opts->profile.name);
-	printf("%zu,", opts->threads);
+	printf("%zu,", threads);
 	printf("%" PRIu64 ",", res->frames_written);
 	printf("%" PRIu64 ",", res->bytes_written);
 	printf("%" PRIu64 ",", res->time_taken_ns);
@@ -176,6 +741,1016 @@ void print_results_csv(const char *tcase, const opts_t *opts,
 	printf("%lf,", (double)res->bytes_written * SEC_IN_NS / (1024 * 1024) /
 			       res->time_taken_ns);
 	print_frames_stat(res, opts);
+	print_cpu_csv(res, opts);
+	print_perf_csv(res, opts);
+}
+
+void print_results_csv(const char *tcase, const opts_t *opts,
+		       const test_result_t *res,
+		       const test_result_t *thread_res, size_t thread_cnt)
+{
+	fairness_t fair;
+	size_t i;
+
+	if (!res)
+		return;
+	if (!res->time_taken_ns)
+		return;
+
+	print_row_csv(tcase, opts, opts->threads, res);
+	if (opts->per_thread) {
+		print_thread_pcts_csv(res);
+		fairness_calc(res, thread_res, thread_cnt, &fair);
+		printf("%lf,%lf,%lf", fair.jain, fair.max_min,
+		       fair.median_finish ? (double)fair.slowest_finish /
+						    fair.median_finish :
+					    0);
+	}
 	printf("\n");
+	for (i = 0; opts->per_thread && i < thread_cnt; i++) {
+		char label[64];
+
+		if (!thread_res[i].time_taken_ns)
+			continue;
+		snprintf(label, sizeof(label), "%s/thread%zu", tcase, i);
+		print_row_csv(label, opts, 1, &thread_res[i]);
+		print_thread_pcts_csv(&thread_res[i]);
+		printf(",,\n");
+	}
 	print_frame_times(res, opts);
 }
+
+/* JSON output, one document per tframetest invocation */
+static size_t json_tests = 0;
+
+static void json_print_str(const char *str)
+{
+	const char *p;
+
+	putchar('"');
+	for (p = str ? str : ""; *p; p++) {
+		switch (*p) {
+		case '"':
+			printf("\\\"");
+			break;
+		case '\\':
+			printf("\\\\");
+			break;
+		case '\n':
+			printf("\\n");
+			break;
+		case '\t':
+			printf("\\t");
+			break;
+		default:
+			if ((unsigned char)*p < 0x20)
+				printf("\\u%04x", (unsigned char)*p);
+			else
+				putchar(*p);
+			break;
+		}
+	}
+	putchar('"');
+}
+
+static inline const char *json_bool(unsigned int val)
+{
+	return val ? "true" : "false";
+}
+
+static void print_environment_json(const opts_t *opts)
+{
+	timing_info_t timer;
+	sysinfo_t info;
+
+	(void)sysinfo_get(opts->path, &info);
+
+	printf("  \"environment\": {\n");
+	printf("    \"hostname\": ");
+	json_print_str(info.hostname);
+	printf(",\n    \"kernel\": ");
+	json_print_str(info.kernel);
+	printf(",\n    \"fs_type\": ");
+	json_print_str(info.fs_type);
+	printf(",\n    \"mount_point\": ");
+	json_print_str(info.mount_point);
+	printf(",\n    \"device\": ");
+	json_print_str(info.device);
+	printf(",\n    \"device_id\": \"%u:%u\",\n", info.dev_major,
+	       info.dev_minor);
+	timing_get_info(&timer);
+	printf("    \"timer\": {\n");
+	printf("      \"source\": \"%s\",\n", timer.name);
+	printf("      \"cost_ns\": %lf,\n", timer.cost_ns);
+	printf("      \"resolution_ns\": %" PRIu64 ",\n",
+	       timer.resolution_ns);
+	printf("      \"tsc_hz\": %lf\n", timer.tsc_hz);
+	printf("    }\n");
+	printf("  },\n");
+}
+
+static inline const char *sched_name(enum Schedule sched)
+{
+	switch (sched) {
+	case SCHED_FIXED:
+		return "fixed";
+	case SCHED_POISSON:
+		return "poisson";
+	case SCHED_BURST:
+		return "burst";
+	case SCHED_CLOSED:
+	default:
+		return "closed";
+	}
+}
+
+static int direct_io(const opts_t *opts)
+{
+#if defined(__APPLE__)
+	/* O_DIRECT is faked there, see platform.c */
+	return 0;
+#else
+	return !opts->backend_sim;
+#endif
+}
+
+static void print_sim_json(const sim_config_t *sim)
+{
+	printf("    \"sim\": {\n");
+	printf("      \"bandwidth\": %" PRIu64 ",\n", sim->bandwidth);
+	printf("      \"latency_ns\": %" PRIu64 ",\n", sim->latency_ns);
+	printf("      \"jitter\": %lf,\n", sim->jitter);
+	printf("      \"qd_factor\": %lf,\n", sim->qd_factor);
+	printf("      \"tail_prob\": %lf,\n", sim->tail_prob);
+	printf("      \"tail_alpha\": %lf,\n", sim->tail_alpha);
+	printf("      \"stall_period_ns\": %" PRIu64 ",\n",
+	       sim->stall_period_ns);
+	printf("      \"stall_ns\": %" PRIu64 ",\n", sim->stall_ns);
+	printf("      \"open_ns\": %" PRIu64 ",\n", sim->open_ns);
+	printf("      \"close_ns\": %" PRIu64 ",\n", sim->close_ns);
+	printf("      \"seed\": %" PRIu64 "\n", sim->seed);
+	printf("    },\n");
+}
+
+static void print_range_json(const sweep_range_t *range)
+{
+	size_t i;
+
+	printf("[");
+	for (i = 0; i < range->cnt; i++)
+		printf("%s%zu", i ? ", " : "", range->vals[i]);
+	printf("]");
+}
+
+static void print_interfere_json(const interfere_cfg_t *cfg)
+{
+	size_t i;
+
+	printf("    \"interfere\": [");
+	for (i = 0; i < cfg->cnt; i++) {
+		const interfere_spec_t *spec = &cfg->specs[i];
+
+		printf("%s\n      { \"type\": \"%s\", \"bs\": %zu, "
+		       "\"rate\": %zu }",
+		       i ? "," : "", interfere_name(spec->type), spec->bs,
+		       spec->rate);
+	}
+	printf("%s],\n", cfg->cnt ? "\n    " : "");
+}
+
+static void print_options_json(const opts_t *opts)
+{
+	const char *order = "normal";
+
+	if (opts->reverse)
+		order = "reverse";
+	else if (opts->random)
+		order = "random";
+	else if (opts->pattern.stride)
+		order = "pattern";
+
+	printf("  \"options\": {\n");
+	printf("    \"write\": %s,\n", json_bool(opts->mode & TEST_WRITE));
+	printf("    \"read\": %s,\n", json_bool(opts->mode & TEST_READ));
+	printf("    \"empty\": %s,\n", json_bool(opts->mode & TEST_EMPTY));
+	printf("    \"path\": ");
+	json_print_str(opts->path);
+	printf(",\n");
+	printf("    \"write_size\": %zu,\n", opts->write_size);
+	printf("    \"frame_size\": %zu,\n", opts->frame_size);
+	printf("    \"threads\": %zu,\n", opts->threads);
+	printf("    \"frames\": %zu,\n", opts->frames);
+	printf("    \"fps\": %zu,\n", opts->fps);
+	printf("    \"header_size\": %zu,\n", opts->header_size);
+	printf("    \"timer\": \"%s\",\n",
+	       opts->timer == TIMING_TSC ?
+		       "tsc" :
+		       (opts->timer == TIMING_CLOCK ? "clock" : "auto"));
+	printf("    \"backend\": \"%s\",\n",
+	       opts->backend_sim ? "sim" : "default");
+	printf("    \"repeat\": %zu,\n", opts->repeat);
+	printf("    \"duration_ns\": %" PRIu64 ",\n", opts->duration_ns);
+	printf("    \"wrap\": %s,\n", json_bool(!opts->no_wrap));
+	printf("    \"burst_on_ns\": %" PRIu64 ",\n", opts->on_ns);
+	printf("    \"burst_off_ns\": %" PRIu64 ",\n", opts->off_ns);
+	printf("    \"bursts\": %zu,\n", opts->bursts);
+	printf("    \"schedule\": \"%s\",\n", sched_name(opts->sched));
+	printf("    \"burst\": %zu,\n", opts->burst);
+	printf("    \"pattern_stride\": %ld,\n", opts->pattern.stride);
+	printf("    \"pattern_speed\": %lf,\n", opts->pattern.speed);
+	printf("    \"pattern_seek\": %zu,\n", opts->pattern.segment);
+	printf("    \"steady_ns\": %" PRIu64 ",\n", opts->steady_ns);
+	printf("    \"steady_cv\": %lf,\n", opts->steady_cv);
+	printf("    \"warmup_frames\": %zu,\n", opts->warmup.frames);
+	printf("    \"warmup_ns\": %" PRIu64 ",\n", opts->warmup.ns);
+	printf("    \"cooldown_frames\": %zu,\n", opts->cooldown.frames);
+	printf("    \"cooldown_ns\": %" PRIu64 ",\n", opts->cooldown.ns);
+	printf("    \"order\": \"%s\",\n", order);
+	printf("    \"files\": \"%s\",\n",
+	       opts->single_file ? "single" : "multiple");
+	printf("    \"direct_io\": %s,\n", json_bool(direct_io(opts)));
+	printf("    \"times\": %s,\n", json_bool(opts->times));
+	printf("    \"frametimes\": %s,\n", json_bool(opts->frametimes));
+	printf("    \"histogram\": %s,\n", json_bool(opts->histogram));
+	printf("    \"per_thread\": %s,\n", json_bool(opts->per_thread));
+	printf("    \"jitter\": %s,\n", json_bool(opts->jitter));
+	printf("    \"csv\": %s,\n", json_bool(opts->csv));
+	printf("    \"csv_header\": %s,\n", json_bool(!opts->no_csv_header));
+	printf("    \"cpu\": %s,\n", json_bool(opts->cpu));
+	printf("    \"perf\": %s,\n", json_bool(opts->perf));
+	printf("    \"heatmap\": %s,\n", json_bool(opts->heatmap));
+	printf("    \"heatmap_csv\": ");
+	json_print_str(opts->heatmap_csv);
+	printf(",\n    \"frame_trace\": ");
+	json_print_str(opts->frame_trace);
+	printf(",\n    \"trace_out\": ");
+	json_print_str(opts->trace_out);
+	printf(",\n");
+	printf("    \"interval_ns\": %" PRIu64 ",\n", opts->interval_ns);
+	printf("    \"slowest\": %zu,\n", opts->slowest);
+	printf("    \"watchdog_ns\": %" PRIu64 ",\n", opts->watchdog_ns);
+	printf("    \"baseline\": ");
+	json_print_str(opts->baseline);
+	printf(",\n    \"save_baseline\": ");
+	json_print_str(opts->save_baseline);
+	printf(",\n");
+	printf("    \"threshold\": %lf,\n", opts->threshold);
+	printf("    \"alpha\": %lf,\n", opts->alpha);
+	print_sim_json(&opts->sim);
+	printf("    \"sweep_threads\": ");
+	print_range_json(&opts->sweep.threads);
+	printf(",\n    \"sweep_size\": ");
+	print_range_json(&opts->sweep.size);
+	printf(",\n");
+	printf("    \"sweep_p99_ns\": %" PRIu64 ",\n", opts->sweep_p99_ns);
+	printf("    \"capacity\": %zu,\n", opts->capacity);
+	printf("    \"capacity_bisect\": %s,\n",
+	       json_bool(opts->capacity_bisect));
+	printf("    \"slo\": { \"late\": %lf, \"p50_ns\": %" PRIu64
+	       ", \"p99_ns\": %" PRIu64 ", \"p99.9_ns\": %" PRIu64 " },\n",
+	       opts->slo.late, opts->slo.p50, opts->slo.p99, opts->slo.p999);
+	print_interfere_json(&opts->interfere);
+	printf("    \"job\": ");
+	json_print_str(opts->job);
+	printf("\n  },\n");
+}
+
+static void print_profile_json(const opts_t *opts)
+{
+	const profile_t *prof = &opts->profile;
+
+	printf("  \"profile\": {\n");
+	printf("    \"name\": ");
+	json_print_str(prof->name);
+	printf(",\n");
+	printf("    \"width\": %zu,\n", prof->width);
+	printf("    \"height\": %zu,\n", prof->height);
+	printf("    \"bytes_per_pixel\": %zu,\n", prof->bytes_per_pixel);
+	printf("    \"header_size\": %zu,\n", prof->header_size);
+	printf("    \"frame_size\": %zu\n", opts->frm ? opts->frm->size : 0);
+	printf("  },\n");
+}
+
+void print_header_json(const opts_t *opts)
+{
+	json_tests = 0;
+
+	printf("{\n");
+	printf("  \"version\": \"%s\",\n", FRAMETEST_VERSION);
+	print_environment_json(opts);
+	print_options_json(opts);
+	print_profile_json(opts);
+	printf("  \"tests\": [");
+}
+
+void print_footer_json(void)
+{
+	printf("%s]\n}\n", json_tests ? "\n  " : "");
+}
+
+static void print_slowest_neighbour(uint64_t lat)
+{
+	if (lat)
+		printf(" %.3lf", (double)lat / SEC_IN_MS);
+	else
+		printf(" -");
+}
+
+void print_slowest(const char *tcase, const opts_t *opts,
+		   const test_result_t *res, const topk_t *tks,
+		   size_t thread_cnt)
+{
+	topk_frame_t *frames;
+	size_t cnt;
+	size_t i;
+	size_t j;
+
+	if (!tks || !tks[0].k)
+		return;
+	frames = malloc(sizeof(*frames) * tks[0].k);
+	if (!frames)
+		return;
+	cnt = topk_merge(tks, thread_cnt, frames, tks[0].k);
+
+	printf("\nSlowest frames %s:\n", tcase);
+	printf("%3s %10s %6s %-18s %9s %9s %9s %10s %12s  %s\n", "#", "ms",
+	       "thread", opts->single_file ? "offset" : "file", "open_ms",
+	       "io_ms", "close_ms", "start_s", "wall", "neighbours_ms");
+	for (i = 0; i < cnt; i++) {
+		const topk_frame_t *f = &frames[i];
+		const test_completion_t *c = &f->comp;
+		time_t secs = f->wall / SEC_IN_NS;
+		struct tm *tm = localtime(&secs);
+		char name[32];
+		char wall[16] = "-";
+
+		if (opts->single_file)
+			snprintf(name, sizeof(name), "%" PRIu64, f->offset);
+		else
+			snprintf(name, sizeof(name), "frame%.6zu.tst",
+				 f->frame);
+		if (tm && strftime(wall, sizeof(wall), "%H:%M:%S", tm))
+			snprintf(wall + 8, sizeof(wall) - 8, ".%.3u",
+				 (unsigned int)(f->wall % SEC_IN_NS /
+						SEC_IN_MS));
+
+		printf("%3zu %10.3lf %6zu %-18s %9.3lf %9.3lf %9.3lf %10.3lf "
+		       "%12s ",
+		       i + 1, (double)f->lat / SEC_IN_MS, f->thread, name,
+		       (double)(c->open - c->start) / SEC_IN_MS,
+		       (double)(c->io - c->open) / SEC_IN_MS,
+		       (double)(c->close - c->io) / SEC_IN_MS,
+		       c->start > res->started ?
+			       (double)(c->start - res->started) / SEC_IN_NS :
+			       0,
+		       wall);
+		for (j = TOPK_NEIGHBOURS; j-- > 0;)
+			print_slowest_neighbour(f->prev[j]);
+		printf(" [*]");
+		for (j = 0; j < TOPK_NEIGHBOURS; j++)
+			print_slowest_neighbour(f->next[j]);
+		printf("\n");
+	}
+	free(frames);
+}
+
+void print_sweep_header(const opts_t *opts)
+{
+	if (opts->csv) {
+		if (!opts->no_csv_header)
+			printf("case,threads,size,fps,mibps,p50_ns,p99_ns,"
+			       "p99.9_ns\n");
+		return;
+	}
+	printf("\nSweep:\n");
+	printf("%-6s %7s %10s %10s %10s %9s %9s %9s\n", "case", "threads",
+	       "size", "fps", "MiB/s", "p50_ms", "p99_ms", "p99.9_ms");
+}
+
+void print_sweep_result(const opts_t *opts, const sweep_result_t *res)
+{
+	if (opts->csv) {
+		printf("%s,%zu,%zu,%lf,%lf,%" PRIu64 ",%" PRIu64 ",%" PRIu64
+		       "\n",
+		       res->tcase, res->threads, res->size, res->fps,
+		       res->mibps, res->p50, res->p99, res->p999);
+		return;
+	}
+	printf("%-6s %7zu %10zu %10.3lf %10.3lf %9.3lf %9.3lf %9.3lf\n",
+	       res->tcase, res->threads, res->size, res->fps, res->mibps,
+	       (double)res->p50 / SEC_IN_MS, (double)res->p99 / SEC_IN_MS,
+	       (double)res->p999 / SEC_IN_MS);
+}
+
+void print_sweep_best(const opts_t *opts, const char *tcase,
+		      const sweep_result_t *best)
+{
+	/* Keep CSV output a plain table */
+	FILE *out = opts->csv ? stderr : stdout;
+
+	fprintf(out, "Best %s", tcase);
+	if (opts->sweep_p99_ns)
+		fprintf(out, " with p99 <= %.3lf ms",
+			(double)opts->sweep_p99_ns / SEC_IN_MS);
+	if (!best) {
+		fprintf(out, ": none\n");
+		return;
+	}
+	fprintf(out, ": threads %zu, size %zu, %.3lf MiB/s, p99 %.3lf ms\n",
+		best->threads, best->size, best->mibps,
+		(double)best->p99 / SEC_IN_MS);
+}
+
+void print_capacity_header(const opts_t *opts, const capacity_slo_t *slo)
+{
+	/* Keep CSV output a plain table */
+	FILE *out = opts->csv ? stderr : stdout;
+
+	fprintf(out, "\nCapacity of %zu fps streams, SLO:", opts->fps);
+	if (slo->late >= 0)
+		fprintf(out, " late <= %.3lf%%", slo->late);
+	if (slo->p50)
+		fprintf(out, " p50 <= %.3lf ms", (double)slo->p50 / SEC_IN_MS);
+	if (slo->p99)
+		fprintf(out, " p99 <= %.3lf ms", (double)slo->p99 / SEC_IN_MS);
+	if (slo->p999)
+		fprintf(out, " p99.9 <= %.3lf ms",
+			(double)slo->p999 / SEC_IN_MS);
+	fprintf(out, "\n");
+	if (opts->csv) {
+		if (!opts->no_csv_header)
+			printf("case,streams,fps,mibps,late_pct,p50_ns,p99_ns,"
+			       "p99.9_ns,slo_met\n");
+		return;
+	}
+	printf("%-6s %7s %10s %10s %8s %9s %9s %9s %4s\n", "case", "streams",
+	       "fps", "MiB/s", "late_%", "p50_ms", "p99_ms", "p99.9_ms",
+	       "slo");
+}
+
+void print_capacity_step(const opts_t *opts, const sweep_result_t *res,
+			 int pass)
+{
+	if (opts->csv) {
+		printf("%s,%zu,%lf,%lf,%lf,%" PRIu64 ",%" PRIu64 ",%" PRIu64
+		       ",%d\n",
+		       res->tcase, res->threads, res->fps, res->mibps,
+		       res->late, res->p50, res->p99, res->p999, pass);
+		return;
+	}
+	printf("%-6s %7zu %10.3lf %10.3lf %8.3lf %9.3lf %9.3lf %9.3lf %4s\n",
+	       res->tcase, res->threads, res->fps, res->mibps, res->late,
+	       (double)res->p50 / SEC_IN_MS, (double)res->p99 / SEC_IN_MS,
+	       (double)res->p999 / SEC_IN_MS, pass ? "ok" : "fail");
+}
+
+void print_capacity_best(const opts_t *opts, const char *tcase,
+			 size_t streams)
+{
+	FILE *out = opts->csv ? stderr : stdout;
+
+	fprintf(out, "Sustainable %s streams: %zu\n", tcase, streams);
+}
+
+void print_interfere_header(const opts_t *opts, const interfere_t *bg)
+{
+	/* Keep CSV output a plain table */
+	FILE *out = opts->csv ? stderr : stdout;
+	size_t i;
+
+	fprintf(out, "\nInterference:");
+	for (i = 0; i < bg->cnt; i++) {
+		const interfere_spec_t *spec = bg->workers[i].spec;
+
+		fprintf(out, "%s %s", i ? "," : "", interfere_name(spec->type));
+		if (spec->bs)
+			fprintf(out, " %zu B", spec->bs);
+		if (spec->rate)
+			fprintf(out, " at %zu op/s", spec->rate);
+	}
+	fprintf(out, "\n");
+	if (opts->csv) {
+		if (!opts->no_csv_header)
+			printf("case,background,fps,mibps,late_pct,p50_ns,"
+			       "p99_ns,p99.9_ns\n");
+		return;
+	}
+	printf("%-6s %10s %10s %10s %8s %9s %9s %9s\n", "case", "background",
+	       "fps", "MiB/s", "late_%", "p50_ms", "p99_ms", "p99.9_ms");
+}
+
+static void print_interfere_row(const opts_t *opts, const char *bg,
+				const sweep_result_t *res)
+{
+	if (opts->csv) {
+		printf("%s,%s,%lf,%lf,%lf,%" PRIu64 ",%" PRIu64 ",%" PRIu64
+		       "\n",
+		       res->tcase, bg, res->fps, res->mibps, res->late,
+		       res->p50, res->p99, res->p999);
+		return;
+	}
+	printf("%-6s %10s %10.3lf %10.3lf %8.3lf %9.3lf %9.3lf %9.3lf\n",
+	       res->tcase, bg, res->fps, res->mibps, res->late,
+	       (double)res->p50 / SEC_IN_MS, (double)res->p99 / SEC_IN_MS,
+	       (double)res->p999 / SEC_IN_MS);
+}
+
+static double interfere_change(double quiet, double loaded)
+{
+	return quiet > 0 ? (loaded - quiet) * 100 / quiet : 0;
+}
+
+void print_interfere_result(const opts_t *opts, const sweep_result_t *quiet,
+			    const sweep_result_t *loaded,
+			    const interfere_t *bg)
+{
+	FILE *out = opts->csv ? stderr : stdout;
+	uint64_t errors = 0;
+	size_t i;
+
+	print_interfere_row(opts, "none", quiet);
+	print_interfere_row(opts, "loaded", loaded);
+	fprintf(out,
+		"Change with interference: fps %+.1lf%%, p50 %+.1lf%%, "
+		"p99 %+.1lf%%, p99.9 %+.1lf%%\n",
+		interfere_change(quiet->fps, loaded->fps),
+		interfere_change(quiet->p50, loaded->p50),
+		interfere_change(quiet->p99, loaded->p99),
+		interfere_change(quiet->p999, loaded->p999));
+	fprintf(out, "Background:");
+	for (i = 0; i < bg->cnt; i++) {
+		fprintf(out, "%s %s %.1lf op/s", i ? "," : "",
+			interfere_name(bg->workers[i].spec->type),
+			interfere_rate(bg, i));
+		errors += bg->workers[i].errors;
+	}
+	if (errors)
+		fprintf(out, ", %" PRIu64 " failed", errors);
+	fprintf(out, "\n");
+}
+
+void print_job_header(const opts_t *opts)
+{
+	if (opts->json) {
+		json_tests = 0;
+		printf("{\n");
+		printf("  \"version\": \"%s\",\n", FRAMETEST_VERSION);
+		print_environment_json(opts);
+		printf("  \"tests\": [");
+		return;
+	}
+	if (opts->csv) {
+		if (!opts->no_csv_header)
+			printf("job,case,threads,size,fps,mibps,p50_ns,p99_ns,"
+			       "p99.9_ns\n");
+		return;
+	}
+	printf("%-16s %-6s %7s %10s %10s %10s %9s %9s %9s\n", "job", "case",
+	       "threads", "size", "fps", "MiB/s", "p50_ms", "p99_ms",
+	       "p99.9_ms");
+}
+
+void print_job_result(const opts_t *opts, const char *job, const char *group,
+		      const sweep_result_t *res)
+{
+	if (opts->json) {
+		printf("%s\n    {\n", json_tests++ ? "," : "");
+		printf("      \"job\": ");
+		json_print_str(job);
+		if (group && *group) {
+			printf(",\n      \"group\": ");
+			json_print_str(group);
+		}
+		printf(",\n      \"case\": ");
+		json_print_str(res->tcase);
+		printf(",\n      \"threads\": %zu,\n", res->threads);
+		printf("      \"size\": %zu,\n", res->size);
+		printf("      \"fps\": %lf,\n", res->fps);
+		printf("      \"mibps\": %lf,\n", res->mibps);
+		printf("      \"p50_ns\": %" PRIu64 ",\n", res->p50);
+		printf("      \"p99_ns\": %" PRIu64 ",\n", res->p99);
+		printf("      \"p99.9_ns\": %" PRIu64 "\n    }", res->p999);
+		return;
+	}
+	if (opts->csv) {
+		printf("%s,%s,%zu,%zu,%lf,%lf,%" PRIu64 ",%" PRIu64
+		       ",%" PRIu64 "\n",
+		       job, res->tcase, res->threads, res->size, res->fps,
+		       res->mibps, res->p50, res->p99, res->p999);
+		return;
+	}
+	printf("%-16s %-6s %7zu %10zu %10.3lf %10.3lf %9.3lf %9.3lf %9.3lf\n",
+	       job, res->tcase, res->threads, res->size, res->fps, res->mibps,
+	       (double)res->p50 / SEC_IN_MS, (double)res->p99 / SEC_IN_MS,
+	       (double)res->p999 / SEC_IN_MS);
+}
+
+void print_job_footer(const opts_t *opts)
+{
+	if (opts->json)
+		print_footer_json();
+}
+
+void print_repeat_summary(FILE *out, const baseline_case_t *bc)
+{
+	static const struct {
+		const char *label;
+		enum BaselineField field;
+		double scale;
+	} rows[] = {
+		{ "fps", BASELINE_FPS, 1 },
+		{ "MiB/s", BASELINE_MIBPS, 1 },
+		{ "p50 ms", BASELINE_P50, SEC_IN_MS },
+		{ "p99 ms", BASELINE_P99, SEC_IN_MS },
+		{ "p99.9 ms", BASELINE_P999, SEC_IN_MS },
+	};
+	size_t i;
+
+	fprintf(out, "Repeat summary %s (%zu runs, median [95%% CI]):\n",
+		bc->name, bc->runs);
+	for (i = 0; i < sizeof(rows) / sizeof(rows[0]); i++) {
+		double lo;
+		double hi;
+		double med = baseline_median(bc, rows[i].field, &lo, &hi);
+
+		fprintf(out, "  %-10s %12.3lf [%.3lf, %.3lf]\n", rows[i].label,
+			med / rows[i].scale, lo / rows[i].scale,
+			hi / rows[i].scale);
+	}
+}
+
+static inline double cmp_change(double base, double cur)
+{
+	return base > 0 ? (cur - base) * 100 / base : 0;
+}
+
+void print_baseline_cmp(FILE *out, const char *tcase,
+			const baseline_cmp_t *cmp)
+{
+	fprintf(out, "Baseline %s:\n", tcase);
+	fprintf(out, "  fps      %12.2lf -> %12.2lf (%+.1lf%%, p=%.4lf)%s\n",
+		cmp->fps_base, cmp->fps_cur,
+		cmp_change(cmp->fps_base, cmp->fps_cur), cmp->fps_p,
+		cmp->fps_regression ? " REGRESSION" : "");
+	fprintf(out, "  p50 ms   %12.3lf -> %12.3lf (%+.1lf%%)\n",
+		(double)cmp->p50_base / SEC_IN_MS,
+		(double)cmp->p50_cur / SEC_IN_MS,
+		cmp_change(cmp->p50_base, cmp->p50_cur));
+	fprintf(out, "  p99 ms   %12.3lf -> %12.3lf (%+.1lf%%)\n",
+		(double)cmp->p99_base / SEC_IN_MS,
+		(double)cmp->p99_cur / SEC_IN_MS,
+		cmp_change(cmp->p99_base, cmp->p99_cur));
+	fprintf(out, "  latency  P(slower)=%.3lf p=%.4lf%s\n", cmp->lat_effect,
+		cmp->lat_p, cmp->lat_regression ? " REGRESSION" : "");
+}
+
+static void print_latency_json(const char *ind, const char *label,
+			       const stats_t *st, int last)
+{
+	printf("%s\"%s\": {\n", ind, label);
+	printf("%s  \"min_ns\": %" PRIu64 ",\n", ind, st->cnt ? st->min : 0);
+	printf("%s  \"avg_ns\": %lf,\n", ind, stats_mean(st));
+	printf("%s  \"max_ns\": %" PRIu64 ",\n", ind, st->max);
+	printf("%s  \"stddev_ns\": %lf,\n", ind, stats_stddev(st));
+	printf("%s  \"p50_ns\": %" PRIu64 ",\n", ind, stats_percentile(st, 50));
+	printf("%s  \"p90_ns\": %" PRIu64 ",\n", ind, stats_percentile(st, 90));
+	printf("%s  \"p95_ns\": %" PRIu64 ",\n", ind, stats_percentile(st, 95));
+	printf("%s  \"p99_ns\": %" PRIu64 ",\n", ind, stats_percentile(st, 99));
+	printf("%s  \"p99.9_ns\": %" PRIu64 ",\n", ind,
+	       stats_percentile(st, 99.9));
+	printf("%s  \"p99.99_ns\": %" PRIu64 "\n", ind,
+	       stats_percentile(st, 99.99));
+	printf("%s}%s\n", ind, last ? "" : ",");
+}
+
+static void print_histogram_json(const char *ind, const test_result_t *res)
+{
+	size_t cnt = histogram_size();
+	uint64_t *cnts;
+	size_t i;
+	int first = 1;
+
+	printf("%s\"histogram\": [", ind);
+	cnts = calloc(cnt, sizeof(*cnts));
+	if (cnts) {
+		histogram_collect(res, cnts);
+		for (i = 0; i < cnt; i++) {
+			uint64_t min;
+			uint64_t max;
+
+			if (!cnts[i])
+				continue;
+			histogram_range(i, &min, &max);
+			printf("%s\n%s  { \"min_ns\": %" PRIu64
+			       ", \"max_ns\": %" PRIu64 ", \"count\": %" PRIu64
+			       " }",
+			       first ? "" : ",", ind, min, max, cnts[i]);
+			first = 0;
+		}
+		free(cnts);
+	}
+	if (!first)
+		printf("\n%s", ind);
+	printf("]");
+}
+
+static void print_cpu_json(const char *ind, const test_result_t *res)
+{
+	printf("%s\"cpu\": {\n", ind);
+	printf("%s  \"thread_ns\": %" PRIu64 ",\n", ind, res->cpu_ns);
+	printf("%s  \"user_ns\": %" PRIu64 ",\n", ind, res->usage.user_ns);
+	printf("%s  \"sys_ns\": %" PRIu64 ",\n", ind, res->usage.sys_ns);
+	printf("%s  \"s_per_gib\": %lf,\n", ind, result_cpu_per_gib(res));
+	printf("%s  \"voluntary_csw\": %" PRIu64 ",\n", ind,
+	       res->usage.vol_csw);
+	printf("%s  \"involuntary_csw\": %" PRIu64 "\n", ind,
+	       res->usage.invol_csw);
+	printf("%s},\n", ind);
+}
+
+static void print_perf_json(const char *ind, const test_result_t *res)
+{
+	int first = 1;
+	int i;
+
+	printf("%s\"counters\": {", ind);
+	for (i = 0; i < PERF_EVENT_CNT; i++) {
+		if (!(res->perf.valid & (1U << i)))
+			continue;
+		printf("%s\n%s  \"%s\": { \"total\": %" PRIu64
+		       ", \"per_gib\": %lf }",
+		       first ? "" : ",", ind, perf_event_name(i),
+		       res->perf.val[i], result_per_gib(res, res->perf.val[i]));
+		first = 0;
+	}
+	if (!first)
+		printf("\n%s", ind);
+	printf("},\n");
+}
+
+static void print_result_json(const char *ind, const test_result_t *res,
+			      const opts_t *opts)
+{
+	char sub[32];
+	stats_t *st;
+	double secs;
+
+	secs = res->time_taken_ns ? (double)res->time_taken_ns / SEC_IN_NS : 0;
+
+	printf("%s\"frames\": %" PRIu64 ",\n", ind, res->frames_written);
+	printf("%s\"bytes\": %" PRIu64 ",\n", ind, res->bytes_written);
+	printf("%s\"time_ns\": %" PRIu64 ",\n", ind, res->time_taken_ns);
+	printf("%s\"fps\": %lf,\n", ind,
+	       secs ? res->frames_written / secs : 0);
+	printf("%s\"bps\": %lf,\n", ind, secs ? res->bytes_written / secs : 0);
+	printf("%s\"mibps\": %lf,\n", ind,
+	       secs ? res->bytes_written / secs / (1024 * 1024) : 0);
+	printf("%s\"late_frames\": %" PRIu64 ",\n", ind, res->late);
+
+	snprintf(sub, sizeof(sub), "%s  ", ind);
+	st = malloc(sizeof(*st));
+	printf("%s\"latency\": {\n", ind);
+	if (st) {
+		result_stats(res, COMP_FRAME, st);
+		print_latency_json(sub, "frame", st, 0);
+		if (opts->sched) {
+			result_stats(res, COMP_SCHED, st);
+			print_latency_json(sub, "frame_from_schedule", st, 0);
+		}
+		if (res->burst) {
+			print_latency_json(sub, "first_after_idle",
+					   &res->burst[BURST_FIRST], 0);
+			print_latency_json(sub, "in_burst",
+					   &res->burst[BURST_REST], 0);
+		}
+		if (res->seek) {
+			print_latency_json(sub, "seek_to_first_frame",
+					   &res->seek[SEEK_FIRST], 0);
+			print_latency_json(sub, "after_seek",
+					   &res->seek[SEEK_REST], 0);
+		}
+		result_stats(res, COMP_OPEN, st);
+		print_latency_json(sub, "open", st, 0);
+		result_stats(res, COMP_IO, st);
+		print_latency_json(sub, "io", st, 0);
+		result_stats(res, COMP_CLOSE, st);
+		print_latency_json(sub, "close", st, !opts->cpu);
+		if (opts->cpu) {
+			result_stats(res, COMP_CPU, st);
+			print_latency_json(sub, "on_cpu", st, 0);
+			result_stats(res, COMP_OFF_CPU, st);
+			print_latency_json(sub, "off_cpu", st, 1);
+		}
+		free(st);
+	}
+	printf("%s},\n", ind);
+	if (opts->cpu)
+		print_cpu_json(ind, res);
+	if (opts->perf)
+		print_perf_json(ind, res);
+	print_histogram_json(ind, res);
+}
+
+static void print_intervals_json(const test_result_t *res,
+				 const telemetry_t *tm)
+{
+	double frame_size = interval_frame_size(res);
+	interval_t *iv;
+	size_t i;
+
+	iv = intervals_collect(res, tm);
+	if (!iv)
+		return;
+
+	printf(",\n      \"intervals\": [");
+	for (i = 0; i + 1 < tm->cnt; i++) {
+		const telemetry_sample_t *a = &tm->samples[i];
+		const telemetry_sample_t *b = &tm->samples[i + 1];
+		uint64_t ns = b->time - a->time;
+		double fps = ns ? (double)iv[i].frames * SEC_IN_NS / ns : 0;
+
+		printf("%s\n        { \"start_ns\": %" PRIu64
+		       ", \"duration_ns\": %" PRIu64 ", \"fps\": %lf"
+		       ", \"mibps\": %lf, \"lat_max_ns\": %" PRIu64,
+		       i ? "," : "",
+		       a->time > res->started ? a->time - res->started : 0, ns,
+		       fps, fps * frame_size / (1024 * 1024), iv[i].lat_max);
+		if (tm->sources & TELEMETRY_DISK) {
+			printf(", \"dev_rd_sectors\": %" PRIu64
+			       ", \"dev_wr_sectors\": %" PRIu64
+			       ", \"dev_in_flight\": %" PRIu64
+			       ", \"dev_io_ticks_ms\": %" PRIu64
+			       ", \"dev_queue_ms\": %" PRIu64,
+			       b->rd_sectors - a->rd_sectors,
+			       b->wr_sectors - a->wr_sectors, b->in_flight,
+			       b->io_ticks_ms - a->io_ticks_ms,
+			       b->queue_ms - a->queue_ms);
+		}
+		if (tm->sources & TELEMETRY_MEM)
+			printf(", \"dirty_kb\": %" PRIu64
+			       ", \"writeback_kb\": %" PRIu64,
+			       b->dirty_kb, b->writeback_kb);
+		if (tm->sources & TELEMETRY_PSI)
+			printf(", \"psi_some_us\": %" PRIu64
+			       ", \"psi_full_us\": %" PRIu64,
+			       b->psi_some_us - a->psi_some_us,
+			       b->psi_full_us - a->psi_full_us);
+		printf(" }");
+	}
+	printf("%s]", i ? "\n      " : "");
+	free(iv);
+}
+
+static void print_jitter_json(const opts_t *opts,
+			      const test_result_t *thread_res,
+			      size_t thread_cnt)
+{
+	jitter_t *jt = jitter_get(opts, thread_res, thread_cnt);
+	size_t i;
+
+	if (!jt)
+		return;
+
+	printf(",\n      \"delivery_interval\": {\n");
+	if (jt->nominal)
+		printf("        \"period_ns\": %" PRIu64 ",\n", jt->period);
+	printf("        \"max_gap_frame\": %" PRIu64 ",\n",
+	       jt->max_gap_frame);
+	printf("        \"period_bins\": [");
+	for (i = 0; i < JITTER_BINS; i++)
+		printf("%s%" PRIu64, i ? ", " : "", jt->bins[i]);
+	printf("],\n");
+	print_latency_json("        ", "interval", &jt->st, 1);
+	printf("      }");
+	free(jt);
+}
+
+static inline double steady_phase_fps(const steady_phase_t *ph)
+{
+	return ph->ns ? (double)ph->frames * SEC_IN_NS / ph->ns : 0;
+}
+
+static inline double steady_phase_mibps(const steady_phase_t *ph)
+{
+	return ph->ns ? (double)ph->bytes * SEC_IN_NS / (1024 * 1024) / ph->ns :
+			0;
+}
+
+static void print_steady_phase(const char *label, const steady_phase_t *ph)
+{
+	printf("%-10s %10.3lf %10" PRIu64 " %10.3lf %10.3lf %9.3lf %9.3lf\n",
+	       label, (double)ph->ns / SEC_IN_NS, ph->frames,
+	       steady_phase_fps(ph), steady_phase_mibps(ph),
+	       (double)stats_percentile(&ph->lat, 50) / SEC_IN_MS,
+	       (double)stats_percentile(&ph->lat, 99) / SEC_IN_MS);
+}
+
+void print_steady(const char *tcase, const steady_t *sd)
+{
+	double fps_cv = steady_variation(sd, 0);
+	double p99_cv = steady_variation(sd, 1);
+
+	if (!sd->slots)
+		return;
+
+	printf("\nSteady state %s: ", tcase);
+	if (sd->steady_at)
+		printf("reached after %.3lf s",
+		       (double)sd->steady_at / SEC_IN_NS);
+	else
+		printf("not reached");
+	if (isfinite(fps_cv) && isfinite(p99_cv))
+		printf(", variation fps %.2lf%% p99 %.2lf%%", fps_cv, p99_cv);
+	printf("\n");
+	printf("%-10s %10s %10s %10s %10s %9s %9s\n", "", "time_s", "frames",
+	       "fps", "MiB/s", "p50_ms", "p99_ms");
+	print_steady_phase("transient", &sd->transient);
+	if (sd->steady_at)
+		print_steady_phase("steady", &sd->steady);
+}
+
+static void print_steady_phase_json(const char *label,
+				    const steady_phase_t *ph, int last)
+{
+	printf("        \"%s\": {\n", label);
+	printf("          \"time_ns\": %" PRIu64 ",\n", ph->ns);
+	printf("          \"frames\": %" PRIu64 ",\n", ph->frames);
+	printf("          \"bytes\": %" PRIu64 ",\n", ph->bytes);
+	printf("          \"fps\": %lf,\n", steady_phase_fps(ph));
+	printf("          \"mibps\": %lf,\n", steady_phase_mibps(ph));
+	print_latency_json("          ", "frame", &ph->lat, 1);
+	printf("        }%s\n", last ? "" : ",");
+}
+
+static void print_steady_json(const steady_t *sd)
+{
+	double fps_cv;
+	double p99_cv;
+
+	if (!sd || !sd->slots)
+		return;
+
+	fps_cv = steady_variation(sd, 0);
+	p99_cv = steady_variation(sd, 1);
+	printf(",\n      \"steady_state\": {\n");
+	printf("        \"reached\": %s,\n", json_bool(sd->steady_at != 0));
+	printf("        \"reached_ns\": %" PRIu64 ",\n", sd->steady_at);
+	if (isfinite(fps_cv) && isfinite(p99_cv)) {
+		printf("        \"fps_cv_pct\": %lf,\n", fps_cv);
+		printf("        \"p99_cv_pct\": %lf,\n", p99_cv);
+	} else {
+		printf("        \"fps_cv_pct\": null,\n");
+		printf("        \"p99_cv_pct\": null,\n");
+	}
+	print_steady_phase_json("transient", &sd->transient, 0);
+	print_steady_phase_json("steady", &sd->steady, 1);
+	printf("      }");
+}
+
+void print_results_json(const char *tcase, const opts_t *opts,
+			const test_result_t *res,
+			const test_result_t *thread_res, size_t thread_cnt,
+			const telemetry_t *tm, const steady_t *sd)
+{
+	size_t i;
+
+	if (!res)
+		return;
+
+	printf("%s\n    {\n", json_tests ? "," : "");
+	printf("      \"case\": ");
+	json_print_str(tcase);
+	printf(",\n");
+	print_result_json("      ", res, opts);
+	if (thread_cnt) {
+		fairness_t fair;
+
+		fairness_calc(res, thread_res, thread_cnt, &fair);
+		printf(",\n      \"fairness\": {\n");
+		printf("        \"jain_index\": %lf,\n", fair.jain);
+		if (fair.max_min > 0)
+			printf("        \"max_min_ratio\": %lf,\n",
+			       fair.max_min);
+		else
+			printf("        \"max_min_ratio\": null,\n");
+		printf("        \"slowest_finish_ns\": %" PRIu64 ",\n",
+		       fair.slowest_finish);
+		printf("        \"median_finish_ns\": %" PRIu64 "\n",
+		       fair.median_finish);
+		printf("      }");
+	}
+	print_intervals_json(res, tm);
+	print_jitter_json(opts, thread_res, thread_cnt);
+	print_steady_json(sd);
+	printf(",\n      \"threads\": [");
+	for (i = 0; i < thread_cnt; i++) {
+		printf("%s\n        {\n", i ? "," : "");
+		printf("          \"id\": %zu,\n", i);
+		printf("          \"finish_ns\": %" PRIu64 ",\n",
+		       result_finish(res, &thread_res[i]));
+		print_result_json("          ", &thread_res[i], opts);
+		printf("\n        }");
+	}
+	printf("%s]\n    }", thread_cnt ? "\n      " : "");
+	++json_tests;
+}
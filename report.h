@@ -21,13 +21,58 @@
 #ifndef FRAMETEST_REPORT_H
 #define FRAMETEST_REPORT_H
 
+#include <stdio.h>
+#include "baseline.h"
 #include "tester.h"
 #include "frametest.h"
+#include "steady.h"
+#include "telemetry.h"
+#include "topk.h"
 
+extern void print_timer(void);
 extern void print_header_csv(const opts_t *opts);
 extern void print_results_csv(const char *tcase, const opts_t *opts,
-			      const test_result_t *res);
+			      const test_result_t *res,
+			      const test_result_t *thread_res,
+			      size_t thread_cnt);
 extern void print_results(const char *tcase, const opts_t *opts,
-			  const test_result_t *res);
+			  const test_result_t *res,
+			  const test_result_t *thread_res, size_t thread_cnt);
+extern void print_header_json(const opts_t *opts);
+extern void print_results_json(const char *tcase, const opts_t *opts,
+			       const test_result_t *res,
+			       const test_result_t *thread_res,
+			       size_t thread_cnt, const telemetry_t *tm,
+			       const steady_t *sd);
+extern void print_intervals(const char *tcase, const test_result_t *res,
+			    const telemetry_t *tm);
+extern void print_footer_json(void);
+extern void print_slowest(const char *tcase, const opts_t *opts,
+			  const test_result_t *res, const topk_t *tks,
+			  size_t thread_cnt);
+extern void print_steady(const char *tcase, const steady_t *sd);
+extern void print_sweep_header(const opts_t *opts);
+extern void print_sweep_result(const opts_t *opts, const sweep_result_t *res);
+extern void print_sweep_best(const opts_t *opts, const char *tcase,
+			     const sweep_result_t *best);
+extern void print_capacity_header(const opts_t *opts,
+				  const capacity_slo_t *slo);
+extern void print_capacity_step(const opts_t *opts, const sweep_result_t *res,
+				int pass);
+extern void print_capacity_best(const opts_t *opts, const char *tcase,
+				size_t streams);
+extern void print_interfere_header(const opts_t *opts,
+				   const interfere_t *bg);
+extern void print_interfere_result(const opts_t *opts,
+				   const sweep_result_t *quiet,
+				   const sweep_result_t *loaded,
+				   const interfere_t *bg);
+extern void print_job_header(const opts_t *opts);
+extern void print_job_result(const opts_t *opts, const char *job,
+			     const char *group, const sweep_result_t *res);
+extern void print_job_footer(const opts_t *opts);
+extern void print_repeat_summary(FILE *out, const baseline_case_t *bc);
+extern void print_baseline_cmp(FILE *out, const char *tcase,
+			       const baseline_cmp_t *cmp);
 
 #endif
@@ -0,0 +1,390 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "frametest.h"
+#include "sim.h"
+#include "timing.h"
+
+#define SIM_MAX_HANDLES 1024
+
+typedef struct sim_handle_t {
+	int used;
+	uint64_t name;
+	uint64_t pos;
+} sim_handle_t;
+
+static sim_config_t sim_cfg;
+/* Typical oversleep, sleeps end this much before the deadline */
+static uint64_t sim_sleep_ns;
+static platform_t sim_platform;
+static pthread_mutex_t sim_lock = PTHREAD_MUTEX_INITIALIZER;
+static sim_handle_t sim_handles[SIM_MAX_HANDLES];
+static uint64_t sim_inflight;
+static uint64_t sim_file_size;
+static uint64_t sim_epoch;
+
+void sim_config_default(sim_config_t *cfg)
+{
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->bandwidth = 1000UL * 1024 * 1024;
+	cfg->latency_ns = 100000;
+	cfg->jitter = 0.2;
+	cfg->qd_factor = 0.1;
+	cfg->tail_prob = 0.001;
+	cfg->tail_alpha = 1.5;
+	cfg->open_ns = 20000;
+	cfg->close_ns = 10000;
+	cfg->seed = 1;
+}
+
+/*
+ * Comma separated key=value list:
+ *   bw=MiB/s, lat=us, jitter=sigma, qd=factor, tail=probability,
+ *   alpha=pareto-shape, stall=period-ms:duration-ms, open=us, close=us,
+ *   seed=N
+ */
+int sim_config_parse(sim_config_t *cfg, const char *str)
+{
+	char buf[256];
+	char *tok;
+	char *save = NULL;
+
+	if (!cfg || !str)
+		return 1;
+	if (snprintf(buf, sizeof(buf), "%s", str) >= (int)sizeof(buf))
+		return 1;
+
+	for (tok = strtok_r(buf, ",", &save); tok;
+	     tok = strtok_r(NULL, ",", &save)) {
+		char *val = strchr(tok, '=');
+		char *endp = NULL;
+		double num;
+
+		if (!val)
+			return 1;
+		*val++ = 0;
+
+		if (!strcmp(tok, "stall")) {
+			double dur;
+
+			num = strtod(val, &endp);
+			if (!endp || *endp != ':')
+				return 1;
+			dur = strtod(endp + 1, &endp);
+			if (!endp || *endp || num < 0 || dur < 0 || dur > num)
+				return 1;
+			cfg->stall_period_ns = num * SEC_IN_MS;
+			cfg->stall_ns = dur * SEC_IN_MS;
+			continue;
+		}
+
+		num = strtod(val, &endp);
+		if (!endp || *endp || num < 0)
+			return 1;
+
+		if (!strcmp(tok, "bw"))
+			cfg->bandwidth = num * 1024 * 1024;
+		else if (!strcmp(tok, "lat"))
+			cfg->latency_ns = num * 1000;
+		else if (!strcmp(tok, "jitter"))
+			cfg->jitter = num;
+		else if (!strcmp(tok, "qd"))
+			cfg->qd_factor = num;
+		else if (!strcmp(tok, "tail") && num <= 1)
+			cfg->tail_prob = num;
+		else if (!strcmp(tok, "alpha") && num > 0)
+			cfg->tail_alpha = num;
+		else if (!strcmp(tok, "open"))
+			cfg->open_ns = num * 1000;
+		else if (!strcmp(tok, "close"))
+			cfg->close_ns = num * 1000;
+		else if (!strcmp(tok, "seed"))
+			cfg->seed = num;
+		else
+			return 1;
+	}
+
+	return 0;
+}
+
+static inline uint64_t sim_mix(uint64_t x)
+{
+	/* splitmix64 finalizer */
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+static inline double sim_uniform(uint64_t *state)
+{
+	*state = sim_mix(*state);
+	/* (0, 1], never zero so it's safe for log() and pow() */
+	return ((*state >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+static inline double sim_normal(uint64_t *state)
+{
+	double u1 = sim_uniform(state);
+	double u2 = sim_uniform(state);
+
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static uint64_t sim_hash(const char *str)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+
+	while (*str) {
+		hash ^= (unsigned char)*str++;
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+static uint64_t sim_service_ns(uint64_t rng, size_t size, uint64_t inflight)
+{
+	double ns = sim_cfg.latency_ns;
+
+	if (sim_cfg.jitter > 0)
+		ns *= exp(sim_cfg.jitter * sim_normal(&rng));
+	if (sim_cfg.tail_prob > 0 && sim_uniform(&rng) <= sim_cfg.tail_prob)
+		ns *= pow(sim_uniform(&rng), -1.0 / sim_cfg.tail_alpha);
+	if (inflight > 1)
+		ns *= 1 + sim_cfg.qd_factor * (inflight - 1);
+	if (sim_cfg.bandwidth)
+		ns += (double)size * inflight * SEC_IN_NS / sim_cfg.bandwidth;
+
+	return ns;
+}
+
+/* Stalls occupy the last stall_ns of every stall period */
+static uint64_t sim_stall_end(uint64_t now)
+{
+	uint64_t phase;
+
+	if (!sim_cfg.stall_period_ns || !sim_cfg.stall_ns || now < sim_epoch)
+		return now;
+
+	phase = (now - sim_epoch) % sim_cfg.stall_period_ns;
+	if (phase < sim_cfg.stall_period_ns - sim_cfg.stall_ns)
+		return now;
+
+	return now + sim_cfg.stall_period_ns - phase;
+}
+
+static void sim_wait_until(uint64_t deadline)
+{
+	uint64_t now = timing_time();
+
+	if (deadline > now + sim_sleep_ns) {
+		struct timespec ts;
+		uint64_t ns = deadline - now - sim_sleep_ns;
+
+		ts.tv_sec = ns / SEC_IN_NS;
+		ts.tv_nsec = ns % SEC_IN_NS;
+		nanosleep(&ts, NULL);
+	}
+	/* Only what's left of a shorter than usual oversleep is spun */
+	while (timing_time() < deadline)
+		;
+}
+
+static inline sim_handle_t *sim_get(platform_handle_t handle)
+{
+	if (handle <= 0 || handle > SIM_MAX_HANDLES)
+		return NULL;
+	if (!sim_handles[handle - 1].used)
+		return NULL;
+
+	return &sim_handles[handle - 1];
+}
+
+static platform_handle_t sim_open(const char *fname,
+				  platform_open_flags_t flags, int mode)
+{
+	platform_handle_t res = -1;
+	uint64_t start = timing_time();
+	size_t i;
+
+	(void)flags;
+	(void)mode;
+
+	pthread_mutex_lock(&sim_lock);
+	for (i = 0; i < SIM_MAX_HANDLES; i++) {
+		if (sim_handles[i].used)
+			continue;
+		sim_handles[i].used = 1;
+		sim_handles[i].name = sim_hash(fname);
+		sim_handles[i].pos = 0;
+		res = i + 1;
+		break;
+	}
+	pthread_mutex_unlock(&sim_lock);
+
+	if (res > 0 && sim_cfg.open_ns)
+		sim_wait_until(sim_stall_end(start) + sim_cfg.open_ns);
+
+	return res;
+}
+
+static int sim_close(platform_handle_t handle)
+{
+	uint64_t start = timing_time();
+	sim_handle_t *h;
+
+	pthread_mutex_lock(&sim_lock);
+	h = sim_get(handle);
+	if (h)
+		h->used = 0;
+	pthread_mutex_unlock(&sim_lock);
+	if (!h)
+		return -1;
+
+	if (sim_cfg.close_ns)
+		sim_wait_until(sim_stall_end(start) + sim_cfg.close_ns);
+
+	return 0;
+}
+
+static size_t sim_io(platform_handle_t handle, size_t size, int write)
+{
+	uint64_t start = timing_time();
+	uint64_t inflight;
+	uint64_t rng;
+	sim_handle_t *h;
+
+	pthread_mutex_lock(&sim_lock);
+	h = sim_get(handle);
+	if (!h) {
+		pthread_mutex_unlock(&sim_lock);
+		return 0;
+	}
+	inflight = ++sim_inflight;
+	rng = sim_mix(sim_cfg.seed ^ h->name ^ sim_mix(h->pos));
+	pthread_mutex_unlock(&sim_lock);
+
+	sim_wait_until(sim_stall_end(start) +
+		       sim_service_ns(rng, size, inflight));
+
+	pthread_mutex_lock(&sim_lock);
+	--sim_inflight;
+	h->pos += size;
+	if (write && size > sim_file_size)
+		sim_file_size = size;
+	pthread_mutex_unlock(&sim_lock);
+
+	return size;
+}
+
+static size_t sim_write(platform_handle_t handle, const char *buf, size_t size)
+{
+	(void)buf;
+	return sim_io(handle, size, 1);
+}
+
+static size_t sim_read(platform_handle_t handle, char *buf, size_t size)
+{
+	(void)buf;
+	return sim_io(handle, size, 0);
+}
+
+static platform_off_t sim_seek(platform_handle_t handle, platform_off_t offs,
+			       platform_seek_flags_t whence)
+{
+	sim_handle_t *h;
+	platform_off_t res = -1;
+
+	pthread_mutex_lock(&sim_lock);
+	h = sim_get(handle);
+	if (h) {
+		switch (whence) {
+		case PLATFORM_SEEK_SET:
+			h->pos = offs;
+			break;
+		case PLATFORM_SEEK_CUR:
+			h->pos += offs;
+			break;
+		case PLATFORM_SEEK_END:
+			h->pos = sim_file_size + offs;
+			break;
+		}
+		res = h->pos;
+	}
+	pthread_mutex_unlock(&sim_lock);
+
+	return res;
+}
+
+/* Every file looks like it holds one frame of the largest write seen */
+static int sim_stat(const char *fname, platform_stat_t *st)
+{
+	(void)fname;
+
+	pthread_mutex_lock(&sim_lock);
+	memset(st, 0, sizeof(*st));
+	st->size = sim_file_size;
+	st->nlink = 1;
+	st->blksize = ALIGN_SIZE;
+	st->blocks = (sim_file_size + 511) / 512;
+	pthread_mutex_unlock(&sim_lock);
+
+	return sim_file_size ? 0 : -1;
+}
+
+const platform_t *sim_platform_get(const sim_config_t *cfg)
+{
+	timing_info_t info;
+
+	if (!cfg)
+		return NULL;
+
+	timing_get_info(&info);
+	sim_sleep_ns = info.sleep_ns;
+	sim_cfg = *cfg;
+	sim_epoch = timing_time();
+	sim_inflight = 0;
+	memset(sim_handles, 0, sizeof(sim_handles));
+
+	/* Memory and threads come from the real platform */
+	sim_platform = *platform_get();
+	sim_platform.open = sim_open;
+	sim_platform.close = sim_close;
+	sim_platform.write = sim_write;
+	sim_platform.read = sim_read;
+	sim_platform.seek = sim_seek;
+	sim_platform.stat = sim_stat;
+	sim_platform.priv = &sim_cfg;
+
+	return &sim_platform;
+}
@@ -0,0 +1,57 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_SIM_H
+#define FRAMETEST_SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "platform.h"
+
+/*
+ * Simulated storage device. Nothing is stored, I/O calls just take the
+ * time the model gives for them:
+ *   latency * lognormal(jitter) [* pareto(alpha) with probability tail]
+ *   * (1 + qd * (in-flight - 1)) + size * in-flight / bandwidth
+ * and are delayed to the end of a stall when one is active. Random
+ * values are seeded per file and offset, so the same frame always gets
+ * the same latency regardless of thread interleaving.
+ */
+typedef struct sim_config_t {
+	/* Device bandwidth in bytes per second, 0 is unlimited */
+	uint64_t bandwidth;
+	uint64_t latency_ns;
+	double jitter;
+	double qd_factor;
+	double tail_prob;
+	double tail_alpha;
+	uint64_t stall_period_ns;
+	uint64_t stall_ns;
+	uint64_t open_ns;
+	uint64_t close_ns;
+	uint64_t seed;
+} sim_config_t;
+
+void sim_config_default(sim_config_t *cfg);
+int sim_config_parse(sim_config_t *cfg, const char *str);
+
+const platform_t *sim_platform_get(const sim_config_t *cfg);
+
+#endif
@@ -0,0 +1,358 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stats.h"
+
+/* Largest sample for exact Mann-Whitney distribution */
+#define STATS_MW_EXACT_MAX 50
+
+static inline size_t stats_msb(uint64_t val)
+{
+#if defined(__GNUC__)
+	return 63 - __builtin_clzll(val);
+#else
+	size_t res = 0;
+
+	while (val >>= 1)
+		++res;
+	return res;
+#endif
+}
+
+size_t stats_bucket(uint64_t val)
+{
+	size_t shift;
+
+	if (val < 2 * STATS_SUB_CNT)
+		return val;
+
+	shift = stats_msb(val) - STATS_SUB_BITS;
+
+	return shift * STATS_SUB_CNT + (val >> shift);
+}
+
+uint64_t stats_bucket_min(size_t bucket)
+{
+	size_t shift;
+	uint64_t sub;
+
+	if (bucket < 2 * STATS_SUB_CNT)
+		return bucket;
+
+	shift = bucket / STATS_SUB_CNT - 1;
+	sub = bucket % STATS_SUB_CNT + STATS_SUB_CNT;
+
+	return sub << shift;
+}
+
+uint64_t stats_bucket_max(size_t bucket)
+{
+	size_t shift;
+	uint64_t sub;
+
+	if (bucket < 2 * STATS_SUB_CNT)
+		return bucket;
+
+	shift = bucket / STATS_SUB_CNT - 1;
+	sub = bucket % STATS_SUB_CNT + STATS_SUB_CNT;
+
+	/* Last bucket wraps around to UINT64_MAX */
+	return ((sub + 1) << shift) - 1;
+}
+
+void stats_init(stats_t *st)
+{
+	if (!st)
+		return;
+
+	memset(st, 0, sizeof(*st));
+	st->min = UINT64_MAX;
+}
+
+void stats_add(stats_t *st, uint64_t val)
+{
+	++st->cnt;
+	st->sum += val;
+	st->sum_sq += (double)val * val;
+	if (val < st->min)
+		st->min = val;
+	if (val > st->max)
+		st->max = val;
+	++st->buckets[stats_bucket(val)];
+}
+
+void stats_merge(stats_t *dst, const stats_t *src)
+{
+	size_t i;
+
+	if (!dst || !src || !src->cnt)
+		return;
+
+	dst->cnt += src->cnt;
+	dst->sum += src->sum;
+	dst->sum_sq += src->sum_sq;
+	if (src->min < dst->min)
+		dst->min = src->min;
+	if (src->max > dst->max)
+		dst->max = src->max;
+	for (i = 0; i < STATS_BUCKETS; i++)
+		dst->buckets[i] += src->buckets[i];
+}
+
+double stats_mean(const stats_t *st)
+{
+	if (!st->cnt)
+		return 0;
+
+	return (double)st->sum / st->cnt;
+}
+
+double stats_stddev(const stats_t *st)
+{
+	double mean;
+	double var;
+
+	if (st->cnt < 2)
+		return 0;
+
+	mean = stats_mean(st);
+	var = st->sum_sq / st->cnt - mean * mean;
+	if (var <= 0)
+		return 0;
+
+	return sqrt(var);
+}
+
+uint64_t stats_percentile(const stats_t *st, double pct)
+{
+	uint64_t rank;
+	uint64_t seen = 0;
+	size_t i;
+
+	if (!st->cnt)
+		return 0;
+	if (pct <= 0)
+		return st->min;
+	if (pct >= 100)
+		return st->max;
+
+	rank = (uint64_t)ceil(pct / 100.0 * st->cnt);
+	if (!rank)
+		rank = 1;
+
+	for (i = 0; i < STATS_BUCKETS; i++) {
+		uint64_t lo;
+		uint64_t hi;
+		uint64_t val;
+
+		seen += st->buckets[i];
+		if (seen < rank)
+			continue;
+
+		/* Report the middle of the bucket, bounded by real extremes */
+		lo = stats_bucket_min(i);
+		hi = stats_bucket_max(i);
+		val = lo + (hi - lo) / 2;
+		if (val < st->min)
+			val = st->min;
+		if (val > st->max)
+			val = st->max;
+		return val;
+	}
+
+	return st->max;
+}
+
+/* Two-sided p-value of Mann-Whitney U, normal approximation */
+static double stats_mw_p(double u, double n1, double n2, double ties)
+{
+	double n = n1 + n2;
+	double var;
+	double z;
+
+	if (n1 < 1 || n2 < 1 || n < 3)
+		return 1;
+
+	var = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)));
+	if (var <= 0)
+		return 1;
+
+	/* Continuity correction */
+	z = fabs(u - n1 * n2 / 2);
+	z = z > 0.5 ? (z - 0.5) / sqrt(var) : 0;
+
+	return erfc(z / sqrt(2));
+}
+
+double stats_mann_whitney(const stats_t *a, const stats_t *b, double *effect)
+{
+	double below = 0;
+	double ties = 0;
+	double u = 0;
+	size_t i;
+
+	if (effect)
+		*effect = 0.5;
+	if (!a->cnt || !b->cnt)
+		return 1;
+
+	/* Values in the same bucket count as ties */
+	for (i = 0; i < STATS_BUCKETS; i++) {
+		double na = a->buckets[i];
+		double nb = b->buckets[i];
+		double t = na + nb;
+
+		u += na * (below + nb / 2);
+		below += nb;
+		ties += t * t * t - t;
+	}
+	if (effect)
+		*effect = u / ((double)a->cnt * b->cnt);
+
+	return stats_mw_p(u, a->cnt, b->cnt, ties);
+}
+
+/*
+ * Exact two-sided p-value of U without ties. Counts of orderings giving
+ * each U are the coefficients of the Gaussian binomial (n1 + n2, n1).
+ */
+static double stats_mw_exact(double u, size_t n1, size_t n2)
+{
+	size_t deg = n1 * n2;
+	double *c;
+	double total = 0;
+	double lower = 0;
+	double upper = 0;
+	size_t i;
+	size_t k;
+
+	c = calloc(deg + 1, sizeof(*c));
+	if (!c)
+		return -1;
+
+	c[0] = 1;
+	for (i = 1; i <= n1; i++) {
+		size_t a = n2 + i;
+
+		/* Multiply by (1 - q^a), then divide by (1 - q^i) */
+		for (k = deg; k >= a; k--)
+			c[k] -= c[k - a];
+		for (k = i; k <= deg; k++)
+			c[k] += c[k - i];
+	}
+	for (k = 0; k <= deg; k++) {
+		total += c[k];
+		if (k <= u)
+			lower += c[k];
+		if (k >= u)
+			upper += c[k];
+	}
+	free(c);
+
+	lower = 2 * (lower < upper ? lower : upper) / total;
+
+	return lower < 1 ? lower : 1;
+}
+
+double stats_mann_whitney_values(const double *a, size_t na, const double *b,
+				 size_t nb, double *effect)
+{
+	double ties = 0;
+	double u = 0;
+	size_t i;
+	size_t j;
+
+	if (effect)
+		*effect = 0.5;
+	if (!na || !nb)
+		return 1;
+
+	for (i = 0; i < na; i++) {
+		for (j = 0; j < nb; j++) {
+			if (a[i] > b[j])
+				u += 1;
+			else if (a[i] == b[j])
+				u += 0.5;
+		}
+	}
+
+	/* Sum of t^3 - t over tie groups equals sum of t^2 - 1 per value */
+	for (i = 0; i < na + nb; i++) {
+		double v = i < na ? a[i] : b[i - na];
+		double t = 0;
+
+		for (j = 0; j < na + nb; j++)
+			t += (j < na ? a[j] : b[j - na]) == v;
+		ties += t * t - 1;
+	}
+	if (effect)
+		*effect = u / ((double)na * nb);
+
+	/* Normal approximation is too conservative for a few runs */
+	if (!ties && na <= STATS_MW_EXACT_MAX && nb <= STATS_MW_EXACT_MAX) {
+		double p = stats_mw_exact(u, na, nb);
+
+		if (p >= 0)
+			return p;
+	}
+
+	return stats_mw_p(u, na, nb, ties);
+}
+
+static int stats_cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+void stats_median_ci(double *vals, size_t cnt, double *median, double *lo,
+		     double *hi)
+{
+	double half;
+	long j;
+	long k;
+
+	*median = *lo = *hi = 0;
+	if (!cnt)
+		return;
+
+	qsort(vals, cnt, sizeof(*vals), stats_cmp_double);
+	if (cnt % 2)
+		*median = vals[cnt / 2];
+	else
+		*median = (vals[cnt / 2 - 1] + vals[cnt / 2]) / 2;
+
+	/* 95% distribution free interval from order statistics, 1-based */
+	half = 1.96 * sqrt(cnt) / 2;
+	j = (long)floor(cnt / 2.0 - half);
+	k = (long)ceil(1 + cnt / 2.0 + half);
+	if (j < 1)
+		j = 1;
+	if (k > (long)cnt)
+		k = cnt;
+	*lo = vals[j - 1];
+	*hi = vals[k - 1];
+}
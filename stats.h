@@ -0,0 +1,68 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_STATS_H
+#define FRAMETEST_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Log-linear latency histogram: every power of two range is split into
+ * STATS_SUB_CNT linear sub buckets, which keeps the relative error of
+ * the reported percentiles below 1 / STATS_SUB_CNT.
+ */
+#define STATS_SUB_BITS 5
+#define STATS_SUB_CNT (1U << STATS_SUB_BITS)
+#define STATS_BUCKETS ((64 - STATS_SUB_BITS + 1) * STATS_SUB_CNT)
+
+typedef struct stats_t {
+	uint64_t cnt;
+	uint64_t min;
+	uint64_t max;
+	uint64_t sum;
+	double sum_sq;
+	uint64_t buckets[STATS_BUCKETS];
+} stats_t;
+
+void stats_init(stats_t *st);
+void stats_add(stats_t *st, uint64_t val);
+void stats_merge(stats_t *dst, const stats_t *src);
+
+double stats_mean(const stats_t *st);
+double stats_stddev(const stats_t *st);
+uint64_t stats_percentile(const stats_t *st, double pct);
+
+/*
+ * Mann-Whitney U test, returns the two-sided p-value. Effect is the
+ * probability of a value from a being larger than one from b.
+ */
+double stats_mann_whitney(const stats_t *a, const stats_t *b, double *effect);
+double stats_mann_whitney_values(const double *a, size_t na, const double *b,
+				 size_t nb, double *effect);
+/* Sorts vals, gives the median and its 95% confidence interval */
+void stats_median_ci(double *vals, size_t cnt, double *median, double *lo,
+		     double *hi);
+
+size_t stats_bucket(uint64_t val);
+uint64_t stats_bucket_min(size_t bucket);
+uint64_t stats_bucket_max(size_t bucket);
+
+#endif
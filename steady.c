@@ -0,0 +1,220 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "steady.h"
+#include "timing.h"
+
+/* Polling period of the window boundary */
+#define STEADY_POLL_US 10000
+
+static void steady_phase_init(steady_phase_t *ph)
+{
+	memset(ph, 0, sizeof(*ph));
+	stats_init(&ph->lat);
+}
+
+static void steady_phase_add(steady_phase_t *ph, uint64_t ns, uint64_t frames,
+			     uint64_t bytes, const stats_t *lat)
+{
+	ph->ns += ns;
+	ph->frames += frames;
+	ph->bytes += bytes;
+	stats_merge(&ph->lat, lat);
+}
+
+double steady_variation(const steady_t *sd, int p99)
+{
+	double sum = 0;
+	double sum_sq = 0;
+	double mean;
+	double var;
+	size_t i;
+
+	if (sd->windows < STEADY_WINDOWS)
+		return HUGE_VAL;
+
+	for (i = 0; i < STEADY_WINDOWS; i++) {
+		double val = p99 ? (double)sd->hist[i].p99 : sd->hist[i].fps;
+
+		sum += val;
+		sum_sq += val * val;
+	}
+	mean = sum / STEADY_WINDOWS;
+	if (mean <= 0)
+		return HUGE_VAL;
+	var = sum_sq / STEADY_WINDOWS - mean * mean;
+	if (var < 0)
+		var = 0;
+
+	return sqrt(var) * 100 / mean;
+}
+
+int steady_add_window(steady_t *sd, uint64_t ns, uint64_t frames,
+		      uint64_t bytes, const stats_t *lat)
+{
+	steady_window_t *win = &sd->hist[sd->windows++ % STEADY_WINDOWS];
+	int steady;
+
+	win->fps = ns ? (double)frames * SEC_IN_NS / ns : 0;
+	win->p99 = stats_percentile(lat, 99);
+	steady = steady_variation(sd, 0) <= sd->cv &&
+		 steady_variation(sd, 1) <= sd->cv;
+
+	if (!sd->steady_at) {
+		steady_phase_add(&sd->transient, ns, frames, bytes, lat);
+		if (steady)
+			sd->steady_at = sd->transient.ns;
+		return steady;
+	}
+
+	steady_phase_add(&sd->steady, ns, frames, bytes, lat);
+	if (!steady) {
+		/* Not settled after all */
+		sd->transient.ns += sd->steady.ns;
+		sd->transient.frames += sd->steady.frames;
+		sd->transient.bytes += sd->steady.bytes;
+		stats_merge(&sd->transient.lat, &sd->steady.lat);
+		steady_phase_init(&sd->steady);
+		sd->steady_at = 0;
+		return 0;
+	}
+	if (sd->steady.ns >= sd->measure_ns)
+		sd->done = 1;
+
+	return 1;
+}
+
+/* Accounts frames completed since the previous window */
+static void steady_collect(steady_t *sd, uint64_t ns)
+{
+	steady_slot_t cur;
+	stats_t lat;
+	size_t i;
+	size_t j;
+
+	memset(&cur, 0, sizeof(cur));
+	for (i = 0; i < sd->cnt; i++) {
+		const steady_slot_t *slot = &sd->slots[i];
+
+		cur.frames += slot->frames;
+		cur.bytes += slot->bytes;
+		cur.lat_sum += slot->lat_sum;
+		for (j = 0; j < STATS_BUCKETS; j++)
+			cur.buckets[j] += slot->buckets[j];
+	}
+
+	stats_init(&lat);
+	for (j = 0; j < STATS_BUCKETS; j++) {
+		uint64_t cnt = cur.buckets[j] - sd->prev.buckets[j];
+
+		uint64_t mid;
+
+		if (!cnt)
+			continue;
+		if (!lat.cnt)
+			lat.min = stats_bucket_min(j);
+		lat.max = stats_bucket_max(j);
+		lat.buckets[j] = cnt;
+		lat.cnt += cnt;
+		/* Only buckets are published, estimate the spread from them */
+		mid = stats_bucket_min(j) / 2 + stats_bucket_max(j) / 2;
+		lat.sum_sq += (double)cnt * mid * mid;
+	}
+	lat.sum = cur.lat_sum - sd->prev.lat_sum;
+
+	(void)steady_add_window(sd, ns, cur.frames - sd->prev.frames,
+				cur.bytes - sd->prev.bytes, &lat);
+	sd->prev = cur;
+	sd->start += ns;
+}
+
+static void *steady_thread(void *arg)
+{
+	steady_t *sd = arg;
+
+	while (!sd->stop && !sd->done) {
+		sd->platform->usleep(STEADY_POLL_US);
+		if (timing_time() - sd->start >= sd->window_ns)
+			steady_collect(sd, sd->window_ns);
+	}
+
+	return NULL;
+}
+
+int steady_init(steady_t *sd, const platform_t *platform, size_t threads,
+		uint64_t measure_ns, double cv)
+{
+	memset(sd, 0, sizeof(*sd));
+	sd->slots = calloc(threads, sizeof(*sd->slots));
+	if (!sd->slots)
+		return 1;
+
+	sd->platform = platform;
+	sd->cnt = threads;
+	sd->window_ns = STEADY_WINDOW_NS;
+	sd->measure_ns = measure_ns;
+	sd->cv = cv;
+	steady_phase_init(&sd->transient);
+	steady_phase_init(&sd->steady);
+
+	return 0;
+}
+
+int steady_start(steady_t *sd, uint64_t start)
+{
+	sd->stop = 0;
+	sd->start = start;
+	if (sd->platform->thread_create(&sd->thread, steady_thread, sd))
+		return 1;
+	sd->running = 1;
+
+	return 0;
+}
+
+void steady_stop(steady_t *sd)
+{
+	void *ret;
+
+	if (!sd->running)
+		return;
+	sd->stop = 1;
+	sd->platform->thread_join(sd->thread, &ret);
+	sd->running = 0;
+
+	/* Frames after the last window, unless they're past the end */
+	if (!sd->done) {
+		uint64_t ns = timing_time() - sd->start;
+
+		if (ns)
+			steady_collect(sd, ns);
+	}
+}
+
+void steady_free(steady_t *sd)
+{
+	free(sd->slots);
+	sd->slots = NULL;
+	sd->cnt = 0;
+	sd->platform = NULL;
+}
@@ -0,0 +1,115 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_STEADY_H
+#define FRAMETEST_STEADY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "frametest.h"
+#include "platform.h"
+#include "stats.h"
+
+/* Length of one measurement window */
+#define STEADY_WINDOW_NS SEC_IN_NS
+/* Windows the variation is computed over */
+#define STEADY_WINDOWS 10
+/* Run length limit when no --duration is given */
+#define STEADY_MAX_NS (600 * SEC_IN_NS)
+
+/* Completed frames of one worker, published by the worker itself */
+typedef struct steady_slot_t {
+	volatile uint64_t frames;
+	volatile uint64_t bytes;
+	volatile uint64_t lat_sum;
+	volatile uint64_t buckets[STATS_BUCKETS];
+} steady_slot_t;
+
+typedef struct steady_window_t {
+	double fps;
+	uint64_t p99;
+} steady_window_t;
+
+/* Totals of the transient or the steady state part of a run */
+typedef struct steady_phase_t {
+	uint64_t ns;
+	uint64_t frames;
+	uint64_t bytes;
+	stats_t lat;
+} steady_phase_t;
+
+/*
+ * Thread watching throughput and 99th percentile latency of consecutive
+ * windows. Steady state is reached when the coefficient of variation of
+ * both over the last STEADY_WINDOWS windows is below the limit. Once
+ * measure_ns of steady state is collected done is set, which ends the
+ * run. If the variation grows again, the steady state collected so far
+ * becomes part of the transient one.
+ */
+typedef struct steady_t {
+	const platform_t *platform;
+	uint64_t thread;
+	volatile int stop;
+	int running;
+	/* Set when enough steady state is measured, workers stop on it */
+	volatile int done;
+
+	uint64_t window_ns;
+	uint64_t measure_ns;
+	/* Variation limit in percent */
+	double cv;
+
+	size_t cnt;
+	steady_slot_t *slots;
+	/* Sums of the slots at the end of the previous window */
+	steady_slot_t prev;
+	uint64_t start;
+
+	size_t windows;
+	steady_window_t hist[STEADY_WINDOWS];
+	/* Run time when steady state began, zero until then */
+	uint64_t steady_at;
+	steady_phase_t transient;
+	steady_phase_t steady;
+} steady_t;
+
+int steady_init(steady_t *sd, const platform_t *platform, size_t threads,
+		uint64_t measure_ns, double cv);
+/* Starts monitoring a run which began at the time start */
+int steady_start(steady_t *sd, uint64_t start);
+void steady_stop(steady_t *sd);
+void steady_free(steady_t *sd);
+
+/* Accounts a window of frames, returns non-zero when in steady state */
+int steady_add_window(steady_t *sd, uint64_t ns, uint64_t frames,
+		      uint64_t bytes, const stats_t *lat);
+/* Coefficient of variation in percent of the last STEADY_WINDOWS */
+double steady_variation(const steady_t *sd, int p99);
+
+static inline void steady_frame_done(steady_slot_t *slot, uint64_t lat,
+				     uint64_t bytes)
+{
+	++slot->buckets[stats_bucket(lat)];
+	slot->lat_sum += lat;
+	slot->bytes += bytes;
+	++slot->frames;
+}
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sweep.h"
+
+static int sweep_parse_num(const char *str, char **endp, int size,
+			   size_t *val)
+{
+	unsigned long long num;
+
+	if (*str < '0' || *str > '9')
+		return 1;
+	num = strtoull(str, endp, 10);
+	if (size && (**endp == 'k' || **endp == 'K')) {
+		num *= 1024;
+		++*endp;
+	} else if (size && (**endp == 'm' || **endp == 'M')) {
+		num *= 1024 * 1024;
+		++*endp;
+	}
+	if (!num)
+		return 1;
+	*val = num;
+
+	return 0;
+}
+
+static int sweep_parse_range(sweep_range_t *range, const char *str, int size)
+{
+	char *endp = NULL;
+	size_t lo;
+	size_t hi;
+	size_t step = 0;
+	size_t val;
+
+	if (sweep_parse_num(str, &endp, size, &lo))
+		return 1;
+	if (!*endp) {
+		range->vals[0] = lo;
+		range->cnt = 1;
+		return 0;
+	}
+	if (strncmp(endp, "..", 2) ||
+	    sweep_parse_num(endp + 2, &endp, size, &hi) || hi < lo)
+		return 1;
+	if (*endp == '+' && sweep_parse_num(endp + 1, &endp, size, &step))
+		return 1;
+	if (*endp)
+		return 1;
+
+	range->cnt = 0;
+	for (val = lo; val <= hi; val = step ? val + step : val * 2) {
+		if (range->cnt == SWEEP_MAX_VALUES)
+			return 1;
+		range->vals[range->cnt++] = val;
+	}
+
+	return 0;
+}
+
+int sweep_parse(sweep_t *sw, const char *str)
+{
+	char buf[256];
+	char *tok;
+	char *save = NULL;
+
+	if (!sw || !str)
+		return 1;
+	if (snprintf(buf, sizeof(buf), "%s", str) >= (int)sizeof(buf))
+		return 1;
+
+	memset(sw, 0, sizeof(*sw));
+	for (tok = strtok_r(buf, ",", &save); tok;
+	     tok = strtok_r(NULL, ",", &save)) {
+		char *val = strchr(tok, '=');
+
+		if (!val)
+			return 1;
+		*val++ = 0;
+
+		if (!strcmp(tok, "threads")) {
+			if (sweep_parse_range(&sw->threads, val, 0))
+				return 1;
+		} else if (!strcmp(tok, "size")) {
+			if (sweep_parse_range(&sw->size, val, 1))
+				return 1;
+		} else {
+			return 1;
+		}
+	}
+
+	return sw->threads.cnt || sw->size.cnt ? 0 : 1;
+}
+
+long sweep_best(const sweep_result_t *res, size_t cnt, const char *tcase,
+		uint64_t p99_limit)
+{
+	long best = -1;
+	size_t i;
+
+	for (i = 0; i < cnt; i++) {
+		/* Failed runs have no throughput */
+		if (strcmp(res[i].tcase, tcase) || res[i].mibps <= 0)
+			continue;
+		if (p99_limit && res[i].p99 > p99_limit)
+			continue;
+		if (best < 0 || res[i].mibps > res[best].mibps)
+			best = i;
+	}
+
+	return best;
+}
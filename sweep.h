@@ -0,0 +1,69 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_SWEEP_H
+#define FRAMETEST_SWEEP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SWEEP_MAX_VALUES 32
+
+typedef struct sweep_range_t {
+	size_t cnt;
+	size_t vals[SWEEP_MAX_VALUES];
+} sweep_range_t;
+
+/* Values to try, an empty range keeps the value of the options */
+typedef struct sweep_t {
+	sweep_range_t threads;
+	sweep_range_t size;
+} sweep_t;
+
+/* Result of one test case in one configuration */
+typedef struct sweep_result_t {
+	const char *tcase;
+	size_t threads;
+	size_t size;
+	double fps;
+	double mibps;
+	uint64_t p50;
+	uint64_t p99;
+	uint64_t p999;
+	/* Late frames in percent */
+	double late;
+} sweep_result_t;
+
+/*
+ * Comma separated key=range list, keys threads and size. Range is a
+ * single value, lo..hi doubling from lo, or lo..hi+step. Sizes are in
+ * bytes with optional k or m suffix for KiB and MiB.
+ */
+int sweep_parse(sweep_t *sw, const char *str);
+
+/*
+ * Index of the result of tcase with the best throughput and 99th
+ * percentile latency within p99_limit, or no limit if it's zero.
+ * Returns -1 if none qualifies.
+ */
+long sweep_best(const sweep_result_t *res, size_t cnt, const char *tcase,
+		uint64_t p99_limit);
+
+#endif
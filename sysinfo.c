@@ -0,0 +1,153 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifdef __linux__
+/* For major() and minor() */
+#define _GNU_SOURCE
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/sysmacros.h>
+#endif
+#if !defined(_WIN32)
+#include <sys/utsname.h>
+#endif
+
+#include "sysinfo.h"
+
+static inline void sysinfo_copy(char *dst, const char *src)
+{
+	snprintf(dst, SYSINFO_STR_MAX, "%s", src);
+}
+
+static void sysinfo_host(sysinfo_t *info)
+{
+#if defined(_WIN32)
+	const char *name = getenv("COMPUTERNAME");
+
+	sysinfo_copy(info->hostname, name ? name : "unknown");
+	sysinfo_copy(info->kernel, "Windows");
+#else
+	struct utsname uts;
+
+	if (gethostname(info->hostname, SYSINFO_STR_MAX - 1))
+		sysinfo_copy(info->hostname, "unknown");
+	info->hostname[SYSINFO_STR_MAX - 1] = 0;
+
+	if (uname(&uts))
+		sysinfo_copy(info->kernel, "unknown");
+	else
+		snprintf(info->kernel, SYSINFO_STR_MAX, "%s %s %s",
+			 uts.sysname, uts.release, uts.machine);
+#endif
+}
+
+static int sysinfo_stat(const char *path, struct stat *sb)
+{
+	char dir[SYSINFO_STR_MAX];
+	char *sep;
+
+	if (!stat(path, sb))
+		return 0;
+
+	/* Streaming target might not exist yet, try the parent folder */
+	sysinfo_copy(dir, path);
+	sep = strrchr(dir, '/');
+	if (!sep)
+		return stat(".", sb);
+	if (sep == dir)
+		sep[1] = 0;
+	else
+		*sep = 0;
+
+	return stat(dir, sb);
+}
+
+#if defined(__linux__)
+static void sysinfo_mount(sysinfo_t *info)
+{
+	char line[4096];
+	FILE *f;
+
+	f = fopen("/proc/self/mountinfo", "r");
+	if (!f)
+		return;
+
+	/*
+	 * Format: id parent major:minor root mount-point options
+	 *         [optional fields...] - fs-type source super-options
+	 */
+	while (fgets(line, sizeof(line), f)) {
+		char mnt[SYSINFO_STR_MAX];
+		char fstype[SYSINFO_STR_MAX];
+		char source[SYSINFO_STR_MAX];
+		unsigned int maj;
+		unsigned int min;
+		char *sep;
+
+		if (sscanf(line, "%*d %*d %u:%u %*s %255s", &maj, &min, mnt) !=
+		    3)
+			continue;
+		if (maj != info->dev_major || min != info->dev_minor)
+			continue;
+		sep = strstr(line, " - ");
+		if (!sep)
+			continue;
+		if (sscanf(sep + 3, "%255s %255s", fstype, source) != 2)
+			continue;
+
+		/* Keep the last match, later mounts shadow earlier ones */
+		sysinfo_copy(info->mount_point, mnt);
+		sysinfo_copy(info->fs_type, fstype);
+		sysinfo_copy(info->device, source);
+	}
+	fclose(f);
+}
+#endif
+
+int sysinfo_get(const char *path, sysinfo_t *info)
+{
+	struct stat sb;
+
+	if (!info)
+		return 1;
+
+	memset(info, 0, sizeof(*info));
+	sysinfo_copy(info->fs_type, "unknown");
+	sysinfo_copy(info->mount_point, "unknown");
+	sysinfo_copy(info->device, "unknown");
+	sysinfo_host(info);
+
+	if (!path || sysinfo_stat(path, &sb))
+		return 1;
+
+#if defined(__linux__)
+	info->dev_major = major(sb.st_dev);
+	info->dev_minor = minor(sb.st_dev);
+	sysinfo_mount(info);
+#endif
+
+	return 0;
+}
@@ -0,0 +1,39 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_SYSINFO_H
+#define FRAMETEST_SYSINFO_H
+
+#define SYSINFO_STR_MAX 256
+
+/* Information about the host and the file system under test */
+typedef struct sysinfo_t {
+	char hostname[SYSINFO_STR_MAX];
+	char kernel[SYSINFO_STR_MAX];
+	char fs_type[SYSINFO_STR_MAX];
+	char mount_point[SYSINFO_STR_MAX];
+	char device[SYSINFO_STR_MAX];
+	unsigned int dev_major;
+	unsigned int dev_minor;
+} sysinfo_t;
+
+int sysinfo_get(const char *path, sysinfo_t *info);
+
+#endif
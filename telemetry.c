@@ -0,0 +1,230 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frametest.h"
+#include "sysinfo.h"
+#include "telemetry.h"
+#include "timing.h"
+
+/* Longest single sleep, so stopping the sampler is quick */
+#define TELEMETRY_SLEEP_US 10000
+
+int telemetry_read_diskstats(FILE *f, unsigned int major, unsigned int minor,
+			     telemetry_sample_t *sample)
+{
+	char line[512];
+
+	while (fgets(line, sizeof(line), f)) {
+		unsigned int maj;
+		unsigned int min;
+		char name[64];
+		uint64_t v[11];
+
+		if (sscanf(line,
+			   "%u %u %63s %" SCNu64 " %" SCNu64 " %" SCNu64
+			   " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64
+			   " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64,
+			   &maj, &min, name, &v[0], &v[1], &v[2], &v[3], &v[4],
+			   &v[5], &v[6], &v[7], &v[8], &v[9], &v[10]) != 14)
+			continue;
+		if (maj != major || min != minor)
+			continue;
+
+		sample->rd_ios = v[0];
+		sample->rd_sectors = v[2];
+		sample->wr_ios = v[4];
+		sample->wr_sectors = v[6];
+		sample->in_flight = v[8];
+		sample->io_ticks_ms = v[9];
+		sample->queue_ms = v[10];
+		return 0;
+	}
+
+	return 1;
+}
+
+int telemetry_read_meminfo(FILE *f, telemetry_sample_t *sample)
+{
+	char line[256];
+	int found = 0;
+
+	while (fgets(line, sizeof(line), f)) {
+		uint64_t val;
+
+		if (sscanf(line, "Dirty: %" SCNu64, &val) == 1) {
+			sample->dirty_kb = val;
+			found |= 1;
+		} else if (sscanf(line, "Writeback: %" SCNu64, &val) == 1) {
+			sample->writeback_kb = val;
+			found |= 2;
+		}
+	}
+
+	return found == 3 ? 0 : 1;
+}
+
+int telemetry_read_psi(FILE *f, telemetry_sample_t *sample)
+{
+	char line[256];
+	int found = 0;
+
+	while (fgets(line, sizeof(line), f)) {
+		const char *total = strstr(line, "total=");
+		uint64_t val;
+
+		if (!total || sscanf(total, "total=%" SCNu64, &val) != 1)
+			continue;
+		if (!strncmp(line, "some ", 5)) {
+			sample->psi_some_us = val;
+			found |= 1;
+		} else if (!strncmp(line, "full ", 5)) {
+			sample->psi_full_us = val;
+			found |= 2;
+		}
+	}
+
+	/* Older kernels have only "some" */
+	return found & 1 ? 0 : 1;
+}
+
+/* Returns mask of the sources which could be read */
+int telemetry_sample(telemetry_t *tm, telemetry_sample_t *sample)
+{
+	FILE *f;
+	int res = 0;
+
+	memset(sample, 0, sizeof(*sample));
+	sample->time = timing_time();
+
+	f = fopen("/proc/diskstats", "r");
+	if (f) {
+		if (!telemetry_read_diskstats(f, tm->dev_major, tm->dev_minor,
+					      sample))
+			res |= TELEMETRY_DISK;
+		fclose(f);
+	}
+	f = fopen("/proc/meminfo", "r");
+	if (f) {
+		if (!telemetry_read_meminfo(f, sample))
+			res |= TELEMETRY_MEM;
+		fclose(f);
+	}
+	f = fopen("/proc/pressure/io", "r");
+	if (f) {
+		if (!telemetry_read_psi(f, sample))
+			res |= TELEMETRY_PSI;
+		fclose(f);
+	}
+
+	return res;
+}
+
+static int telemetry_add(telemetry_t *tm)
+{
+	if (tm->cnt == tm->size) {
+		size_t size = tm->size ? tm->size * 2 : 256;
+		telemetry_sample_t *tmp;
+
+		tmp = realloc(tm->samples, size * sizeof(*tmp));
+		if (!tmp)
+			return 1;
+		tm->samples = tmp;
+		tm->size = size;
+	}
+	tm->sources &= telemetry_sample(tm, &tm->samples[tm->cnt++]);
+
+	return 0;
+}
+
+static void *telemetry_thread(void *arg)
+{
+	telemetry_t *tm = arg;
+	uint64_t next = timing_time();
+
+	while (!tm->stop) {
+		uint64_t now = timing_time();
+
+		if (now < next) {
+			uint64_t us = (next - now) / 1000;
+
+			if (us > TELEMETRY_SLEEP_US)
+				us = TELEMETRY_SLEEP_US;
+			tm->platform->usleep(us ? us : 1);
+			continue;
+		}
+		if (telemetry_add(tm))
+			break;
+		next += tm->interval_ns;
+	}
+
+	return NULL;
+}
+
+int telemetry_start(telemetry_t *tm, const platform_t *platform,
+		    const char *path, uint64_t interval_ns)
+{
+	sysinfo_t info;
+
+	memset(tm, 0, sizeof(*tm));
+	if (!interval_ns)
+		return 1;
+
+	tm->platform = platform;
+	tm->interval_ns = interval_ns;
+	tm->sources = TELEMETRY_DISK | TELEMETRY_MEM | TELEMETRY_PSI;
+	if (!sysinfo_get(path, &info)) {
+		tm->dev_major = info.dev_major;
+		tm->dev_minor = info.dev_minor;
+	}
+
+	if (platform->thread_create(&tm->thread, telemetry_thread, tm)) {
+		tm->platform = NULL;
+		return 1;
+	}
+
+	return 0;
+}
+
+void telemetry_stop(telemetry_t *tm)
+{
+	void *ret;
+
+	if (!tm->platform)
+		return;
+
+	tm->stop = 1;
+	tm->platform->thread_join(tm->thread, &ret);
+	/* Final sample closes the last interval */
+	(void)telemetry_add(tm);
+	tm->platform = NULL;
+}
+
+void telemetry_free(telemetry_t *tm)
+{
+	free(tm->samples);
+	tm->samples = NULL;
+	tm->cnt = 0;
+	tm->size = 0;
+}
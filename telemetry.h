@@ -0,0 +1,86 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_TELEMETRY_H
+#define FRAMETEST_TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "platform.h"
+
+enum TelemetrySource {
+	TELEMETRY_DISK = 1 << 0,
+	TELEMETRY_MEM = 1 << 1,
+	TELEMETRY_PSI = 1 << 2,
+};
+
+/* System counters at one point in time, cumulative unless noted */
+typedef struct telemetry_sample_t {
+	/* timing_time() of the sample */
+	uint64_t time;
+
+	/* /proc/diskstats of the device under test */
+	uint64_t rd_ios;
+	uint64_t rd_sectors;
+	uint64_t wr_ios;
+	uint64_t wr_sectors;
+	uint64_t in_flight; /* Current value */
+	uint64_t io_ticks_ms;
+	uint64_t queue_ms;
+
+	/* /proc/meminfo, current values */
+	uint64_t dirty_kb;
+	uint64_t writeback_kb;
+
+	/* /proc/pressure/io */
+	uint64_t psi_some_us;
+	uint64_t psi_full_us;
+} telemetry_sample_t;
+
+typedef struct telemetry_t {
+	const platform_t *platform;
+	uint64_t thread;
+	volatile int stop;
+
+	unsigned int dev_major;
+	unsigned int dev_minor;
+	/* Mask of TelemetrySource which could be read */
+	unsigned int sources;
+	uint64_t interval_ns;
+
+	size_t cnt;
+	size_t size;
+	telemetry_sample_t *samples;
+} telemetry_t;
+
+int telemetry_start(telemetry_t *tm, const platform_t *platform,
+		    const char *path, uint64_t interval_ns);
+void telemetry_stop(telemetry_t *tm);
+void telemetry_free(telemetry_t *tm);
+
+int telemetry_sample(telemetry_t *tm, telemetry_sample_t *sample);
+
+int telemetry_read_diskstats(FILE *f, unsigned int major, unsigned int minor,
+			     telemetry_sample_t *sample);
+int telemetry_read_meminfo(FILE *f, telemetry_sample_t *sample);
+int telemetry_read_psi(FILE *f, telemetry_sample_t *sample);
+
+#endif
@@ -26,10 +26,15 @@
 #endif
 #endif
 #include <limits.h>
+#include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "tester.h"
 #include "timing.h"
+#include "cpu.h"
+#include "perf.h"
+#include "watchdog.h"
 
 static inline size_t tester_frame_write(const platform_t *platform,
 					const char *path, frame_t *frame,
@@ -141,6 +146,14 @@ frame_t *tester_get_frame_read(const platform_t *platform, const char *path,
 	return frame_from_file(platform, name, frame_size);
 }
 
+/* Polling period while waiting for the next frame to be due */
+#define TESTER_OPEN_LOOP_US 100
+/* Spun out rather than slept before a frame is due, sleeps overshoot */
+#define TESTER_SPIN_NS (2 * TESTER_OPEN_LOOP_US * 1000)
+#define TESTER_RNG_MUL 0x9e3779b97f4a7c15ULL
+/* Polling period while idle between bursts */
+#define TESTER_IDLE_US 1000
+
 static inline void shuffle_array(size_t *arr, size_t size)
 {
 	size_t i;
@@ -158,87 +171,247 @@ static inline void shuffle_array(size_t *arr, size_t size)
 	}
 }
 
-test_result_t tester_run_write(const platform_t *platform, const char *path,
-			       frame_t *frame, size_t start_frame,
-			       size_t frames, size_t fps, test_mode_t mode,
-			       test_files_t files)
+static inline void tester_trace(test_ctx_t *ctx, enum TraceOp op,
+				const frame_t *frame, size_t num,
+				test_files_t files,
+				const test_completion_t *comp, int failed)
 {
-	test_result_t res = { 0 };
-	size_t i;
-	size_t budget;
-	size_t end_frame;
-	size_t *seq = NULL;
+	trace_record_t rec;
 
-	res.completion = platform->calloc(frames, sizeof(*res.completion));
-	if (!res.completion)
-		return res;
+	if (!ctx || !ctx->trace)
+		return;
 
-	budget = fps ? (SEC_IN_NS / fps) : 0;
-	end_frame = start_frame + frames;
+	rec.thread = ctx->thread_id;
+	rec.op = op;
+	rec.result = failed;
+	rec.frame = num;
+	rec.offset = files == TEST_FILES_SINGLE ? num * frame->size : 0;
+	rec.start = comp->start;
+	rec.open = comp->open;
+	rec.io = comp->io;
+	rec.close = comp->close;
+	rec.end = comp->frame;
+	trace_writer_add(ctx->trace, &rec);
+}
 
-	if (mode == TEST_MODE_RANDOM) {
-		seq = platform->malloc(sizeof(*seq) * frames);
-		if (!seq)
-			return res;
+static inline void tester_stats_add(stats_t *stats,
+				    const test_completion_t *comp)
+{
+	int i;
 
-		for (i = 0; i < frames; i++)
-			seq[i] = start_frame + i;
-		shuffle_array(seq, frames);
+	for (i = 0; i < COMP_STAT_CNT; i++)
+		stats_add(&stats[i], completion_value(comp, i));
+}
+
+static inline double tester_uniform(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+
+	return (*state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Time frame n is due in an open loop run, prev is when n - 1 was */
+static inline uint64_t tester_due(const test_ctx_t *ctx, uint64_t prev,
+				  uint64_t n, uint64_t start, uint64_t budget,
+				  uint64_t *rng)
+{
+	uint64_t burst = ctx->burst ? ctx->burst : 1;
+
+	switch (ctx->sched) {
+	case SCHED_POISSON:
+		if (!n)
+			return start;
+		return prev - log(1 - tester_uniform(rng)) * budget;
+	case SCHED_BURST:
+		return start + n / burst * burst * budget;
+	case SCHED_FIXED:
+	default:
+		return start + n * budget;
 	}
+}
 
-	for (i = start_frame; i < end_frame; i++) {
-		uint64_t frame_start = timing_start();
-		size_t frame_idx;
+/* Waits until due, sleeping first and spinning the last stretch */
+static inline void tester_wait(const platform_t *platform, uint64_t due)
+{
+	uint64_t now = timing_start();
 
-		res.completion[i - start_frame].start = frame_start;
-		switch (mode) {
-		case TEST_MODE_REVERSE:
-			frame_idx = end_frame - i + start_frame - 1;
-			break;
-		case TEST_MODE_RANDOM:
-			frame_idx = seq[i - start_frame];
-			break;
-		case TEST_MODE_NORM:
-		default:
-			frame_idx = i;
-			break;
-		}
-		if (!tester_frame_write(platform, path, frame, frame_idx, files,
-					&res.completion[i - start_frame]))
-			break;
-		res.completion[i - start_frame].frame = timing_start();
-		++res.frames_written;
-		res.bytes_written += frame->size;
-		/* If fps limit is enabled loop until frame budget is gone */
-		if (fps && budget) {
-			uint64_t frame_elapsed = timing_elapsed(frame_start);
+	while (now + TESTER_SPIN_NS < due) {
+		platform->usleep(TESTER_OPEN_LOOP_US);
+		now = timing_start();
+	}
+	while (now < due)
+		now = timing_start();
+}
 
-			while (frame_elapsed < budget) {
-				platform->usleep(100);
-				frame_elapsed = timing_elapsed(frame_start);
-			}
+int tester_pattern_parse(test_pattern_t *pat, const char *str)
+{
+	const char *p = str;
+
+	if (!pat || !str || !*str)
+		return 1;
+
+	memset(pat, 0, sizeof(*pat));
+	pat->stride = 1;
+	pat->speed = 1;
+	while (*p) {
+		const char *val = strchr(p, '=');
+		char *endp = NULL;
+		size_t len;
+
+		if (!val)
+			return 1;
+		len = val++ - p;
+		if (len == 6 && !strncmp(p, "stride", len)) {
+			pat->stride = strtol(val, &endp, 10);
+			if (!pat->stride)
+				return 1;
+		} else if (len == 5 && !strncmp(p, "speed", len)) {
+			pat->speed = strtod(val, &endp);
+			if (!(pat->speed > 0))
+				return 1;
+		} else if (len == 4 && !strncmp(p, "seek", len)) {
+			long segment = strtol(val, &endp, 10);
+
+			if (segment <= 0)
+				return 1;
+			pat->segment = segment;
+		} else {
+			return 1;
 		}
+		if (endp == val || (*endp && *endp != ','))
+			return 1;
+		p = *endp ? endp + 1 : endp;
 	}
-	if (seq)
-		platform->free(seq);
-	return res;
+
+	return 0;
 }
 
-test_result_t tester_run_read(const platform_t *platform, const char *path,
-			      frame_t *frame, size_t start_frame, size_t frames,
-			      size_t fps, test_mode_t mode, test_files_t files)
+static inline uint64_t tester_gcd(uint64_t a, uint64_t b)
+{
+	while (b) {
+		uint64_t t = a % b;
+
+		a = b;
+		b = t;
+	}
+
+	return a;
+}
+
+/*
+ * Offset within the frames of access n of a trick play pattern. Playing
+ * goes on from pos, which jumps to a random frame at the start of every
+ * segment. Sets seek on the first access after a jump, or of the run.
+ */
+static inline size_t tester_pattern_frame(const test_pattern_t *pat,
+					  uint64_t n, size_t frames,
+					  size_t *pos, uint64_t *rng, int *seek)
+{
+	uint64_t step = pat->stride < 0 ? -pat->stride : pat->stride;
+	uint64_t j = n;
+	uint64_t lap;
+	uint64_t off;
+
+	if (pat->segment) {
+		j = n % pat->segment;
+		if (!j)
+			*pos = (size_t)(tester_uniform(rng) * frames);
+	}
+	*seek = !j;
+
+	/*
+	 * Once the stride comes back around, the next lap starts a frame
+	 * later, so that every frame is played once per loop
+	 */
+	lap = frames / tester_gcd(frames, step);
+	off = (j * step + j / lap % (frames / lap)) % frames;
+	if (pat->stride < 0)
+		return (*pos + frames - off) % frames;
+
+	return (*pos + off) % frames;
+}
+
+typedef size_t (*tester_frame_io_t)(const platform_t *platform,
+				    const char *path, frame_t *frame,
+				    size_t num, test_files_t files,
+				    test_completion_t *comp);
+
+static test_result_t tester_run(const platform_t *platform, const char *path,
+				frame_t *frame, size_t start_frame,
+				size_t frames, size_t fps, test_mode_t mode,
+				test_files_t files, test_ctx_t *ctx,
+				enum TraceOp op, tester_frame_io_t frame_io)
 {
 	test_result_t res = { 0 };
+	test_completion_t cur;
+	uint64_t duration = ctx ? ctx->duration_ns : 0;
+	uint64_t n;
 	size_t i;
 	size_t budget;
 	size_t end_frame;
 	size_t *seq = NULL;
+	uint64_t run_start;
+	uint64_t cpu_start = 0;
+	int cpu = ctx && ctx->cpu;
+	int open_loop;
+	uint64_t due = 0;
+	uint64_t deadline;
+	uint64_t rng;
+	uint64_t cycle = ctx ? ctx->on_ns + ctx->off_ns : 0;
+	uint64_t burst_start;
+	uint64_t burst_n = 0;
+	int first = 0;
+	const test_pattern_t *pat = NULL;
+	size_t pat_pos = 0;
+	int seek = 0;
+	perf_t perf;
+	int perf_on = 0;
+
+	if (!frames)
+		duration = 0;
+	if (duration) {
+		/* Only statistics, completions would grow without a limit */
+		res.stats = platform->calloc(COMP_STAT_CNT, sizeof(*res.stats));
+		if (!res.stats)
+			return res;
+		for (i = 0; i < COMP_STAT_CNT; i++)
+			stats_init(&res.stats[i]);
+		if (ctx->on_ns) {
+			res.burst = platform->calloc(BURST_STAT_CNT,
+						     sizeof(*res.burst));
+			if (!res.burst)
+				return res;
+			for (i = 0; i < BURST_STAT_CNT; i++)
+				stats_init(&res.burst[i]);
+		}
+	} else {
+		res.completion =
+			platform->calloc(frames, sizeof(*res.completion));
+		if (!res.completion)
+			return res;
+	}
 
-	res.completion = platform->calloc(frames, sizeof(*res.completion));
-	if (!res.completion)
-		return res;
+	if (mode == TEST_MODE_PATTERN && ctx && ctx->pattern &&
+	    ctx->pattern->stride) {
+		pat = ctx->pattern;
+		res.seek = platform->calloc(SEEK_STAT_CNT, sizeof(*res.seek));
+		if (!res.seek)
+			return res;
+		for (i = 0; i < SEEK_STAT_CNT; i++)
+			stats_init(&res.seek[i]);
+		/* Backwards from the end, unless seeking */
+		if (pat->stride < 0)
+			pat_pos = frames - 1;
+	} else if (mode == TEST_MODE_PATTERN) {
+		mode = TEST_MODE_NORM;
+	}
 
 	budget = fps ? (SEC_IN_NS / fps) : 0;
+	if (pat)
+		budget /= pat->speed;
+	open_loop = budget && ctx && ctx->sched != SCHED_CLOSED;
 	end_frame = start_frame + frames;
 
 	if (mode == TEST_MODE_RANDOM) {
@@ -247,15 +420,66 @@ test_result_t tester_run_read(const platform_t *platform, const char *path,
 			return res;
 
 		for (i = 0; i < frames; i++)
-			seq[i] = i + start_frame;
+			seq[i] = start_frame + i;
 		shuffle_array(seq, frames);
 	}
 
-	for (i = start_frame; i < start_frame + frames; i++) {
-		uint64_t frame_start = timing_start();
+	if (ctx && ctx->perf)
+		perf_on = !perf_open(&perf);
+	if (ctx && ctx->watch)
+		ctx->watch->tid = watchdog_tid();
+	if (ctx && ctx->gate)
+		platform->gate_wait(ctx->gate);
+	/* Waiting on the gate isn't part of the run */
+	if (perf_on)
+		perf_start(&perf);
+	if (cpu)
+		cpu_start = cpu_thread_time();
+	run_start = timing_start();
+	res.started = run_start;
+	burst_start = run_start;
+	/* Every thread has its own Poisson arrivals and seeks */
+	rng = run_start ^ (ctx ? ctx->thread_id + 1 : 1) * TESTER_RNG_MUL;
+	for (n = 0; n < frames || duration; n++) {
+		uint64_t frame_cpu;
+		uint64_t frame_start;
+		test_completion_t *comp;
 		size_t frame_idx;
 
-		res.completion[i - start_frame].start = frame_start;
+		i = start_frame + n % frames;
+		if (duration) {
+			if (timing_elapsed(run_start) >= duration ||
+			    (ctx->stop && *ctx->stop))
+				break;
+			if (ctx->on_ns &&
+			    timing_elapsed(burst_start) >= ctx->on_ns) {
+				/* Idle until the next burst, if there's one */
+				burst_start += cycle;
+				if (burst_start - run_start >= duration)
+					break;
+				while (timing_start() < burst_start)
+					platform->usleep(TESTER_IDLE_US);
+				burst_n = 0;
+				first = 1;
+			}
+			if (seq && n && i == start_frame)
+				shuffle_array(seq, frames);
+			memset(&cur, 0, sizeof(cur));
+			comp = &cur;
+		} else {
+			comp = &res.completion[n];
+		}
+		/* Frames are due on the schedule, however late the run is */
+		if (open_loop) {
+			due = tester_due(ctx, due, burst_n, burst_start, budget,
+					 &rng);
+			tester_wait(platform, due);
+		}
+		frame_cpu = cpu ? cpu_thread_time() : 0;
+		frame_start = timing_start();
+		comp->start = frame_start;
+		comp->sched = due;
+		deadline = (open_loop ? due : frame_start) + budget;
 		switch (mode) {
 		case TEST_MODE_REVERSE:
 			frame_idx = end_frame - i + start_frame - 1;
@@ -263,19 +487,61 @@ test_result_t tester_run_read(const platform_t *platform, const char *path,
 		case TEST_MODE_RANDOM:
 			frame_idx = seq[i - start_frame];
 			break;
+		case TEST_MODE_PATTERN:
+			frame_idx = start_frame +
+				    tester_pattern_frame(pat, n, frames,
+							 &pat_pos, &rng, &seek);
+			break;
 		case TEST_MODE_NORM:
 		default:
 			frame_idx = i;
 			break;
 		}
-		if (!tester_frame_read(platform, path, frame, frame_idx, files,
-				       &res.completion[i - start_frame]))
-			return res;
-		res.completion[i - start_frame].frame = timing_start();
+		if (ctx)
+			frame_idx += n / frames * ctx->loop_step;
+		comp->num = frame_idx;
+		if (ctx && ctx->watch)
+			watchdog_frame_start(ctx->watch, frame_idx, comp,
+					     frame_start);
+		if (!frame_io(platform, path, frame, frame_idx, files, comp)) {
+			if (ctx && ctx->watch)
+				watchdog_frame_end(ctx->watch);
+			comp->frame = timing_start();
+			tester_trace(ctx, op, frame, frame_idx, files, comp, 1);
+			break;
+		}
+		comp->frame = timing_start();
+		if (ctx && ctx->watch)
+			watchdog_frame_end(ctx->watch);
+		if (cpu)
+			comp->cpu = cpu_thread_time() - frame_cpu;
+		tester_trace(ctx, op, frame, frame_idx, files, comp, 0);
+		if (duration)
+			tester_stats_add(res.stats, comp);
+		if (res.burst)
+			stats_add(&res.burst[first ? BURST_FIRST : BURST_REST],
+				  completion_value(comp, COMP_SCHED));
+		if (res.seek)
+			stats_add(&res.seek[seek ? SEEK_FIRST : SEEK_REST],
+				  completion_value(comp, COMP_SCHED));
+		first = 0;
+		burst_n++;
+		if (ctx && ctx->steady)
+			steady_frame_done(ctx->steady,
+					  comp->frame - comp->start,
+					  frame->size);
+		if (ctx && ctx->topk)
+			topk_add(ctx->topk, frame_idx,
+				 files == TEST_FILES_SINGLE ?
+					 frame_idx * frame->size :
+					 0,
+				 comp);
 		++res.frames_written;
 		res.bytes_written += frame->size;
+		if (budget && comp->frame > deadline)
+			++res.late;
 		/* If fps limit is enabled loop until frame budget is gone */
-		if (fps && budget) {
+		if (fps && budget && !open_loop) {
 			uint64_t frame_elapsed = timing_elapsed(frame_start);
 
 			while (frame_elapsed < budget) {
@@ -284,7 +550,67 @@ test_result_t tester_run_read(const platform_t *platform, const char *path,
 			}
 		}
 	}
+	res.finished = timing_start();
+	res.time_taken_ns = res.finished - run_start;
+	if (cpu)
+		res.cpu_ns = cpu_thread_time() - cpu_start;
+	if (perf_on) {
+		perf_read(&perf, &res.perf);
+		perf_close(&perf);
+	}
+	if (ctx && ctx->trace)
+		(void)trace_writer_flush(ctx->trace);
+	if (ctx && ctx->topk)
+		topk_flush(ctx->topk);
 	if (seq)
 		platform->free(seq);
 	return res;
 }
+
+void tester_result_trim(test_result_t *res, uint64_t from, uint64_t to)
+{
+	uint64_t frame_size;
+	uint64_t kept = 0;
+	uint64_t i;
+
+	if (!res->frames_written || !res->completion)
+		return;
+
+	frame_size = res->bytes_written / res->frames_written;
+	res->started = 0;
+	res->finished = 0;
+	for (i = 0; i < res->frames_written; i++) {
+		const test_completion_t *c = &res->completion[i];
+
+		if (c->start < from || c->frame > to)
+			continue;
+		if (!res->started || c->start < res->started)
+			res->started = c->start;
+		if (c->frame > res->finished)
+			res->finished = c->frame;
+		res->completion[kept++] = *c;
+	}
+
+	res->frames_written = kept;
+	res->bytes_written = kept * frame_size;
+	res->time_taken_ns = to > from ? to - from : 0;
+}
+
+test_result_t tester_run_write(const platform_t *platform, const char *path,
+			       frame_t *frame, size_t start_frame,
+			       size_t frames, size_t fps, test_mode_t mode,
+			       test_files_t files, test_ctx_t *ctx)
+{
+	return tester_run(platform, path, frame, start_frame, frames, fps,
+			  mode, files, ctx, TRACE_OP_WRITE,
+			  tester_frame_write);
+}
+
+test_result_t tester_run_read(const platform_t *platform, const char *path,
+			      frame_t *frame, size_t start_frame, size_t frames,
+			      size_t fps, test_mode_t mode, test_files_t files,
+			      test_ctx_t *ctx)
+{
+	return tester_run(platform, path, frame, start_frame, frames, fps,
+			  mode, files, ctx, TRACE_OP_READ, tester_frame_read);
+}
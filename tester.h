@@ -28,7 +28,11 @@
 #include "frametest.h"
 #include "frame.h"
 #include "platform.h"
+#include "steady.h"
 #include "timing.h"
+#include "trace.h"
+#include "topk.h"
+#include "watchdog.h"
 
 typedef struct testset_t {
 	const char *path;
@@ -45,6 +49,8 @@ typedef enum test_mode_t {
 	TEST_MODE_NORM = 0,
 	TEST_MODE_REVERSE,
 	TEST_MODE_RANDOM,
+	/* Trick play, following the pattern of the context */
+	TEST_MODE_PATTERN,
 } test_mode_t;
 
 typedef enum test_files_t {
@@ -52,15 +58,50 @@ typedef enum test_files_t {
 	TEST_FILES_SINGLE = 1,
 } test_files_t;
 
+/* Optional per thread settings and instrumentation, may be NULL */
+typedef struct test_ctx_t {
+	size_t thread_id;
+	trace_writer_t *trace;
+	/* Slowest frames of the thread */
+	topk_t *topk;
+	/* Progress published to the stall watchdog */
+	watchdog_slot_t *watch;
+	/* Start gate, the run begins once it's opened */
+	platform_gate_t *gate;
+	/* Loop over the frames for this long, 0 runs them once */
+	uint64_t duration_ns;
+	/* Bursts of frames separated by idle time, 0 is continuous */
+	uint64_t on_ns;
+	uint64_t off_ns;
+	/* Frame number step of every loop, 0 rewrites the same frames */
+	size_t loop_step;
+	/* Ends a duration run early once non-zero */
+	volatile int *stop;
+	/* Completed frames published to steady state detection */
+	steady_slot_t *steady;
+	/* Open loop issue schedule of frames, which doesn't slip */
+	enum Schedule sched;
+	size_t burst;
+	/* Access pattern of TEST_MODE_PATTERN */
+	const test_pattern_t *pattern;
+	unsigned int cpu : 1;
+	unsigned int perf : 1;
+} test_ctx_t;
+
 test_result_t tester_run_write(const platform_t *platform, const char *path,
 			       frame_t *frame, size_t start_frame,
 			       size_t frames, size_t fps, test_mode_t mode,
-			       test_files_t files);
+			       test_files_t files, test_ctx_t *ctx);
 test_result_t tester_run_read(const platform_t *platform, const char *path,
 			      frame_t *frame, size_t start_frame, size_t frames,
-			      size_t fps, test_mode_t mode, test_files_t files);
+			      size_t fps, test_mode_t mode, test_files_t files,
+			      test_ctx_t *ctx);
 frame_t *tester_get_frame_read(const platform_t *platform, const char *path,
 			       size_t header_size);
+/* Keeps only frames running entirely within [from, to] */
+void tester_result_trim(test_result_t *res, uint64_t from, uint64_t to);
+/* Comma separated stride, speed and seek values, eg. stride=-4,seek=48 */
+int tester_pattern_parse(test_pattern_t *pat, const char *str);
 
 static inline void result_free(const platform_t *platform, test_result_t *res)
 {
@@ -69,6 +110,15 @@ static inline void result_free(const platform_t *platform, test_result_t *res)
 	if (res->completion)
 		platform->free(res->completion);
 	res->completion = NULL;
+	if (res->stats)
+		platform->free(res->stats);
+	res->stats = NULL;
+	if (res->burst)
+		platform->free(res->burst);
+	res->burst = NULL;
+	if (res->seek)
+		platform->free(res->seek);
+	res->seek = NULL;
 }
 
 static inline int test_result_aggregate(test_result_t *dst,
@@ -76,6 +126,7 @@ static inline int test_result_aggregate(test_result_t *dst,
 {
 	test_completion_t *tmp;
 	size_t frm;
+	size_t i;
 
 	if (!dst || !src)
 		return 1;
@@ -90,9 +141,38 @@ static inline int test_result_aggregate(test_result_t *dst,
 		}
 	}
 
+	if (src->stats && !dst->stats) {
+		dst->stats = malloc(sizeof(*dst->stats) * COMP_STAT_CNT);
+		for (i = 0; dst->stats && i < COMP_STAT_CNT; i++)
+			stats_init(&dst->stats[i]);
+	}
+	for (i = 0; src->stats && dst->stats && i < COMP_STAT_CNT; i++)
+		stats_merge(&dst->stats[i], &src->stats[i]);
+	if (src->burst && !dst->burst) {
+		dst->burst = malloc(sizeof(*dst->burst) * BURST_STAT_CNT);
+		for (i = 0; dst->burst && i < BURST_STAT_CNT; i++)
+			stats_init(&dst->burst[i]);
+	}
+	for (i = 0; src->burst && dst->burst && i < BURST_STAT_CNT; i++)
+		stats_merge(&dst->burst[i], &src->burst[i]);
+	if (src->seek && !dst->seek) {
+		dst->seek = malloc(sizeof(*dst->seek) * SEEK_STAT_CNT);
+		for (i = 0; dst->seek && i < SEEK_STAT_CNT; i++)
+			stats_init(&dst->seek[i]);
+	}
+	for (i = 0; src->seek && dst->seek && i < SEEK_STAT_CNT; i++)
+		stats_merge(&dst->seek[i], &src->seek[i]);
+
 	dst->frames_written += src->frames_written;
 	dst->bytes_written += src->bytes_written;
 	dst->time_taken_ns += src->time_taken_ns;
+	dst->cpu_ns += src->cpu_ns;
+	dst->late += src->late;
+	perf_counters_add(&dst->perf, &src->perf);
+	if (src->started && (!dst->started || src->started < dst->started))
+		dst->started = src->started;
+	if (src->finished > dst->finished)
+		dst->finished = src->finished;
 
 	return 0;
 }
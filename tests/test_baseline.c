@@ -0,0 +1,87 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "baseline.c"
+#include <stdio.h>
+#include "unittest.h"
+
+/* Cases are too large for the stack */
+static baseline_case_t base;
+static baseline_case_t cur;
+
+static void set_runs(baseline_case_t *bc, baseline_run_t *run,
+		     const double *fps, size_t cnt)
+{
+	size_t i;
+
+	memset(bc, 0, sizeof(*bc));
+	stats_init(&bc->lat);
+	for (i = 0; i < cnt; i++) {
+		memset(&run[i], 0, sizeof(run[i]));
+		run[i].fps = fps[i];
+	}
+	bc->run = run;
+	bc->runs = cnt;
+	bc->size = cnt;
+}
+
+int test_compare_few_runs(void)
+{
+	const double base_fps[] = { 100, 101, 99, 98, 102 };
+	const double drop[] = { 50, 51, 49, 48, 52 };
+	const double noise[] = { 99, 100, 98, 97, 101 };
+	baseline_run_t base_run[5];
+	baseline_run_t cur_run[5];
+	baseline_cmp_t cmp;
+
+	/* Three runs can't reach p < 0.01, a large drop still fails */
+	set_runs(&base, base_run, base_fps, 3);
+	set_runs(&cur, cur_run, drop, 3);
+	TEST_ASSERT_EQ(baseline_compare(&base, &cur, 5, 0.01, &cmp), 1);
+	TEST_ASSERT_EQ(cmp.fps_regression, 1);
+
+	set_runs(&cur, cur_run, noise, 3);
+	TEST_ASSERT_EQ(baseline_compare(&base, &cur, 5, 0.01, &cmp), 0);
+	TEST_ASSERT_EQ(cmp.fps_regression, 0);
+
+	/* At alpha 0.2 three runs are enough for the test */
+	set_runs(&cur, cur_run, drop, 3);
+	TEST_ASSERT_EQ(baseline_compare(&base, &cur, 5, 0.2, &cmp), 1);
+	TEST_ASSERT(cmp.fps_p > 0.09 && cmp.fps_p < 0.11);
+
+	/* Five runs go through the test */
+	set_runs(&base, base_run, base_fps, 5);
+	set_runs(&cur, cur_run, drop, 5);
+	TEST_ASSERT_EQ(baseline_compare(&base, &cur, 5, 0.01, &cmp), 1);
+	TEST_ASSERT(cmp.fps_p > 0 && cmp.fps_p < 0.01);
+
+	return 0;
+}
+
+int test_baseline(void)
+{
+	TEST_INIT();
+
+	TEST(compare_few_runs);
+
+	TEST_END();
+}
+
+TEST_MAIN(baseline)
@@ -0,0 +1,127 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "capacity.c"
+#include <stdio.h>
+#include "unittest.h"
+
+int test_capacity_parse_slo(void)
+{
+	capacity_slo_t slo;
+
+	TEST_ASSERT_EQ(capacity_parse_slo(&slo, "p99=41.7"), 0);
+	TEST_ASSERT(slo.late < 0);
+	TEST_ASSERT_EQ(slo.p99, 41700000);
+	TEST_ASSERT_EQ(slo.p50, 0);
+
+	TEST_ASSERT_EQ(capacity_parse_slo(&slo, "late=0,p99.9=50,p50=10"), 0);
+	TEST_ASSERT(slo.late == 0);
+	TEST_ASSERT_EQ(slo.p50, 10000000);
+	TEST_ASSERT_EQ(slo.p99, 0);
+	TEST_ASSERT_EQ(slo.p999, 50000000);
+
+	TEST_ASSERT_EQ(capacity_parse_slo(&slo, ""), 1);
+	TEST_ASSERT_EQ(capacity_parse_slo(&slo, "late"), 1);
+	TEST_ASSERT_EQ(capacity_parse_slo(&slo, "late=-1"), 1);
+	TEST_ASSERT_EQ(capacity_parse_slo(&slo, "p99=0"), 1);
+	TEST_ASSERT_EQ(capacity_parse_slo(&slo, "p99=1ms"), 1);
+	TEST_ASSERT_EQ(capacity_parse_slo(&slo, "p95=1"), 1);
+	TEST_ASSERT_EQ(capacity_parse_slo(NULL, "p99=1"), 1);
+
+	return 0;
+}
+
+int test_capacity_slo_met(void)
+{
+	capacity_slo_t slo = { -1, 0, 40, 0 };
+	sweep_result_t res = { 0 };
+
+	res.mibps = 100;
+	res.p99 = 40;
+	TEST_ASSERT_EQ(capacity_slo_met(&slo, &res), 1);
+	res.p99 = 41;
+	TEST_ASSERT_EQ(capacity_slo_met(&slo, &res), 0);
+
+	slo.p99 = 0;
+	slo.late = 1;
+	res.late = 1;
+	TEST_ASSERT_EQ(capacity_slo_met(&slo, &res), 1);
+	res.late = 1.5;
+	TEST_ASSERT_EQ(capacity_slo_met(&slo, &res), 0);
+
+	/* Failed runs never pass */
+	res.late = 0;
+	res.mibps = 0;
+	TEST_ASSERT_EQ(capacity_slo_met(&slo, &res), 0);
+
+	return 0;
+}
+
+/* Runs a search where up to limit streams pass, returns the steps */
+static size_t capacity_search(capacity_t *cap, size_t max, int bisect,
+			      size_t limit)
+{
+	size_t steps = 0;
+	size_t cnt;
+
+	capacity_init(cap, max, bisect);
+	while ((cnt = capacity_next(cap))) {
+		capacity_result(cap, cnt <= limit);
+		steps++;
+	}
+
+	return steps;
+}
+
+int test_capacity_search(void)
+{
+	capacity_t cap;
+
+	TEST_ASSERT_EQ(capacity_search(&cap, 16, 0, 5), 6);
+	TEST_ASSERT_EQ(capacity_best(&cap), 5);
+	TEST_ASSERT_EQ(capacity_search(&cap, 16, 0, 20), 16);
+	TEST_ASSERT_EQ(capacity_best(&cap), 16);
+	TEST_ASSERT_EQ(capacity_search(&cap, 16, 0, 0), 1);
+	TEST_ASSERT_EQ(capacity_best(&cap), 0);
+
+	TEST_ASSERT(capacity_search(&cap, 64, 1, 37) <= 7);
+	TEST_ASSERT_EQ(capacity_best(&cap), 37);
+	TEST_ASSERT(capacity_search(&cap, 64, 1, 64) <= 7);
+	TEST_ASSERT_EQ(capacity_best(&cap), 64);
+	TEST_ASSERT(capacity_search(&cap, 64, 1, 0) <= 7);
+	TEST_ASSERT_EQ(capacity_best(&cap), 0);
+	TEST_ASSERT_EQ(capacity_search(&cap, 1, 1, 1), 1);
+	TEST_ASSERT_EQ(capacity_best(&cap), 1);
+
+	return 0;
+}
+
+int test_capacity(void)
+{
+	TEST_INIT();
+
+	TEST(capacity_parse_slo);
+	TEST(capacity_slo_met);
+	TEST(capacity_search);
+
+	TEST_END();
+}
+
+TEST_MAIN(capacity)
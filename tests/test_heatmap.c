@@ -0,0 +1,142 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "heatmap.c"
+#include <stdio.h>
+#include <stdlib.h>
+#include "unittest.h"
+
+static uint64_t heatmap_total(const heatmap_t *hm)
+{
+	uint64_t total = 0;
+	size_t i;
+	size_t j;
+
+	for (i = 0; i < HEATMAP_MAX_COLS; i++) {
+		for (j = 0; j < HEATMAP_ROWS; j++)
+			total += hm->cnt[i][j];
+	}
+
+	return total;
+}
+
+int test_heatmap_row(void)
+{
+	size_t i;
+
+	TEST_ASSERT_EQ(heatmap_row(0), 0);
+	TEST_ASSERT_EQ(heatmap_row(1023), 0);
+	TEST_ASSERT_EQ(heatmap_row(1024), 1);
+	TEST_ASSERT_EQ(heatmap_row(2047), 1);
+	TEST_ASSERT_EQ(heatmap_row(2048), 2);
+	TEST_ASSERT_EQ(heatmap_row(UINT64_MAX), HEATMAP_ROWS - 1);
+	TEST_ASSERT_EQ(heatmap_row_max(HEATMAP_ROWS - 1), UINT64_MAX);
+
+	/* Row limits are consistent with the mapping */
+	for (i = 0; i + 1 < HEATMAP_ROWS; i++) {
+		TEST_ASSERT_EQ(heatmap_row(heatmap_row_max(i)), i);
+		TEST_ASSERT_EQ(heatmap_row(heatmap_row_max(i) + 1), i + 1);
+	}
+
+	return 0;
+}
+
+int test_heatmap_add(void)
+{
+	heatmap_t *hm = malloc(sizeof(*hm));
+
+	TEST_ASSERT(hm);
+	heatmap_init(hm, 1000);
+
+	heatmap_add(hm, 1000, 1500);
+	heatmap_add(hm, 1000 + HEATMAP_WINDOW_NS, 1500);
+	heatmap_add(hm, 1000 + 2 * HEATMAP_WINDOW_NS + 1, 5000);
+	/* Before the start lands in the first window */
+	heatmap_add(hm, 0, 10);
+
+	TEST_ASSERT_EQ(hm->cols, 3);
+	TEST_ASSERT_EQ(hm->cnt[0][1], 1);
+	TEST_ASSERT_EQ(hm->cnt[0][0], 1);
+	TEST_ASSERT_EQ(hm->cnt[1][1], 1);
+	TEST_ASSERT_EQ(hm->cnt[2][3], 1);
+
+	free(hm);
+	return 0;
+}
+
+int test_heatmap_shrink(void)
+{
+	heatmap_t *hm = malloc(sizeof(*hm));
+	uint64_t i;
+
+	TEST_ASSERT(hm);
+	heatmap_init(hm, 0);
+
+	/* Frame in every window of four times the capacity */
+	for (i = 0; i < 4 * HEATMAP_MAX_COLS; i++)
+		heatmap_add(hm, i * HEATMAP_WINDOW_NS, 1500);
+
+	TEST_ASSERT_EQ(hm->window_ns, 4 * HEATMAP_WINDOW_NS);
+	TEST_ASSERT_EQ(hm->cols, HEATMAP_MAX_COLS);
+	TEST_ASSERT_EQ(heatmap_total(hm), 4 * HEATMAP_MAX_COLS);
+	for (i = 0; i < HEATMAP_MAX_COLS; i++)
+		TEST_ASSERT_EQ(hm->cnt[i][1], 4);
+
+	free(hm);
+	return 0;
+}
+
+int test_heatmap_add_results(void)
+{
+	test_completion_t comp[2] = {
+		{ .start = 100, .frame = 100 + 3000 },
+		{ .start = 200, .frame = 200 + 70000 },
+	};
+	test_result_t res[2] = {
+		{ .frames_written = 1, .completion = &comp[0] },
+		{ .frames_written = 1, .completion = &comp[1] },
+	};
+	heatmap_t *hm = malloc(sizeof(*hm));
+
+	TEST_ASSERT(hm);
+	heatmap_init(hm, 100);
+	heatmap_add_results(hm, res, 2);
+
+	TEST_ASSERT_EQ(heatmap_total(hm), 2);
+	TEST_ASSERT_EQ(hm->cnt[0][heatmap_row(3000)], 1);
+	TEST_ASSERT_EQ(hm->cnt[0][heatmap_row(70000)], 1);
+
+	free(hm);
+	return 0;
+}
+
+int test_heatmap(void)
+{
+	TEST_INIT();
+
+	TEST(heatmap_row);
+	TEST(heatmap_add);
+	TEST(heatmap_shrink);
+	TEST(heatmap_add_results);
+
+	TEST_END();
+}
+
+TEST_MAIN(heatmap)
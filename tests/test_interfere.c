@@ -0,0 +1,137 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "interfere.c"
+#include <stdio.h>
+#include "unittest.h"
+
+int test_interfere_parse(void)
+{
+	interfere_cfg_t cfg;
+
+	TEST_ASSERT_EQ(interfere_parse(&cfg, "randread:4k:500"), 0);
+	TEST_ASSERT_EQ(cfg.cnt, 1);
+	TEST_ASSERT_EQ(cfg.specs[0].type, INTERFERE_RAND_READ);
+	TEST_ASSERT_EQ(cfg.specs[0].bs, 4096);
+	TEST_ASSERT_EQ(cfg.specs[0].rate, 500);
+
+	TEST_ASSERT_EQ(interfere_parse(&cfg, "randwrite,scan:1m,meta:100"), 0);
+	TEST_ASSERT_EQ(cfg.cnt, 3);
+	TEST_ASSERT_EQ(cfg.specs[0].type, INTERFERE_RAND_WRITE);
+	TEST_ASSERT_EQ(cfg.specs[0].bs, 4096);
+	TEST_ASSERT_EQ(cfg.specs[0].rate, 0);
+	TEST_ASSERT_EQ(cfg.specs[1].type, INTERFERE_SCAN);
+	TEST_ASSERT_EQ(cfg.specs[1].bs, 1024 * 1024);
+	TEST_ASSERT_EQ(cfg.specs[2].type, INTERFERE_META);
+	TEST_ASSERT_EQ(cfg.specs[2].bs, 0);
+	TEST_ASSERT_EQ(cfg.specs[2].rate, 100);
+
+	TEST_ASSERT_EQ(interfere_parse(&cfg, ""), 1);
+	TEST_ASSERT_EQ(interfere_parse(&cfg, "backup"), 1);
+	TEST_ASSERT_EQ(interfere_parse(&cfg, "randread:5000"), 1);
+	TEST_ASSERT_EQ(interfere_parse(&cfg, "randread:0"), 1);
+	TEST_ASSERT_EQ(interfere_parse(&cfg, "randread:4k:x"), 1);
+	TEST_ASSERT_EQ(interfere_parse(&cfg, "scan:128m"), 1);
+	TEST_ASSERT_EQ(interfere_parse(&cfg, "meta:4k:100"), 1);
+	TEST_ASSERT_EQ(interfere_parse(&cfg, "meta,meta,meta,meta,meta,meta,"
+					     "meta,meta,meta"),
+		       1);
+	TEST_ASSERT_EQ(interfere_parse(NULL, "meta"), 1);
+
+	return 0;
+}
+
+int test_interfere_op(void)
+{
+	const platform_t *platform = test_platform_get();
+	interfere_cfg_t cfg;
+	interfere_t bg;
+	interfere_worker_t *w;
+	size_t i;
+
+	TEST_ASSERT_EQ(interfere_parse(&cfg, "randread,randwrite,scan:1m,meta"),
+		       0);
+	TEST_ASSERT_EQ(interfere_init(&bg, platform, "bg", &cfg, NULL), 0);
+	TEST_ASSERT_EQ(bg.cnt, 4);
+	TEST_ASSERT(!strcmp(bg.workers[0].name, "bg0.tst"));
+	TEST_ASSERT_EQ(bg.workers[3].f, 0);
+
+	for (i = 0; i < bg.cnt; i++) {
+		TEST_ASSERT_EQ(interfere_op(&bg.workers[i]), 0);
+		TEST_ASSERT_EQ(interfere_op(&bg.workers[i]), 0);
+	}
+
+	/* Scan wraps around at the end of the file */
+	w = &bg.workers[2];
+	TEST_ASSERT_EQ(w->pos, 2 * 1024 * 1024);
+	w->pos = INTERFERE_FILE_SIZE - 4096;
+	TEST_ASSERT_EQ(interfere_op(w), 0);
+	TEST_ASSERT_EQ(w->pos, 1024 * 1024);
+
+	/* Random offsets are block aligned and within the file */
+	w = &bg.workers[0];
+	for (i = 0; i < 1000; i++) {
+		uint64_t off = interfere_random(&w->rng) %
+			       (INTERFERE_FILE_SIZE / w->spec->bs) *
+			       w->spec->bs;
+
+		TEST_ASSERT_EQ(off % 4096, 0);
+		TEST_ASSERT(off + w->spec->bs <= INTERFERE_FILE_SIZE);
+	}
+
+	/* No threads on the test platform */
+	TEST_ASSERT_EQ(interfere_start(&bg), 1);
+	TEST_ASSERT_EQ(bg.workers[0].running, 0);
+
+	interfere_free(&bg);
+	TEST_ASSERT_EQ(bg.workers, NULL);
+	test_platform_finalize();
+
+	return 0;
+}
+
+int test_interfere_rate(void)
+{
+	interfere_worker_t workers[2] = { { 0 } };
+	interfere_t bg = { 0 };
+
+	bg.workers = workers;
+	bg.cnt = 2;
+	TEST_ASSERT(interfere_rate(&bg, 0) == 0);
+	bg.elapsed = 2000000000ULL;
+	workers[1].ops = 500;
+	TEST_ASSERT(interfere_rate(&bg, 1) == 250);
+	TEST_ASSERT(interfere_rate(&bg, 2) == 0);
+
+	return 0;
+}
+
+int test_interfere(void)
+{
+	TEST_INIT();
+
+	TEST(interfere_parse);
+	TEST(interfere_op);
+	TEST(interfere_rate);
+
+	TEST_END();
+}
+
+TEST_MAIN(interfere)
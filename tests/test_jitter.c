@@ -0,0 +1,116 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "jitter.c"
+#include <stdio.h>
+#include <stdlib.h>
+#include "unittest.h"
+
+int test_jitter_bin(void)
+{
+	TEST_ASSERT_EQ(jitter_bin(0, 100), 0);
+	TEST_ASSERT_EQ(jitter_bin(49, 100), 0);
+	TEST_ASSERT_EQ(jitter_bin(50, 100), 1);
+	TEST_ASSERT_EQ(jitter_bin(149, 100), 1);
+	TEST_ASSERT_EQ(jitter_bin(150, 100), 2);
+	TEST_ASSERT_EQ(jitter_bin(100000, 100), JITTER_BINS - 1);
+	TEST_ASSERT_EQ(jitter_bin(100, 0), 0);
+
+	return 0;
+}
+
+int test_jitter_collect(void)
+{
+	/* Two threads with interleaved frames, frame 3 late */
+	test_completion_t a[] = {
+		{ .num = 0, .frame = 1000 },
+		{ .num = 2, .frame = 1200 },
+		{ .num = 4, .frame = 1400 },
+	};
+	test_completion_t b[] = {
+		{ .num = 1, .frame = 1100 },
+		{ .num = 3, .frame = 1600 },
+		{ .num = 5, .frame = 1700 },
+	};
+	test_result_t res[2] = {
+		{ .frames_written = 3, .completion = a },
+		{ .frames_written = 3, .completion = b },
+	};
+	jitter_t *jt = malloc(sizeof(*jt));
+
+	TEST_ASSERT(jt);
+	TEST_ASSERT_EQ(jitter_collect(jt, res, 2, 100), 0);
+
+	/* Deliveries 1000 1100 1200 1600 1600 1700 */
+	TEST_ASSERT_EQ(jt->st.cnt, 5);
+	TEST_ASSERT_EQ(jt->st.max, 400);
+	TEST_ASSERT_EQ(jt->st.min, 0);
+	TEST_ASSERT_EQ(jt->st.sum, 700);
+	TEST_ASSERT_EQ(jt->max_gap_frame, 3);
+	TEST_ASSERT(jt->nominal);
+	TEST_ASSERT_EQ(jt->bins[0], 1);
+	TEST_ASSERT_EQ(jt->bins[1], 3);
+	TEST_ASSERT_EQ(jt->bins[4], 1);
+
+	/* Without nominal period the mean is used */
+	TEST_ASSERT_EQ(jitter_collect(jt, res, 2, 0), 0);
+	TEST_ASSERT(!jt->nominal);
+	TEST_ASSERT_EQ(jt->period, 140);
+
+	free(jt);
+	return 0;
+}
+
+int test_jitter_missing(void)
+{
+	/* Frame 1 failed, player skips it */
+	test_completion_t a[] = {
+		{ .num = 0, .frame = 1000 },
+		{ .num = 2, .frame = 1300 },
+	};
+	test_result_t res = { .frames_written = 2, .completion = a };
+	jitter_t *jt = malloc(sizeof(*jt));
+
+	TEST_ASSERT(jt);
+	TEST_ASSERT_EQ(jitter_collect(jt, &res, 1, 100), 0);
+	TEST_ASSERT_EQ(jt->st.cnt, 1);
+	TEST_ASSERT_EQ(jt->st.max, 300);
+	TEST_ASSERT_EQ(jt->bins[3], 1);
+
+	/* Single frame has no intervals */
+	res.frames_written = 1;
+	TEST_ASSERT(jitter_collect(jt, &res, 1, 100));
+
+	free(jt);
+	return 0;
+}
+
+int test_jitter(void)
+{
+	TEST_INIT();
+
+	TEST(jitter_bin);
+	TEST(jitter_collect);
+	TEST(jitter_missing);
+
+	TEST_END();
+}
+
+TEST_MAIN(jitter)
@@ -0,0 +1,137 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "job.c"
+#include <stdio.h>
+#include "unittest.h"
+
+static int parse_str(job_t *job, const char *str)
+{
+	FILE *f = tmpfile();
+	int res;
+
+	if (!f)
+		return -2;
+	fputs(str, f);
+	rewind(f);
+	res = job_parse(job, f);
+	fclose(f);
+
+	return res;
+}
+
+int test_job_parse(void)
+{
+	job_t job;
+
+	TEST_ASSERT_EQ(parse_str(&job, "# suite\n"
+				       "[global]\n"
+				       "num-frames = 100\n"
+				       "cleanup = yes\n"
+				       "\n"
+				       "[write 4k]\n"
+				       "write=4k ; comment is part of value\n"
+				       "[read]\n"
+				       "  read\n"
+				       "group = mixed\n"
+				       "cleanup = 0\n"),
+		       0);
+	TEST_ASSERT_EQ(job.global.cnt, 1);
+	TEST_ASSERT_EQ(strcmp(job.global.kv[0].key, "num-frames"), 0);
+	TEST_ASSERT_EQ(strcmp(job.global.kv[0].value, "100"), 0);
+	TEST_ASSERT_EQ(job.global.cleanup, 1);
+	TEST_ASSERT_EQ(job.cnt, 2);
+	TEST_ASSERT_EQ(strcmp(job.cases[0].name, "write 4k"), 0);
+	TEST_ASSERT_EQ(job.cases[0].cleanup, -1);
+	TEST_ASSERT_EQ(job.cases[0].group[0], 0);
+	TEST_ASSERT_EQ(strcmp(job.cases[0].kv[0].value,
+			      "4k ; comment is part of value"),
+		       0);
+	TEST_ASSERT_EQ(job.cases[1].cnt, 1);
+	TEST_ASSERT_EQ(strcmp(job.cases[1].kv[0].key, "read"), 0);
+	TEST_ASSERT_EQ(job.cases[1].kv[0].value[0], 0);
+	TEST_ASSERT_EQ(strcmp(job.cases[1].group, "mixed"), 0);
+	TEST_ASSERT_EQ(job.cases[1].cleanup, 0);
+	job_free(&job);
+
+	return 0;
+}
+
+int test_job_invalid(void)
+{
+	char group[JOB_MAX_NAME + 16];
+	job_t job;
+
+	/* Returns the line of the error */
+	TEST_ASSERT_EQ(parse_str(&job, "threads=1\n"), 1);
+	job_free(&job);
+	TEST_ASSERT_EQ(parse_str(&job, "[a]\nthreads=1\n[a]\n"), 3);
+	job_free(&job);
+	TEST_ASSERT_EQ(parse_str(&job, "[a\n"), 1);
+	job_free(&job);
+	TEST_ASSERT_EQ(parse_str(&job, "[]\n"), 1);
+	job_free(&job);
+	TEST_ASSERT_EQ(parse_str(&job, "[a]\n=1\n"), 2);
+	job_free(&job);
+	TEST_ASSERT_EQ(parse_str(&job, "[a]\ncleanup=maybe\n"), 2);
+	job_free(&job);
+	/* Group names are limited like case names */
+	snprintf(group, sizeof(group), "[a]\ngroup=%0*d\n", JOB_MAX_NAME, 0);
+	TEST_ASSERT_EQ(parse_str(&job, group), 2);
+	job_free(&job);
+	/* No cases */
+	TEST_ASSERT_EQ(parse_str(&job, "[global]\nthreads=1\n"), 2);
+	job_free(&job);
+	TEST_ASSERT_EQ(parse_str(&job, ""), 1);
+	job_free(&job);
+	TEST_ASSERT_EQ(job_parse(&job, NULL), -1);
+	TEST_ASSERT_EQ(job_load(&job, "/nonexistent/job.ini"), -1);
+	job_free(&job);
+
+	return 0;
+}
+
+int test_job_bool(void)
+{
+	int val = -1;
+
+	TEST_ASSERT_EQ(job_bool("", &val), 0);
+	TEST_ASSERT_EQ(val, 1);
+	TEST_ASSERT_EQ(job_bool("no", &val), 0);
+	TEST_ASSERT_EQ(val, 0);
+	TEST_ASSERT_EQ(job_bool("true", &val), 0);
+	TEST_ASSERT_EQ(val, 1);
+	TEST_ASSERT_EQ(job_bool("2", &val), 1);
+
+	return 0;
+}
+
+int test_job(void)
+{
+	TEST_INIT();
+
+	TEST(job_parse);
+	TEST(job_invalid);
+	TEST(job_bool);
+
+	TEST_END();
+}
+
+TEST_MAIN(job)
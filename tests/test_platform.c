@@ -234,6 +234,23 @@ int test_platform_thread_join(uint64_t thread_id, void **retval)
 	return -1;
 }
 
+platform_gate_t *test_platform_gate_new(void)
+{
+	return NULL;
+}
+
+void test_platform_gate_wait(platform_gate_t *gate)
+{
+}
+
+void test_platform_gate_open(platform_gate_t *gate)
+{
+}
+
+void test_platform_gate_free(platform_gate_t *gate)
+{
+}
+
 static platform_t test_platform = {
 	.open = test_platform_open,
 	.close = test_platform_close,
@@ -252,6 +269,11 @@ static platform_t test_platform = {
 	.thread_create = test_platform_thread_create,
 	.thread_cancel = test_platform_thread_cancel,
 	.thread_join = test_platform_thread_join,
+
+	.gate_new = test_platform_gate_new,
+	.gate_wait = test_platform_gate_wait,
+	.gate_open = test_platform_gate_open,
+	.gate_free = test_platform_gate_free,
 };
 
 const platform_t *test_platform_get(void)
@@ -275,17 +297,55 @@ void test_platform_finalize(void)
 }
 
 static int ignore_printf = 0;
+static char *capture = NULL;
+static size_t capture_size = 0;
+static size_t capture_len = 0;
 
 void test_ignore_printf(int val)
 {
 	ignore_printf = val;
 }
 
+void test_capture_printf(char *buf, size_t size)
+{
+	capture = buf;
+	capture_size = size;
+	capture_len = 0;
+	if (buf && size)
+		buf[0] = 0;
+}
+
+static int capture_vprintf(const char *fmt, va_list ap)
+{
+	int res;
+
+	res = vsnprintf(capture + capture_len, capture_size - capture_len, fmt,
+			ap);
+	if (res > 0)
+		capture_len += (size_t)res < capture_size - capture_len ?
+				       (size_t)res :
+				       capture_size - capture_len - 1;
+	return res;
+}
+
+static int capture_printf(const char *fmt, ...)
+{
+	va_list ap;
+	int res;
+
+	va_start(ap, fmt);
+	res = capture_vprintf(fmt, ap);
+	va_end(ap);
+	return res;
+}
+
 int __real_puts(const char *s);
 int __wrap_puts(const char *s)
 {
 	if (ignore_printf)
 		return 0;
+	if (capture)
+		return capture_printf("%s\n", s);
 	return __real_puts(s);
 }
 
@@ -294,15 +354,23 @@ int __wrap_putchar(int c)
 {
 	if (ignore_printf)
 		return 0;
+	if (capture)
+		return capture_printf("%c", c) == 1 ? c : EOF;
 	return __real_putchar(c);
 }
 
 int __wrap_printf(const char *fmt, ...)
 {
 	va_list ap;
+	int res;
 
 	if (ignore_printf)
 		return 0;
 	va_start(ap, fmt);
-	return vprintf(fmt, ap);
+	if (capture)
+		res = capture_vprintf(fmt, ap);
+	else
+		res = vprintf(fmt, ap);
+	va_end(ap);
+	return res;
 }
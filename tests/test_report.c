@@ -0,0 +1,138 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "report.c"
+#include <stdio.h>
+#include "unittest.h"
+
+static void set_finish(test_result_t *res, test_result_t *thread_res,
+		       const uint64_t *finish, size_t cnt)
+{
+	size_t i;
+
+	memset(res, 0, sizeof(*res));
+	res->started = 1000;
+	for (i = 0; i < cnt; i++) {
+		memset(&thread_res[i], 0, sizeof(thread_res[i]));
+		thread_res[i].finished = res->started + finish[i];
+		thread_res[i].bytes_written = 1000;
+		thread_res[i].time_taken_ns = finish[i];
+	}
+}
+
+int test_fairness_median(void)
+{
+	const uint64_t two[] = { 400, 100 };
+	const uint64_t four[] = { 300, 100, 800, 200 };
+	const uint64_t three[] = { 300, 100, 200 };
+	test_result_t thread_res[4];
+	test_result_t res;
+	fairness_t fair;
+
+	/* The slowest of two threads isn't its own median */
+	set_finish(&res, thread_res, two, 2);
+	fairness_calc(&res, thread_res, 2, &fair);
+	TEST_ASSERT_EQ(fair.slowest_finish, 400);
+	TEST_ASSERT_EQ(fair.median_finish, 250);
+
+	set_finish(&res, thread_res, four, 4);
+	fairness_calc(&res, thread_res, 4, &fair);
+	TEST_ASSERT_EQ(fair.slowest_finish, 800);
+	TEST_ASSERT_EQ(fair.median_finish, 250);
+
+	set_finish(&res, thread_res, three, 3);
+	fairness_calc(&res, thread_res, 3, &fair);
+	TEST_ASSERT_EQ(fair.median_finish, 200);
+
+	fairness_calc(&res, thread_res, 0, &fair);
+	TEST_ASSERT_EQ(fair.median_finish, 0);
+
+	return 0;
+}
+
+static void set_latency(test_result_t *res, test_completion_t *comp,
+			size_t cnt, const uint64_t *lat)
+{
+	size_t i;
+
+	memset(res, 0, sizeof(*res));
+	for (i = 0; i < cnt; i++) {
+		memset(&comp[i], 0, sizeof(comp[i]));
+		comp[i].start = 1000 + i * 100;
+		comp[i].frame = comp[i].start + lat[i];
+	}
+	res->completion = comp;
+	res->frames_written = cnt;
+	res->bytes_written = cnt * 1000;
+	res->time_taken_ns = cnt * 100;
+}
+
+int test_thread_pcts_csv(void)
+{
+	static uint64_t lat[3][200];
+	static test_completion_t comp[3][200];
+	static char out[4096];
+	test_result_t thread_res[2];
+	test_result_t res;
+	opts_t opts;
+	size_t i;
+
+	/* Thread 0 has a slow tail, thread 1 is constant */
+	for (i = 0; i < 100; i++) {
+		lat[0][i] = i < 95 ? 10 : 50;
+		lat[1][i] = 20;
+	}
+	for (i = 0; i < 200; i++)
+		lat[2][i] = lat[i / 100][i % 100];
+	set_latency(&thread_res[0], comp[0], 100, lat[0]);
+	set_latency(&thread_res[1], comp[1], 100, lat[1]);
+	set_latency(&res, comp[2], 200, lat[2]);
+
+	memset(&opts, 0, sizeof(opts));
+	opts.profile.name = "p";
+	opts.threads = 2;
+	opts.csv = 1;
+	opts.per_thread = 1;
+
+	test_capture_printf(out, sizeof(out));
+	print_header_csv(&opts);
+	print_results_csv("w", &opts, &res, thread_res, 2);
+	test_capture_printf(NULL, 0);
+
+	TEST_ASSERT(strstr(out, ",fmax,fp50,fp95,fp99,fp99.9,jain,"));
+	TEST_ASSERT(strstr(out, ",50,20,20,50,50,1.0"));
+	TEST_ASSERT(strstr(out, "\"w/thread0\""));
+	TEST_ASSERT(strstr(out, ",50,10,10,50,50,,,\n"));
+	TEST_ASSERT(strstr(out, ",20,20,20,20,20,,,\n"));
+
+	return 0;
+}
+
+int test_report(void)
+{
+	TEST_INIT();
+
+	TEST(fairness_median);
+	TEST(thread_pcts_csv);
+
+	TEST_END();
+}
+
+TEST_MAIN(report)
@@ -0,0 +1,173 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "sim.c"
+#include <stdio.h>
+#include "unittest.h"
+
+static void sim_config_zero(sim_config_t *cfg)
+{
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->tail_alpha = 1.5;
+	cfg->seed = 1;
+}
+
+int test_sim_parse(void)
+{
+	sim_config_t cfg;
+
+	sim_config_default(&cfg);
+	TEST_ASSERT(cfg.bandwidth > 0);
+	TEST_ASSERT(cfg.latency_ns > 0);
+
+	TEST_ASSERT_EQ(sim_config_parse(&cfg, "bw=100,lat=250,jitter=0.5"), 0);
+	TEST_ASSERT_EQ(cfg.bandwidth, 100 * 1024 * 1024);
+	TEST_ASSERT_EQ(cfg.latency_ns, 250000);
+	TEST_ASSERT(cfg.jitter == 0.5);
+
+	TEST_ASSERT_EQ(sim_config_parse(&cfg, "stall=1000:50,open=5,seed=7"),
+		       0);
+	TEST_ASSERT_EQ(cfg.stall_period_ns, 1000 * SEC_IN_MS);
+	TEST_ASSERT_EQ(cfg.stall_ns, 50 * SEC_IN_MS);
+	TEST_ASSERT_EQ(cfg.open_ns, 5000);
+	TEST_ASSERT_EQ(cfg.seed, 7);
+	/* Untouched values stay */
+	TEST_ASSERT_EQ(cfg.bandwidth, 100 * 1024 * 1024);
+
+	TEST_ASSERT_EQ(sim_config_parse(&cfg, "bw"), 1);
+	TEST_ASSERT_EQ(sim_config_parse(&cfg, "foo=1"), 1);
+	TEST_ASSERT_EQ(sim_config_parse(&cfg, "lat=1x"), 1);
+	TEST_ASSERT_EQ(sim_config_parse(&cfg, "lat=-1"), 1);
+	TEST_ASSERT_EQ(sim_config_parse(&cfg, "tail=2"), 1);
+	TEST_ASSERT_EQ(sim_config_parse(&cfg, "stall=10:20"), 1);
+	TEST_ASSERT_EQ(sim_config_parse(&cfg, "stall=10"), 1);
+	TEST_ASSERT_EQ(sim_config_parse(NULL, "bw=1"), 1);
+
+	return 0;
+}
+
+int test_sim_model(void)
+{
+	sim_config_t cfg;
+	uint64_t a;
+	uint64_t b;
+
+	sim_config_zero(&cfg);
+	cfg.latency_ns = 1000;
+	cfg.bandwidth = SEC_IN_NS;
+	sim_cfg = cfg;
+
+	/* Without randomness the model is exact */
+	TEST_ASSERT_EQ(sim_service_ns(1, 1000, 1), 2000);
+	/* Bandwidth is shared between in-flight requests */
+	TEST_ASSERT_EQ(sim_service_ns(1, 1000, 2), 3000);
+
+	sim_cfg.qd_factor = 1;
+	TEST_ASSERT_EQ(sim_service_ns(1, 0, 3), 3000);
+
+	/* Same seed gives the same latency */
+	sim_cfg.jitter = 0.5;
+	a = sim_service_ns(42, 0, 1);
+	b = sim_service_ns(42, 0, 1);
+	TEST_ASSERT_EQ(a, b);
+	TEST_ASSERT(a > 0);
+
+	/* Pareto tail can only make it slower */
+	sim_cfg.jitter = 0;
+	sim_cfg.tail_prob = 1;
+	TEST_ASSERT(sim_service_ns(42, 0, 1) >= 1000);
+
+	return 0;
+}
+
+int test_sim_stall(void)
+{
+	sim_config_zero(&sim_cfg);
+	sim_epoch = 1000;
+	TEST_ASSERT_EQ(sim_stall_end(5000), 5000);
+
+	sim_cfg.stall_period_ns = 100;
+	sim_cfg.stall_ns = 20;
+	TEST_ASSERT_EQ(sim_stall_end(1000), 1000);
+	TEST_ASSERT_EQ(sim_stall_end(1079), 1079);
+	TEST_ASSERT_EQ(sim_stall_end(1080), 1100);
+	TEST_ASSERT_EQ(sim_stall_end(1099), 1100);
+	TEST_ASSERT_EQ(sim_stall_end(1100), 1100);
+	TEST_ASSERT_EQ(sim_stall_end(1290), 1300);
+
+	return 0;
+}
+
+int test_sim_platform(void)
+{
+	const platform_t *platform;
+	platform_handle_t f;
+	platform_stat_t st;
+	sim_config_t cfg;
+	uint64_t start;
+	char buf[16];
+
+	timing_init(TIMING_CLOCK);
+	sim_config_zero(&cfg);
+	cfg.latency_ns = 2 * SEC_IN_MS;
+	platform = sim_platform_get(&cfg);
+	TEST_ASSERT(platform);
+	TEST_ASSERT(platform->calloc == platform_get()->calloc);
+
+	/* Nothing written yet */
+	TEST_ASSERT_EQ(platform->stat("frame", &st), -1);
+
+	f = platform->open("frame", PLATFORM_OPEN_WRITE, 0666);
+	TEST_ASSERT(f > 0);
+
+	start = timing_time();
+	TEST_ASSERT_EQ(platform->write(f, buf, sizeof(buf)), sizeof(buf));
+	TEST_ASSERT(timing_time() - start >= cfg.latency_ns);
+
+	TEST_ASSERT_EQ(platform->seek(f, 0, PLATFORM_SEEK_CUR), sizeof(buf));
+	TEST_ASSERT_EQ(platform->seek(f, 4, PLATFORM_SEEK_SET), 4);
+	TEST_ASSERT_EQ(platform->close(f), 0);
+	TEST_ASSERT_EQ(platform->close(f), -1);
+	TEST_ASSERT_EQ(platform->write(f, buf, sizeof(buf)), 0);
+
+	TEST_ASSERT_EQ(platform->stat("frame", &st), 0);
+	TEST_ASSERT_EQ(st.size, sizeof(buf));
+
+	f = platform->open("frame", PLATFORM_OPEN_READ, 0);
+	TEST_ASSERT(f > 0);
+	TEST_ASSERT_EQ(platform->read(f, buf, sizeof(buf)), sizeof(buf));
+	TEST_ASSERT_EQ(platform->close(f), 0);
+
+	return 0;
+}
+
+int test_sim(void)
+{
+	TEST_INIT();
+
+	TEST(sim_parse);
+	TEST(sim_model);
+	TEST(sim_stall);
+	TEST(sim_platform);
+
+	TEST_END();
+}
+
+TEST_MAIN(sim)
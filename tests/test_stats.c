@@ -0,0 +1,236 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include "unittest.h"
+#include "stats.h"
+#include "stats.c"
+
+int test_stats_bucket(void)
+{
+	size_t i;
+
+	TEST_ASSERT_EQ(stats_bucket(0), 0);
+	TEST_ASSERT_EQ(stats_bucket(63), 63);
+	TEST_ASSERT_EQ(stats_bucket(64), 64);
+	TEST_ASSERT_EQ(stats_bucket(65), 64);
+	TEST_ASSERT_EQ(stats_bucket(66), 65);
+	TEST_ASSERT_EQ(stats_bucket(UINT64_MAX), STATS_BUCKETS - 1);
+
+	/* Every bucket range must map back to the same bucket */
+	for (i = 0; i < STATS_BUCKETS; i++) {
+		TEST_ASSERT_EQI(i, stats_bucket(stats_bucket_min(i)), i);
+		TEST_ASSERT_EQI(i, stats_bucket(stats_bucket_max(i)), i);
+		if (i)
+			TEST_ASSERT_EQI(i, stats_bucket_max(i - 1) + 1,
+					stats_bucket_min(i));
+	}
+
+	return 0;
+}
+
+int test_stats_add(void)
+{
+	stats_t st;
+	uint64_t i;
+
+	stats_init(&st);
+	TEST_ASSERT_EQ(st.cnt, 0);
+	TEST_ASSERT_EQ(stats_percentile(&st, 50), 0);
+	TEST_ASSERT(stats_mean(&st) == 0);
+
+	for (i = 1; i <= 100; i++)
+		stats_add(&st, i);
+
+	TEST_ASSERT_EQ(st.cnt, 100);
+	TEST_ASSERT_EQ(st.min, 1);
+	TEST_ASSERT_EQ(st.max, 100);
+	TEST_ASSERT_EQ(st.sum, 5050);
+	TEST_ASSERT(stats_mean(&st) == 50.5);
+	TEST_ASSERT(stats_stddev(&st) > 28.8 && stats_stddev(&st) < 28.9);
+
+	/* Small values are exact */
+	TEST_ASSERT_EQ(stats_percentile(&st, 0), 1);
+	TEST_ASSERT_EQ(stats_percentile(&st, 50), 50);
+	TEST_ASSERT_EQ(stats_percentile(&st, 100), 100);
+
+	return 0;
+}
+
+int test_stats_percentile_error(void)
+{
+	stats_t st;
+	uint64_t i;
+	uint64_t p;
+
+	stats_init(&st);
+	for (i = 1; i <= 100000; i++)
+		stats_add(&st, i * 1000);
+
+	p = stats_percentile(&st, 99);
+	TEST_ASSERT(p > 99000000 - 99000000 / STATS_SUB_CNT);
+	TEST_ASSERT(p < 99000000 + 99000000 / STATS_SUB_CNT);
+
+	p = stats_percentile(&st, 50);
+	TEST_ASSERT(p > 50000000 - 50000000 / STATS_SUB_CNT);
+	TEST_ASSERT(p < 50000000 + 50000000 / STATS_SUB_CNT);
+
+	TEST_ASSERT_EQ(stats_percentile(&st, 100), 100000000);
+
+	return 0;
+}
+
+int test_stats_merge(void)
+{
+	stats_t a;
+	stats_t b;
+
+	stats_init(&a);
+	stats_init(&b);
+
+	stats_add(&a, 10);
+	stats_add(&a, 20);
+	stats_add(&b, 5);
+	stats_add(&b, 500);
+
+	stats_merge(&a, &b);
+	TEST_ASSERT_EQ(a.cnt, 4);
+	TEST_ASSERT_EQ(a.min, 5);
+	TEST_ASSERT_EQ(a.max, 500);
+	TEST_ASSERT_EQ(a.sum, 535);
+
+	/* Merging empty one is no-op */
+	stats_init(&b);
+	stats_merge(&a, &b);
+	TEST_ASSERT_EQ(a.cnt, 4);
+	TEST_ASSERT_EQ(a.min, 5);
+
+	return 0;
+}
+
+int test_stats_mann_whitney_values(void)
+{
+	const double a[] = { 6, 7, 8, 9, 10 };
+	const double b[] = { 1, 2, 3, 4, 5 };
+	double effect;
+	double p;
+
+	/* Exact distribution, most extreme of 252 orderings on each side */
+	p = stats_mann_whitney_values(a, 5, b, 5, &effect);
+	TEST_ASSERT(fabs(p - 2.0 / 252) < 1e-9);
+	TEST_ASSERT(fabs(effect - 1) < 1e-9);
+
+	p = stats_mann_whitney_values(b, 5, a, 5, &effect);
+	TEST_ASSERT(fabs(p - 2.0 / 252) < 1e-9);
+	TEST_ASSERT(fabs(effect) < 1e-9);
+
+	p = stats_mann_whitney_values(a, 5, a, 5, &effect);
+	TEST_ASSERT(p > 0.99);
+	TEST_ASSERT(fabs(effect - 0.5) < 1e-9);
+
+	p = stats_mann_whitney_values(a, 0, b, 5, NULL);
+	TEST_ASSERT(p == 1);
+
+	return 0;
+}
+
+int test_stats_mann_whitney(void)
+{
+	stats_t a;
+	stats_t b;
+	double effect;
+	double p;
+	uint64_t i;
+
+	stats_init(&a);
+	stats_init(&b);
+	for (i = 0; i < 1000; i++) {
+		stats_add(&a, 1000000 + i * 100);
+		stats_add(&b, 1000000 + i * 100);
+	}
+
+	p = stats_mann_whitney(&a, &b, &effect);
+	TEST_ASSERT(p > 0.99);
+	TEST_ASSERT(fabs(effect - 0.5) < 1e-9);
+
+	/* Shift by a fifth of the range */
+	stats_init(&b);
+	for (i = 0; i < 1000; i++)
+		stats_add(&b, 1000000 + (i + 200) * 100);
+
+	p = stats_mann_whitney(&b, &a, &effect);
+	TEST_ASSERT(p < 0.001);
+	TEST_ASSERT(effect > 0.6);
+
+	p = stats_mann_whitney(&a, &b, &effect);
+	TEST_ASSERT(p < 0.001);
+	TEST_ASSERT(effect < 0.4);
+
+	return 0;
+}
+
+int test_stats_median_ci(void)
+{
+	double odd[] = { 5, 1, 3, 2, 4 };
+	double even[] = { 4, 1, 3, 2 };
+	double many[100];
+	double med;
+	double lo;
+	double hi;
+	size_t i;
+
+	stats_median_ci(odd, 5, &med, &lo, &hi);
+	TEST_ASSERT(med == 3);
+	TEST_ASSERT(lo == 1);
+	TEST_ASSERT(hi == 5);
+
+	stats_median_ci(even, 4, &med, &lo, &hi);
+	TEST_ASSERT(med == 2.5);
+
+	for (i = 0; i < 100; i++)
+		many[i] = 99 - i;
+	stats_median_ci(many, 100, &med, &lo, &hi);
+	TEST_ASSERT(med == 49.5);
+	TEST_ASSERT(lo >= 38 && lo < 49.5);
+	TEST_ASSERT(hi > 49.5 && hi <= 61);
+
+	stats_median_ci(many, 0, &med, &lo, &hi);
+	TEST_ASSERT(med == 0);
+
+	return 0;
+}
+
+int test_stats(void)
+{
+	TEST_INIT();
+
+	TEST(stats_bucket);
+	TEST(stats_add);
+	TEST(stats_percentile_error);
+	TEST(stats_merge);
+	TEST(stats_mann_whitney_values);
+	TEST(stats_mann_whitney);
+	TEST(stats_median_ci);
+
+	TEST_END();
+}
+
+TEST_MAIN(stats)
@@ -0,0 +1,153 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "steady.c"
+#include <stdio.h>
+#include <stdlib.h>
+#include "unittest.h"
+
+/* One second window of frames all taking lat */
+static int add_window(steady_t *sd, uint64_t frames, uint64_t lat)
+{
+	stats_t *st = malloc(sizeof(*st));
+	uint64_t i;
+	int res;
+
+	stats_init(st);
+	for (i = 0; i < frames; i++)
+		stats_add(st, lat);
+	res = steady_add_window(sd, SEC_IN_NS, frames, frames * 10, st);
+	free(st);
+
+	return res;
+}
+
+int test_steady_detect(void)
+{
+	steady_t *sd = malloc(sizeof(*sd));
+	size_t i;
+
+	TEST_ASSERT(sd);
+	TEST_ASSERT_EQ(steady_init(sd, NULL, 1, 3 * SEC_IN_NS, 5), 0);
+
+	/* Write cache filling up */
+	for (i = 0; i < 5; i++)
+		TEST_ASSERT_EQ(add_window(sd, 500 - i * 80, 1000000), 0);
+	TEST_ASSERT(steady_variation(sd, 0) > 5);
+
+	for (i = 0; i < STEADY_WINDOWS - 1; i++)
+		TEST_ASSERT_EQ(add_window(sd, 100, 5000000), 0);
+	TEST_ASSERT_EQ(sd->steady_at, 0);
+	TEST_ASSERT_EQ(add_window(sd, 100, 5000000), 1);
+	TEST_ASSERT_EQ(sd->steady_at, (5 + STEADY_WINDOWS) * SEC_IN_NS);
+	TEST_ASSERT_EQ(sd->transient.ns, sd->steady_at);
+	TEST_ASSERT(steady_variation(sd, 0) < 0.001);
+
+	TEST_ASSERT_EQ(add_window(sd, 101, 5000000), 1);
+	TEST_ASSERT_EQ(add_window(sd, 99, 5000000), 1);
+	TEST_ASSERT_EQ(sd->done, 0);
+	TEST_ASSERT_EQ(add_window(sd, 100, 5000000), 1);
+	TEST_ASSERT_EQ(sd->done, 1);
+	TEST_ASSERT_EQ(sd->steady.ns, 3 * SEC_IN_NS);
+	TEST_ASSERT_EQ(sd->steady.frames, 300);
+	TEST_ASSERT_EQ(sd->steady.bytes, 3000);
+	TEST_ASSERT_EQ(sd->steady.lat.cnt, 300);
+	TEST_ASSERT_EQ(sd->transient.frames,
+		       500 + 420 + 340 + 260 + 180 + STEADY_WINDOWS * 100);
+
+	steady_free(sd);
+	free(sd);
+
+	return 0;
+}
+
+int test_steady_lost(void)
+{
+	steady_t *sd = malloc(sizeof(*sd));
+	size_t i;
+
+	TEST_ASSERT(sd);
+	TEST_ASSERT_EQ(steady_init(sd, NULL, 1, 10 * SEC_IN_NS, 5), 0);
+
+	for (i = 0; i < STEADY_WINDOWS + 2; i++)
+		add_window(sd, 100, 5000000);
+	TEST_ASSERT_EQ(sd->steady_at, STEADY_WINDOWS * SEC_IN_NS);
+	TEST_ASSERT_EQ(sd->steady.frames, 200);
+
+	/* Latency jumps, the steady state so far was transient after all */
+	TEST_ASSERT_EQ(add_window(sd, 100, 50000000), 0);
+	TEST_ASSERT_EQ(sd->steady_at, 0);
+	TEST_ASSERT_EQ(sd->steady.frames, 0);
+	TEST_ASSERT_EQ(sd->steady.ns, 0);
+	TEST_ASSERT_EQ(sd->transient.frames, (STEADY_WINDOWS + 3) * 100);
+	TEST_ASSERT_EQ(sd->transient.lat.cnt, (STEADY_WINDOWS + 3) * 100);
+	TEST_ASSERT_EQ(sd->done, 0);
+
+	steady_free(sd);
+	free(sd);
+
+	return 0;
+}
+
+int test_steady_collect(void)
+{
+	steady_t *sd = malloc(sizeof(*sd));
+	size_t i;
+
+	TEST_ASSERT(sd);
+	TEST_ASSERT_EQ(steady_init(sd, NULL, 2, SEC_IN_NS, 5), 0);
+
+	for (i = 0; i < 10; i++)
+		steady_frame_done(&sd->slots[i % 2], 1000000 * (i + 1), 4096);
+	steady_collect(sd, SEC_IN_NS);
+	TEST_ASSERT_EQ(sd->windows, 1);
+	TEST_ASSERT_EQ(sd->start, SEC_IN_NS);
+	TEST_ASSERT_EQ(sd->transient.frames, 10);
+	TEST_ASSERT_EQ(sd->transient.bytes, 10 * 4096);
+	TEST_ASSERT_EQ(sd->transient.lat.cnt, 10);
+	TEST_ASSERT_EQ(sd->transient.lat.sum, 55000000);
+	TEST_ASSERT(sd->hist[0].fps == 10);
+
+	/* Only frames since the previous window count */
+	steady_frame_done(&sd->slots[1], 1000000, 4096);
+	steady_collect(sd, SEC_IN_NS / 2);
+	TEST_ASSERT_EQ(sd->windows, 2);
+	TEST_ASSERT_EQ(sd->transient.frames, 11);
+	TEST_ASSERT_EQ(sd->transient.lat.cnt, 11);
+	TEST_ASSERT(sd->hist[1].fps == 2);
+
+	steady_free(sd);
+	free(sd);
+
+	return 0;
+}
+
+int test_steady(void)
+{
+	TEST_INIT();
+
+	TEST(steady_detect);
+	TEST(steady_lost);
+	TEST(steady_collect);
+
+	TEST_END();
+}
+
+TEST_MAIN(steady)
@@ -0,0 +1,92 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "sweep.c"
+#include <stdio.h>
+#include "unittest.h"
+
+int test_sweep_parse(void)
+{
+	sweep_t sw;
+
+	TEST_ASSERT_EQ(sweep_parse(&sw, "threads=1..32"), 0);
+	TEST_ASSERT_EQ(sw.threads.cnt, 6);
+	TEST_ASSERT_EQ(sw.threads.vals[0], 1);
+	TEST_ASSERT_EQ(sw.threads.vals[5], 32);
+	TEST_ASSERT_EQ(sw.size.cnt, 0);
+
+	TEST_ASSERT_EQ(sweep_parse(&sw, "threads=2..7+2,size=64k..1M"), 0);
+	TEST_ASSERT_EQ(sw.threads.cnt, 3);
+	TEST_ASSERT_EQ(sw.threads.vals[2], 6);
+	TEST_ASSERT_EQ(sw.size.cnt, 5);
+	TEST_ASSERT_EQ(sw.size.vals[0], 64 * 1024);
+	TEST_ASSERT_EQ(sw.size.vals[4], 1024 * 1024);
+
+	TEST_ASSERT_EQ(sweep_parse(&sw, "size=4096"), 0);
+	TEST_ASSERT_EQ(sw.size.cnt, 1);
+	TEST_ASSERT_EQ(sw.size.vals[0], 4096);
+	TEST_ASSERT_EQ(sw.threads.cnt, 0);
+
+	TEST_ASSERT_EQ(sweep_parse(&sw, ""), 1);
+	TEST_ASSERT_EQ(sweep_parse(&sw, "threads"), 1);
+	TEST_ASSERT_EQ(sweep_parse(&sw, "qd=1..4"), 1);
+	TEST_ASSERT_EQ(sweep_parse(&sw, "threads=0..4"), 1);
+	TEST_ASSERT_EQ(sweep_parse(&sw, "threads=8..4"), 1);
+	TEST_ASSERT_EQ(sweep_parse(&sw, "threads=1.4"), 1);
+	TEST_ASSERT_EQ(sweep_parse(&sw, "threads=1..4x"), 1);
+	TEST_ASSERT_EQ(sweep_parse(&sw, "threads=4k"), 1);
+	TEST_ASSERT_EQ(sweep_parse(&sw, "threads=1..100+1"), 1);
+	TEST_ASSERT_EQ(sweep_parse(NULL, "threads=1"), 1);
+
+	return 0;
+}
+
+int test_sweep_best(void)
+{
+	sweep_result_t res[] = {
+		{ .tcase = "write", .threads = 1, .mibps = 100, .p99 = 10 },
+		{ .tcase = "write", .threads = 2, .mibps = 300, .p99 = 50 },
+		{ .tcase = "write", .threads = 4, .mibps = 200, .p99 = 20 },
+		{ .tcase = "read", .threads = 1, .mibps = 900, .p99 = 5 },
+		{ .tcase = "write", .threads = 8, .mibps = 0, .p99 = 0 },
+	};
+	size_t cnt = sizeof(res) / sizeof(res[0]);
+
+	TEST_ASSERT_EQ(sweep_best(res, cnt, "write", 0), 1);
+	TEST_ASSERT_EQ(sweep_best(res, cnt, "write", 20), 2);
+	TEST_ASSERT_EQ(sweep_best(res, cnt, "write", 10), 0);
+	TEST_ASSERT_EQ(sweep_best(res, cnt, "write", 5), -1);
+	TEST_ASSERT_EQ(sweep_best(res, cnt, "read", 0), 3);
+	TEST_ASSERT_EQ(sweep_best(res, cnt, "empty", 0), -1);
+
+	return 0;
+}
+
+int test_sweep(void)
+{
+	TEST_INIT();
+
+	TEST(sweep_parse);
+	TEST(sweep_best);
+
+	TEST_END();
+}
+
+TEST_MAIN(sweep)
@@ -0,0 +1,123 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "telemetry.c"
+#include <stdio.h>
+#include "unittest.h"
+
+static FILE *telemetry_file(const char *content)
+{
+	FILE *f = tmpfile();
+
+	if (!f)
+		return NULL;
+	fputs(content, f);
+	rewind(f);
+
+	return f;
+}
+
+int test_telemetry_diskstats(void)
+{
+	telemetry_sample_t s = { 0 };
+	FILE *f;
+
+	f = telemetry_file(
+		"   8       0 sda 100 1 2000 30 400 5 6000 70 3 80 90 0 0 0 0\n"
+		"   8       1 sda1 10 0 200 3 40 0 600 7 1 8 9 0 0 0 0\n");
+	TEST_ASSERT(f);
+
+	TEST_ASSERT_EQ(telemetry_read_diskstats(f, 8, 1, &s), 0);
+	TEST_ASSERT_EQ(s.rd_ios, 10);
+	TEST_ASSERT_EQ(s.rd_sectors, 200);
+	TEST_ASSERT_EQ(s.wr_ios, 40);
+	TEST_ASSERT_EQ(s.wr_sectors, 600);
+	TEST_ASSERT_EQ(s.in_flight, 1);
+	TEST_ASSERT_EQ(s.io_ticks_ms, 8);
+	TEST_ASSERT_EQ(s.queue_ms, 9);
+
+	rewind(f);
+	TEST_ASSERT_EQ(telemetry_read_diskstats(f, 8, 0, &s), 0);
+	TEST_ASSERT_EQ(s.wr_sectors, 6000);
+
+	rewind(f);
+	TEST_ASSERT_EQ(telemetry_read_diskstats(f, 259, 0, &s), 1);
+	fclose(f);
+
+	return 0;
+}
+
+int test_telemetry_meminfo(void)
+{
+	telemetry_sample_t s = { 0 };
+	FILE *f;
+
+	f = telemetry_file("MemTotal:        5000000 kB\n"
+			   "Dirty:               1234 kB\n"
+			   "Writeback:             56 kB\n"
+			   "WritebackTmp:           7 kB\n");
+	TEST_ASSERT(f);
+	TEST_ASSERT_EQ(telemetry_read_meminfo(f, &s), 0);
+	TEST_ASSERT_EQ(s.dirty_kb, 1234);
+	TEST_ASSERT_EQ(s.writeback_kb, 56);
+	fclose(f);
+
+	f = telemetry_file("MemTotal:        5000000 kB\n");
+	TEST_ASSERT(f);
+	TEST_ASSERT_EQ(telemetry_read_meminfo(f, &s), 1);
+	fclose(f);
+
+	return 0;
+}
+
+int test_telemetry_psi(void)
+{
+	telemetry_sample_t s = { 0 };
+	FILE *f;
+
+	f = telemetry_file(
+		"some avg10=1.00 avg60=0.50 avg300=0.10 total=123456\n"
+		"full avg10=0.50 avg60=0.20 avg300=0.05 total=6543\n");
+	TEST_ASSERT(f);
+	TEST_ASSERT_EQ(telemetry_read_psi(f, &s), 0);
+	TEST_ASSERT_EQ(s.psi_some_us, 123456);
+	TEST_ASSERT_EQ(s.psi_full_us, 6543);
+	fclose(f);
+
+	f = telemetry_file("");
+	TEST_ASSERT(f);
+	TEST_ASSERT_EQ(telemetry_read_psi(f, &s), 1);
+	fclose(f);
+
+	return 0;
+}
+
+int test_telemetry(void)
+{
+	TEST_INIT();
+
+	TEST(telemetry_diskstats);
+	TEST(telemetry_meminfo);
+	TEST(telemetry_psi);
+
+	TEST_END();
+}
+
+TEST_MAIN(telemetry)
@@ -133,6 +133,8 @@ static int tester_run_write_read_with(const platform_t *platform,
 	platform_handle_t f;
 	frame_t *frm;
 	frame_t *frm_res;
+	unsigned int seen = 0;
+	size_t i;
 
 	frm = gen_default_frame(platform);
 	TEST_ASSERT(frm);
@@ -141,11 +143,17 @@ static int tester_run_write_read_with(const platform_t *platform,
 	TEST_ASSERT_EQ(f, -1);
 
 	res = tester_run_write(platform, ".", frm, 0, frames, fps, mode,
-			       TEST_FILES_MULTIPLE);
+			       TEST_FILES_MULTIPLE, NULL);
 
 	TEST_ASSERT_EQ(res.frames_written, frames);
 	TEST_ASSERT_EQ(res.bytes_written, frames * frm->size);
 	TEST_ASSERT(res.completion);
+	/* Every frame number is covered once, in any order */
+	for (i = 0; i < frames; i++)
+		seen |= 1U << res.completion[i].num;
+	TEST_ASSERT_EQ(seen, (1U << frames) - 1);
+	if (mode == TEST_MODE_REVERSE)
+		TEST_ASSERT_EQ(res.completion[0].num, frames - 1);
 
 	result_free(platform, &res);
 
@@ -157,7 +165,7 @@ static int tester_run_write_read_with(const platform_t *platform,
 	TEST_ASSERT(frm_res);
 
 	res_read = tester_run_read(platform, ".", frm_res, 0, frames, fps, mode,
-				   TEST_FILES_MULTIPLE);
+				   TEST_FILES_MULTIPLE, NULL);
 	TEST_ASSERT_EQ(res_read.frames_written, frames);
 	TEST_ASSERT_EQ(res_read.bytes_written, frames * frm_res->size);
 	TEST_ASSERT(res_read.completion);
@@ -217,7 +225,7 @@ int test_tester_run_write_read_single_file(void **state)
 	TEST_ASSERT_EQ(f, -1);
 
 	res = tester_run_write(platform, "./single", frm, 0, frames, 0,
-			       TEST_MODE_NORM, TEST_FILES_SINGLE);
+			       TEST_MODE_NORM, TEST_FILES_SINGLE, NULL);
 	TEST_ASSERT_EQ(res.frames_written, frames);
 	TEST_ASSERT_EQ(res.bytes_written, frames * frm->size);
 	TEST_ASSERT(res.completion);
@@ -231,7 +239,7 @@ int test_tester_run_write_read_single_file(void **state)
 	frm_res = gen_default_frame(platform);
 
 	res_read = tester_run_read(platform, ".", frm_res, 0, frames, 0,
-				   TEST_MODE_NORM, TEST_FILES_SINGLE);
+				   TEST_MODE_NORM, TEST_FILES_SINGLE, NULL);
 	TEST_ASSERT_EQ(res_read.frames_written, frames);
 	TEST_ASSERT_EQ(res_read.bytes_written, frames * frm_res->size);
 	TEST_ASSERT(res_read.completion);
@@ -244,6 +252,373 @@ int test_tester_run_write_read_single_file(void **state)
 	return 0;
 }
 
+int test_tester_run_write_trace(void **state)
+{
+	const platform_t *platform = *state;
+	const size_t frames = 5;
+	trace_writer_t *w;
+	trace_record_t rec;
+	test_ctx_t ctx = { 0 };
+	test_result_t res;
+	trace_t trace = { 0 };
+	frame_t *frm;
+	size_t i;
+
+	frm = gen_default_frame(platform);
+	TEST_ASSERT(frm);
+	w = malloc(sizeof(*w));
+	TEST_ASSERT(w);
+	trace.f = tmpfile();
+	TEST_ASSERT(trace.f);
+
+	trace_writer_init(w, &trace);
+	ctx.thread_id = 3;
+	ctx.trace = w;
+	res = tester_run_write(platform, "./single", frm, 10, frames, 0,
+			       TEST_MODE_REVERSE, TEST_FILES_SINGLE, &ctx);
+	TEST_ASSERT_EQ(res.frames_written, frames);
+	/* Everything is flushed at the end of the run */
+	TEST_ASSERT_EQ(w->cnt, 0);
+
+	rewind(trace.f);
+	for (i = 0; i < frames; i++) {
+		TEST_ASSERT_EQ(fread(&rec, sizeof(rec), 1, trace.f), 1);
+		TEST_ASSERT_EQ(rec.thread, 3);
+		TEST_ASSERT_EQ(rec.result, 0);
+		TEST_ASSERT_EQ(rec.frame, 10 + frames - 1 - i);
+		TEST_ASSERT_EQ(rec.offset, rec.frame * frm->size);
+		TEST_ASSERT(rec.start < rec.open);
+		TEST_ASSERT(rec.close < rec.end);
+	}
+	TEST_ASSERT_EQ(fread(&rec, sizeof(rec), 1, trace.f), 0);
+	TEST_ASSERT(!trace.error);
+
+	fclose(trace.f);
+	free(w);
+	result_free(platform, &res);
+	frame_destroy(platform, frm);
+
+	return 0;
+}
+
+int test_tester_run_write_cpu(void **state)
+{
+	const platform_t *platform = *state;
+	const size_t frames = 100;
+	test_ctx_t ctx = { 0 };
+	test_result_t res;
+	frame_t *frm;
+	size_t i;
+
+	frm = gen_default_frame(platform);
+	TEST_ASSERT(frm);
+
+	res = tester_run_write(platform, "./", frm, 0, frames, 0,
+			       TEST_MODE_NORM, TEST_FILES_MULTIPLE, &ctx);
+	TEST_ASSERT_EQ(res.frames_written, frames);
+	TEST_ASSERT_EQ(res.cpu_ns, 0);
+	TEST_ASSERT_EQ(res.completion[0].cpu, 0);
+	result_free(platform, &res);
+
+	ctx.cpu = 1;
+	res = tester_run_write(platform, "./", frm, 0, frames, 0,
+			       TEST_MODE_NORM, TEST_FILES_MULTIPLE, &ctx);
+	TEST_ASSERT_EQ(res.frames_written, frames);
+	TEST_ASSERT(res.cpu_ns > 0);
+	for (i = 0; i < frames; i++)
+		TEST_ASSERT(res.completion[i].cpu <= res.cpu_ns);
+
+	result_free(platform, &res);
+	frame_destroy(platform, frm);
+
+	return 0;
+}
+
+int test_tester_run_write_topk(void **state)
+{
+	const platform_t *platform = *state;
+	const size_t frames = 100;
+	test_ctx_t ctx = { 0 };
+	topk_frame_t out[5];
+	test_result_t res;
+	topk_t tk;
+	frame_t *frm;
+	uint64_t max = 0;
+	size_t i;
+
+	frm = gen_default_frame(platform);
+	TEST_ASSERT(frm);
+	TEST_ASSERT_EQ(topk_init(&tk, 5, 2), 0);
+
+	ctx.topk = &tk;
+	res = tester_run_write(platform, "./", frm, 0, frames, 0,
+			       TEST_MODE_NORM, TEST_FILES_MULTIPLE, &ctx);
+	TEST_ASSERT_EQ(res.frames_written, frames);
+	for (i = 0; i < frames; i++) {
+		const test_completion_t *c = &res.completion[i];
+		uint64_t lat = c->frame - c->start;
+
+		if (lat > max)
+			max = lat;
+	}
+
+	TEST_ASSERT_EQ(tk.cnt, 5);
+	TEST_ASSERT_EQ(topk_merge(&tk, 1, out, 5), 5);
+	TEST_ASSERT_EQ(out[0].lat, max);
+	TEST_ASSERT_EQ(out[0].thread, 2);
+	TEST_ASSERT(out[0].frame < frames);
+
+	topk_free(&tk);
+	result_free(platform, &res);
+	frame_destroy(platform, frm);
+
+	return 0;
+}
+
+int test_tester_run_write_duration(void **state)
+{
+	const platform_t *platform = *state;
+	test_ctx_t ctx = { 0 };
+	test_result_t res;
+	test_result_t tot = { 0 };
+	frame_t *frm;
+
+	frm = gen_default_frame(platform);
+	TEST_ASSERT(frm);
+
+	ctx.duration_ns = 20 * SEC_IN_MS;
+	res = tester_run_write(platform, "./", frm, 0, 10, 0, TEST_MODE_NORM,
+			       TEST_FILES_MULTIPLE, &ctx);
+	TEST_ASSERT(!res.completion);
+	TEST_ASSERT(res.stats);
+	TEST_ASSERT(res.time_taken_ns >= ctx.duration_ns);
+	TEST_ASSERT(res.frames_written > 0);
+	TEST_ASSERT_EQ(res.stats[COMP_FRAME].cnt, res.frames_written);
+	TEST_ASSERT_EQ(res.bytes_written, res.frames_written * frm->size);
+
+	TEST_ASSERT(!test_result_aggregate(&tot, &res));
+	TEST_ASSERT(!test_result_aggregate(&tot, &res));
+	TEST_ASSERT(tot.stats);
+	TEST_ASSERT_EQ(tot.stats[COMP_FRAME].cnt, 2 * res.frames_written);
+
+	result_free(platform, &tot);
+	result_free(platform, &res);
+	frame_destroy(platform, frm);
+
+	return 0;
+}
+
+int test_tester_pattern_parse(void)
+{
+	test_pattern_t pat;
+
+	TEST_ASSERT_EQ(tester_pattern_parse(&pat, "stride=4"), 0);
+	TEST_ASSERT_EQ(pat.stride, 4);
+	TEST_ASSERT(pat.speed == 1);
+	TEST_ASSERT_EQ(pat.segment, 0);
+
+	TEST_ASSERT_EQ(tester_pattern_parse(&pat, "seek=48,stride=-2,speed=2"),
+		       0);
+	TEST_ASSERT_EQ(pat.stride, -2);
+	TEST_ASSERT(pat.speed == 2);
+	TEST_ASSERT_EQ(pat.segment, 48);
+
+	TEST_ASSERT_EQ(tester_pattern_parse(&pat, "speed=2"), 0);
+	TEST_ASSERT_EQ(pat.stride, 1);
+
+	TEST_ASSERT_EQ(tester_pattern_parse(&pat, ""), 1);
+	TEST_ASSERT_EQ(tester_pattern_parse(&pat, "stride"), 1);
+	TEST_ASSERT_EQ(tester_pattern_parse(&pat, "stride=0"), 1);
+	TEST_ASSERT_EQ(tester_pattern_parse(&pat, "stride=2x"), 1);
+	TEST_ASSERT_EQ(tester_pattern_parse(&pat, "speed=-1"), 1);
+	TEST_ASSERT_EQ(tester_pattern_parse(&pat, "seek=0"), 1);
+	TEST_ASSERT_EQ(tester_pattern_parse(&pat, "jog=2"), 1);
+	TEST_ASSERT_EQ(tester_pattern_parse(NULL, "stride=1"), 1);
+
+	return 0;
+}
+
+int test_tester_pattern_frame(void)
+{
+	test_pattern_t pat = { .stride = 4, .speed = 1 };
+	size_t fwd[] = { 0, 4, 8, 2, 6, 1, 5, 9, 3, 7, 0 };
+	size_t shuttle[] = { 0, 4, 1, 5, 2, 6, 3, 7, 0 };
+	size_t rew[] = { 9, 7, 5, 3, 1, 8, 6, 4, 2, 0, 9 };
+	uint64_t rng = 42;
+	size_t pos = 0;
+	size_t off;
+	uint64_t n;
+	int seek;
+
+	/* Every frame once per loop, even when the stride divides them */
+	for (n = 0; n < sizeof(fwd) / sizeof(fwd[0]); n++) {
+		TEST_ASSERT_EQ(tester_pattern_frame(&pat, n, 10, &pos, &rng,
+						    &seek),
+			       fwd[n]);
+		TEST_ASSERT_EQ(seek, !n);
+	}
+	for (n = 0; n < sizeof(shuttle) / sizeof(shuttle[0]); n++)
+		TEST_ASSERT_EQ(tester_pattern_frame(&pat, n, 8, &pos, &rng,
+						    &seek),
+			       shuttle[n]);
+
+	pat.stride = -2;
+	pos = 9;
+	for (n = 0; n < sizeof(rew) / sizeof(rew[0]); n++)
+		TEST_ASSERT_EQ(tester_pattern_frame(&pat, n, 10, &pos, &rng,
+						    &seek),
+			       rew[n]);
+
+	/* Segments play on from a random frame */
+	pat.stride = 1;
+	pat.segment = 5;
+	for (n = 0; n < 50; n++) {
+		off = tester_pattern_frame(&pat, n, 100, &pos, &rng, &seek);
+		TEST_ASSERT(off < 100);
+		TEST_ASSERT_EQ(seek, n % 5 == 0);
+		TEST_ASSERT_EQ(off, (pos + n % 5) % 100);
+	}
+
+	return 0;
+}
+
+int test_tester_run_read_pattern(void **state)
+{
+	const platform_t *platform = *state;
+	test_pattern_t pat = { .stride = -1, .speed = 1, .segment = 4 };
+	test_ctx_t ctx = { 0 };
+	test_result_t res;
+	test_result_t tot = { 0 };
+	frame_t *frm;
+
+	frm = gen_default_frame(platform);
+	TEST_ASSERT(frm);
+
+	ctx.pattern = &pat;
+	res = tester_run_read(platform, "./", frm, 0, 10, 0, TEST_MODE_PATTERN,
+			      TEST_FILES_MULTIPLE, &ctx);
+	TEST_ASSERT_EQ(res.frames_written, 10);
+	TEST_ASSERT(res.seek);
+	TEST_ASSERT_EQ(res.seek[SEEK_FIRST].cnt, 3);
+	TEST_ASSERT_EQ(res.seek[SEEK_REST].cnt, 7);
+
+	TEST_ASSERT(!test_result_aggregate(&tot, &res));
+	TEST_ASSERT(tot.seek);
+	TEST_ASSERT_EQ(tot.seek[SEEK_FIRST].cnt, 3);
+	result_free(platform, &tot);
+	result_free(platform, &res);
+
+	/* Without a pattern frames are read in order */
+	ctx.pattern = NULL;
+	res = tester_run_read(platform, "./", frm, 0, 10, 0, TEST_MODE_PATTERN,
+			      TEST_FILES_MULTIPLE, &ctx);
+	TEST_ASSERT_EQ(res.frames_written, 10);
+	TEST_ASSERT(!res.seek);
+	TEST_ASSERT_EQ(res.completion[3].num, 3);
+	result_free(platform, &res);
+	frame_destroy(platform, frm);
+
+	return 0;
+}
+
+int test_tester_run_write_bursts(void **state)
+{
+	const platform_t *platform = *state;
+	test_ctx_t ctx = { 0 };
+	test_result_t res;
+	test_result_t tot = { 0 };
+	frame_t *frm;
+
+	frm = gen_default_frame(platform);
+	TEST_ASSERT(frm);
+
+	/* Three bursts of 10 ms, 20 ms idle between them */
+	ctx.on_ns = 10 * SEC_IN_MS;
+	ctx.off_ns = 20 * SEC_IN_MS;
+	ctx.duration_ns = 3 * (ctx.on_ns + ctx.off_ns) - ctx.off_ns;
+	res = tester_run_write(platform, "./", frm, 0, 10, 0, TEST_MODE_NORM,
+			       TEST_FILES_MULTIPLE, &ctx);
+	TEST_ASSERT(res.stats);
+	TEST_ASSERT(res.burst);
+	TEST_ASSERT(res.time_taken_ns >= 2 * (ctx.on_ns + ctx.off_ns));
+	TEST_ASSERT_EQ(res.burst[BURST_FIRST].cnt, 2);
+	TEST_ASSERT_EQ(res.burst[BURST_FIRST].cnt + res.burst[BURST_REST].cnt,
+		       res.frames_written);
+
+	TEST_ASSERT(!test_result_aggregate(&tot, &res));
+	TEST_ASSERT(tot.burst);
+	TEST_ASSERT_EQ(tot.burst[BURST_FIRST].cnt, 2);
+
+	result_free(platform, &tot);
+	result_free(platform, &res);
+	frame_destroy(platform, frm);
+
+	return 0;
+}
+
+int test_tester_run_write_open_loop(void **state)
+{
+	const platform_t *platform = *state;
+	const uint64_t budget = SEC_IN_NS / 100;
+	test_ctx_t ctx = { 0 };
+	test_result_t res;
+	frame_t *frm;
+	size_t i;
+
+	frm = gen_default_frame(platform);
+	TEST_ASSERT(frm);
+
+	/* Frames are due on the schedule from the start of the run */
+	ctx.sched = SCHED_FIXED;
+	res = tester_run_write(platform, "./", frm, 0, 5, 100, TEST_MODE_NORM,
+			       TEST_FILES_MULTIPLE, &ctx);
+	TEST_ASSERT_EQ(res.frames_written, 5);
+	for (i = 0; i < 5; i++) {
+		const test_completion_t *c = &res.completion[i];
+
+		TEST_ASSERT_EQ(c->sched, res.started + i * budget);
+		TEST_ASSERT(c->start >= c->sched);
+		TEST_ASSERT_EQ(completion_value(c, COMP_SCHED),
+			       c->frame - c->sched);
+	}
+	TEST_ASSERT(res.time_taken_ns >= 4 * budget);
+	TEST_ASSERT(res.late <= res.frames_written);
+	result_free(platform, &res);
+
+	/* The whole burst is due at once */
+	ctx.sched = SCHED_BURST;
+	ctx.burst = 5;
+	res = tester_run_write(platform, "./", frm, 0, 5, 100, TEST_MODE_NORM,
+			       TEST_FILES_MULTIPLE, &ctx);
+	TEST_ASSERT_EQ(res.frames_written, 5);
+	for (i = 0; i < 5; i++)
+		TEST_ASSERT_EQ(res.completion[i].sched, res.started);
+	TEST_ASSERT(res.time_taken_ns < 4 * budget);
+	result_free(platform, &res);
+
+	ctx.sched = SCHED_POISSON;
+	res = tester_run_write(platform, "./", frm, 0, 5, 100, TEST_MODE_NORM,
+			       TEST_FILES_MULTIPLE, &ctx);
+	TEST_ASSERT_EQ(res.frames_written, 5);
+	TEST_ASSERT_EQ(res.completion[0].sched, res.started);
+	for (i = 1; i < 5; i++)
+		TEST_ASSERT(res.completion[i].sched >=
+			    res.completion[i - 1].sched);
+	result_free(platform, &res);
+
+	/* Closed loop has no schedule, latency is from the start */
+	ctx.sched = SCHED_CLOSED;
+	res = tester_run_write(platform, "./", frm, 0, 5, 100, TEST_MODE_NORM,
+			       TEST_FILES_MULTIPLE, &ctx);
+	TEST_ASSERT_EQ(res.completion[1].sched, 0);
+	TEST_ASSERT_EQ(completion_value(&res.completion[1], COMP_SCHED),
+		       completion_value(&res.completion[1], COMP_FRAME));
+	result_free(platform, &res);
+	frame_destroy(platform, frm);
+
+	return 0;
+}
+
 int test_tester_result_aggregate(void)
 {
 	test_result_t a = { 0 };
@@ -257,6 +632,7 @@ int test_tester_result_aggregate(void)
 	b.frames_written = 42;
 	b.bytes_written = 111111;
 	b.time_taken_ns = 0x01010101;
+	b.late = 3;
 
 	TEST_ASSERT(!test_result_aggregate(&c, &a));
 	TEST_ASSERT_EQ(a.frames_written, 100);
@@ -268,6 +644,40 @@ int test_tester_result_aggregate(void)
 	TEST_ASSERT_EQ(a.frames_written + b.frames_written, c.frames_written);
 	TEST_ASSERT_EQ(a.bytes_written + b.bytes_written, c.bytes_written);
 	TEST_ASSERT_EQ(a.time_taken_ns + b.time_taken_ns, c.time_taken_ns);
+	TEST_ASSERT_EQ(c.late, 3);
+
+	return 0;
+}
+
+int test_tester_result_trim(void)
+{
+	test_completion_t comp[5] = { 0 };
+	test_result_t res = { 0 };
+	size_t i;
+
+	for (i = 0; i < 5; i++) {
+		comp[i].start = 100 + i * 10;
+		comp[i].frame = comp[i].start + 10;
+		comp[i].num = i;
+	}
+	res.completion = comp;
+	res.frames_written = 5;
+	res.bytes_written = 5 * 4096;
+	res.time_taken_ns = 60;
+
+	/* Frames overlapping either edge are dropped too */
+	tester_result_trim(&res, 105, 135);
+	TEST_ASSERT_EQ(res.frames_written, 2);
+	TEST_ASSERT_EQ(res.bytes_written, 2 * 4096);
+	TEST_ASSERT_EQ(res.time_taken_ns, 30);
+	TEST_ASSERT_EQ(res.completion[0].num, 1);
+	TEST_ASSERT_EQ(res.completion[1].num, 2);
+	TEST_ASSERT_EQ(res.started, 110);
+	TEST_ASSERT_EQ(res.finished, 130);
+
+	tester_result_trim(&res, 200, 300);
+	TEST_ASSERT_EQ(res.frames_written, 0);
+	TEST_ASSERT_EQ(res.bytes_written, 0);
 
 	return 0;
 }
@@ -281,7 +691,17 @@ int test_tester(void)
 	TESTF(tester_run_write_read_reverse, test_setup, test_teardown);
 	TESTF(tester_run_write_read_random, test_setup, test_teardown);
 	TESTF(tester_run_write_read_single_file, test_setup, test_teardown);
+	TESTF(tester_run_write_trace, test_setup, test_teardown);
+	TESTF(tester_run_write_cpu, test_setup, test_teardown);
+	TESTF(tester_run_write_topk, test_setup, test_teardown);
+	TESTF(tester_run_write_duration, test_setup, test_teardown);
+	TESTF(tester_run_write_open_loop, test_setup, test_teardown);
+	TESTF(tester_run_write_bursts, test_setup, test_teardown);
+	TEST(tester_pattern_parse);
+	TEST(tester_pattern_frame);
+	TESTF(tester_run_read_pattern, test_setup, test_teardown);
 	TEST(tester_result_aggregate);
+	TEST(tester_result_trim);
 	TESTF(tester_run_write_read_fps, test_setup, test_teardown);
 
 	TEST_END();
@@ -0,0 +1,97 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "timing.c"
+#include <stdio.h>
+#include "unittest.h"
+
+static int timing_check_monotonic(void)
+{
+	uint64_t prev;
+	size_t i;
+
+	prev = timing_time();
+	for (i = 0; i < 100000; i++) {
+		uint64_t now = timing_time();
+
+		TEST_ASSERT(now >= prev);
+		prev = now;
+	}
+
+	return 0;
+}
+
+int test_timing_clock(void)
+{
+	timing_info_t info;
+
+	TEST_ASSERT_EQ(timing_init(TIMING_CLOCK), TIMING_CLOCK);
+	timing_get_info(&info);
+	TEST_ASSERT_EQ(info.source, TIMING_CLOCK);
+	TEST_ASSERT(info.name);
+	TEST_ASSERT(info.cost_ns > 0);
+	TEST_ASSERT(info.tsc_hz == 0);
+
+	return timing_check_monotonic();
+}
+
+int test_timing_auto(void)
+{
+	timing_info_t info;
+	uint64_t tsc_start;
+	uint64_t clock_start;
+	uint64_t tsc_elapsed;
+	uint64_t clock_elapsed;
+
+	/* Falls back to clock if there's no usable TSC */
+	timing_init(TIMING_AUTO);
+	timing_get_info(&info);
+	if (info.source != TIMING_TSC)
+		return timing_check_monotonic();
+
+	TEST_ASSERT(info.tsc_hz > 0);
+	if (timing_check_monotonic())
+		return 1;
+
+	/* Calibrated TSC should follow the monotonic clock closely */
+	tsc_start = timing_time();
+	clock_start = timing_clock_time();
+	do {
+		clock_elapsed = timing_clock_time() - clock_start;
+	} while (clock_elapsed < 50 * SEC_IN_MS);
+	tsc_elapsed = timing_time() - tsc_start;
+
+	TEST_ASSERT(tsc_elapsed > clock_elapsed - clock_elapsed / 100);
+	TEST_ASSERT(tsc_elapsed < clock_elapsed + clock_elapsed / 100);
+
+	return 0;
+}
+
+int test_timing(void)
+{
+	TEST_INIT();
+
+	TEST(timing_clock);
+	TEST(timing_auto);
+
+	TEST_END();
+}
+
+TEST_MAIN(timing)
@@ -0,0 +1,136 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "topk.c"
+#include <stdio.h>
+#include "unittest.h"
+
+static void topk_add_lat(topk_t *tk, size_t frame, uint64_t lat)
+{
+	test_completion_t comp = { 0 };
+
+	comp.start = 1000 * frame;
+	comp.open = comp.start + 1;
+	comp.io = comp.start + lat - 1;
+	comp.close = comp.start + lat;
+	comp.frame = comp.start + lat;
+	topk_add(tk, frame, 0, &comp);
+}
+
+int test_topk_heap(void)
+{
+	const uint64_t lats[] = { 5, 90, 3, 70, 8, 100, 1, 60, 2, 80 };
+	topk_frame_t out[4];
+	topk_t tk;
+	size_t i;
+
+	TEST_ASSERT_EQ(topk_init(&tk, 4, 0), 0);
+	for (i = 0; i < sizeof(lats) / sizeof(lats[0]); i++)
+		topk_add_lat(&tk, i, lats[i]);
+	topk_flush(&tk);
+
+	TEST_ASSERT_EQ(tk.cnt, 4);
+	/* Fastest of the slowest is at the root */
+	TEST_ASSERT_EQ(tk.heap[0].lat, 70);
+
+	TEST_ASSERT_EQ(topk_merge(&tk, 1, out, 4), 4);
+	TEST_ASSERT_EQ(out[0].lat, 100);
+	TEST_ASSERT_EQ(out[0].frame, 5);
+	TEST_ASSERT_EQ(out[1].lat, 90);
+	TEST_ASSERT_EQ(out[2].lat, 80);
+	TEST_ASSERT_EQ(out[3].lat, 70);
+
+	topk_free(&tk);
+	return 0;
+}
+
+int test_topk_neighbours(void)
+{
+	const uint64_t lats[] = { 10, 11, 12, 500, 13, 14, 15, 400 };
+	topk_frame_t out[2];
+	topk_t tk;
+	size_t i;
+
+	TEST_ASSERT_EQ(topk_init(&tk, 2, 3), 0);
+	for (i = 0; i < sizeof(lats) / sizeof(lats[0]); i++)
+		topk_add_lat(&tk, i, lats[i]);
+	topk_flush(&tk);
+
+	TEST_ASSERT_EQ(topk_merge(&tk, 1, out, 2), 2);
+	TEST_ASSERT_EQ(out[0].lat, 500);
+	TEST_ASSERT_EQ(out[0].thread, 3);
+	TEST_ASSERT_EQ(out[0].prev[0], 12);
+	TEST_ASSERT_EQ(out[0].prev[1], 11);
+	TEST_ASSERT_EQ(out[0].next[0], 13);
+	TEST_ASSERT_EQ(out[0].next[1], 14);
+	TEST_ASSERT_EQ(out[0].comp.io - out[0].comp.open, 498);
+
+	/* Last frame has no following neighbours */
+	TEST_ASSERT_EQ(out[1].lat, 400);
+	TEST_ASSERT_EQ(out[1].prev[0], 15);
+	TEST_ASSERT_EQ(out[1].next[0], 0);
+	TEST_ASSERT_EQ(out[1].next[1], 0);
+
+	topk_free(&tk);
+	return 0;
+}
+
+int test_topk_merge(void)
+{
+	topk_frame_t out[3];
+	topk_t tk[2];
+
+	TEST_ASSERT_EQ(topk_init(&tk[0], 3, 0), 0);
+	TEST_ASSERT_EQ(topk_init(&tk[1], 3, 1), 0);
+	topk_add_lat(&tk[0], 0, 30);
+	topk_add_lat(&tk[0], 1, 10);
+	topk_add_lat(&tk[1], 0, 40);
+	topk_add_lat(&tk[1], 1, 20);
+	topk_add_lat(&tk[1], 2, 5);
+	topk_flush(&tk[0]);
+	topk_flush(&tk[1]);
+
+	TEST_ASSERT_EQ(topk_merge(tk, 2, out, 3), 3);
+	TEST_ASSERT_EQ(out[0].lat, 40);
+	TEST_ASSERT_EQ(out[0].thread, 1);
+	TEST_ASSERT_EQ(out[1].lat, 30);
+	TEST_ASSERT_EQ(out[1].thread, 0);
+	TEST_ASSERT_EQ(out[2].lat, 20);
+	/* Short run, neighbours that do not exist are zero */
+	TEST_ASSERT_EQ(out[1].prev[0], 0);
+	TEST_ASSERT_EQ(out[1].next[0], 10);
+
+	topk_free(&tk[0]);
+	topk_free(&tk[1]);
+	return 0;
+}
+
+int test_topk(void)
+{
+	TEST_INIT();
+
+	TEST(topk_heap);
+	TEST(topk_neighbours);
+	TEST(topk_merge);
+
+	TEST_END();
+}
+
+TEST_MAIN(topk)
@@ -0,0 +1,121 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "watchdog.c"
+#include <stdio.h>
+#include "unittest.h"
+
+static size_t watchdog_read(FILE *f, char *buf, size_t len)
+{
+	size_t cnt;
+
+	rewind(f);
+	cnt = fread(buf, 1, len - 1, f);
+	buf[cnt] = 0;
+
+	return cnt;
+}
+
+int test_watchdog_copy(void)
+{
+	FILE *in = tmpfile();
+	FILE *out = tmpfile();
+	char buf[256];
+
+	TEST_ASSERT(in);
+	TEST_ASSERT(out);
+	fputs("io_schedule", in);
+	rewind(in);
+
+	/* Missing trailing newline, as in wchan */
+	TEST_ASSERT_EQ(watchdog_copy(in, out, "  "), 0);
+	watchdog_read(out, buf, sizeof(buf));
+	TEST_ASSERT(!strcmp(buf, "  io_schedule\n"));
+
+	/* Empty file */
+	fclose(in);
+	in = tmpfile();
+	TEST_ASSERT(in);
+	TEST_ASSERT_EQ(watchdog_copy(in, out, "  "), 1);
+
+	fclose(in);
+	fclose(out);
+	return 0;
+}
+
+int test_watchdog_check(void)
+{
+	test_completion_t comp = { 0 };
+	opts_t opts = { 0 };
+	watchdog_t wd;
+	char buf[4096];
+	FILE *out = tmpfile();
+
+	TEST_ASSERT(out);
+	opts.threads = 2;
+	opts.path = "/nonexistent";
+	opts.watchdog_ns = 1000;
+	TEST_ASSERT_EQ(watchdog_init(&wd, NULL, &opts, "write"), 0);
+	wd.out = out;
+
+	/* Idle workers and short frames are fine */
+	TEST_ASSERT_EQ(watchdog_check(&wd, 10000), 0);
+	watchdog_frame_start(&wd.slots[1], 42, &comp, 9500);
+	TEST_ASSERT_EQ(watchdog_check(&wd, 10000), 0);
+
+	/* Stuck in open */
+	TEST_ASSERT_EQ(watchdog_check(&wd, 20000), 1);
+	watchdog_read(out, buf, sizeof(buf));
+	TEST_ASSERT(strstr(buf, "thread 1"));
+	TEST_ASSERT(strstr(buf, "frame 42"));
+	TEST_ASSERT(strstr(buf, "frame000042.tst"));
+	TEST_ASSERT(strstr(buf, "in open"));
+
+	/* Reported only once */
+	TEST_ASSERT_EQ(watchdog_check(&wd, 30000), 0);
+
+	/* Next frame stuck in io */
+	comp.open = 40000;
+	watchdog_frame_start(&wd.slots[1], 43, &comp, 40000);
+	TEST_ASSERT_EQ(watchdog_check(&wd, 50000), 1);
+	watchdog_read(out, buf, sizeof(buf));
+	TEST_ASSERT(strstr(buf, "frame 43"));
+	TEST_ASSERT(strstr(buf, "in io"));
+
+	watchdog_frame_end(&wd.slots[1]);
+	TEST_ASSERT_EQ(watchdog_check(&wd, 60000), 0);
+	TEST_ASSERT_EQ(wd.stalls, 2);
+
+	watchdog_free(&wd);
+	fclose(out);
+	return 0;
+}
+
+int test_watchdog(void)
+{
+	TEST_INIT();
+
+	TEST(watchdog_copy);
+	TEST(watchdog_check);
+
+	TEST_END();
+}
+
+TEST_MAIN(watchdog)
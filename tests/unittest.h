@@ -57,6 +57,8 @@ extern unsigned long unittest_asserts;
 const platform_t * test_platform_get(void);
 void test_platform_finalize(void);
 void test_ignore_printf(int val);
+/* Collects the output into buf until called with NULL */
+void test_capture_printf(char *buf, size_t size);
 
 #define RUN_TEST(NAME)\
 	extern int test_ ## NAME (void);\
@@ -0,0 +1,203 @@
+/*
+ * tframetrace - Convert and summarise tframetest binary frame traces
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frametest.h"
+#include "stats.h"
+#include "trace.h"
+
+#define OP_CNT 2
+
+typedef struct trace_summary_t {
+	uint64_t frames;
+	uint64_t failed;
+	uint64_t first;
+	uint64_t last;
+	stats_t lat;
+} trace_summary_t;
+
+static const char *op_name(uint16_t op)
+{
+	return op == TRACE_OP_READ ? "read" : "write";
+}
+
+static int trace_csv(FILE *f)
+{
+	trace_record_t rec[TRACE_BUFFER_RECORDS];
+	size_t cnt;
+
+	printf("thread,op,frame,offset,start,open,io,close,end,result\n");
+	while ((cnt = fread(rec, sizeof(*rec), TRACE_BUFFER_RECORDS, f))) {
+		size_t i;
+
+		for (i = 0; i < cnt; i++) {
+			printf("%" PRIu32 ",%s,%" PRIu64 ",%" PRIu64
+			       ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+			       ",%" PRIu64 ",%u\n",
+			       rec[i].thread, op_name(rec[i].op), rec[i].frame,
+			       rec[i].offset, rec[i].start, rec[i].open,
+			       rec[i].io, rec[i].close, rec[i].end,
+			       (unsigned int)rec[i].result);
+		}
+	}
+
+	return ferror(f) ? 1 : 0;
+}
+
+static void summary_print(const char *label, const trace_summary_t *sum,
+			  uint64_t frame_size)
+{
+	double secs;
+
+	if (!sum->frames && !sum->failed)
+		return;
+
+	secs = (double)(sum->last - sum->first) / SEC_IN_NS;
+	printf("%s: frames %" PRIu64 ", failed %" PRIu64, label, sum->frames,
+	       sum->failed);
+	if (secs > 0)
+		printf(", %lf fps, %lf MiB/s", sum->frames / secs,
+		       (double)sum->frames * frame_size / (1024 * 1024) / secs);
+	printf("\n");
+	printf("  latency ms: min %lf, avg %lf, p50 %lf, p99 %lf, max %lf\n",
+	       (double)(sum->lat.cnt ? sum->lat.min : 0) / SEC_IN_MS,
+	       stats_mean(&sum->lat) / SEC_IN_MS,
+	       (double)stats_percentile(&sum->lat, 50) / SEC_IN_MS,
+	       (double)stats_percentile(&sum->lat, 99) / SEC_IN_MS,
+	       (double)sum->lat.max / SEC_IN_MS);
+}
+
+static int trace_summary(FILE *f, const trace_header_t *hdr)
+{
+	trace_record_t rec[TRACE_BUFFER_RECORDS];
+	trace_summary_t *sums;
+	trace_summary_t *total;
+	size_t threads = hdr->threads ? hdr->threads : 1;
+	size_t cnt;
+	size_t i;
+	int op;
+
+	/* Per thread and op, followed by totals per op */
+	sums = calloc((threads + 1) * OP_CNT, sizeof(*sums));
+	if (!sums)
+		return 1;
+	for (i = 0; i < (threads + 1) * OP_CNT; i++) {
+		stats_init(&sums[i].lat);
+		sums[i].first = UINT64_MAX;
+	}
+	total = &sums[threads * OP_CNT];
+
+	while ((cnt = fread(rec, sizeof(*rec), TRACE_BUFFER_RECORDS, f))) {
+		for (i = 0; i < cnt; i++) {
+			size_t t = rec[i].thread < threads ? rec[i].thread : 0;
+			size_t o = rec[i].op < OP_CNT ? rec[i].op : 0;
+			trace_summary_t *s[2];
+			size_t j;
+
+			s[0] = &sums[t * OP_CNT + o];
+			s[1] = &total[o];
+			for (j = 0; j < 2; j++) {
+				if (rec[i].result) {
+					++s[j]->failed;
+					continue;
+				}
+				++s[j]->frames;
+				stats_add(&s[j]->lat,
+					  rec[i].end - rec[i].start);
+				if (rec[i].start < s[j]->first)
+					s[j]->first = rec[i].start;
+				if (rec[i].end > s[j]->last)
+					s[j]->last = rec[i].end;
+			}
+		}
+	}
+
+	printf("Frame size: %" PRIu64 "\n", hdr->frame_size);
+	for (op = 0; op < OP_CNT; op++) {
+		char label[64];
+
+		for (i = 0; i < threads; i++) {
+			snprintf(label, sizeof(label), "%s thread %zu",
+				 op_name(op), i);
+			summary_print(label, &sums[i * OP_CNT + op],
+				      hdr->frame_size);
+		}
+		snprintf(label, sizeof(label), "%s total", op_name(op));
+		summary_print(label, &total[op], hdr->frame_size);
+	}
+	free(sums);
+
+	return ferror(f) ? 1 : 0;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [--summary] trace-file\n", name);
+	fprintf(stderr, "Convert tframetest --frame-trace output to CSV,\n");
+	fprintf(stderr, "or print per thread summary with --summary\n");
+}
+
+int main(int argc, char **argv)
+{
+	trace_header_t hdr;
+	const char *fname = NULL;
+	int summary = 0;
+	int res;
+	int i;
+	FILE *f;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--summary") || !strcmp(argv[i], "-s"))
+			summary = 1;
+		else if (!fname)
+			fname = argv[i];
+		else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if (!fname) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	f = fopen(fname, "rb");
+	if (!f) {
+		fprintf(stderr, "Can't open %s\n", fname);
+		return 1;
+	}
+	if (trace_read_header(f, &hdr)) {
+		fprintf(stderr, "%s: not a supported frame trace\n", fname);
+		fclose(f);
+		return 1;
+	}
+
+	if (summary)
+		res = trace_summary(f, &hdr);
+	else
+		res = trace_csv(f);
+	fclose(f);
+
+	return res;
+}
@@ -0,0 +1,206 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "timeline.h"
+
+timeline_t *timeline_open(const char *fname)
+{
+	timeline_t *tl;
+
+	if (!fname)
+		return NULL;
+
+	tl = calloc(1, sizeof(*tl));
+	if (!tl)
+		return NULL;
+
+	tl->f = fopen(fname, "w");
+	if (!tl->f) {
+		free(tl);
+		return NULL;
+	}
+
+	fprintf(tl->f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	return tl;
+}
+
+int timeline_close(timeline_t *tl)
+{
+	int res;
+
+	if (!tl)
+		return 0;
+
+	fprintf(tl->f, "\n]}\n");
+	res = tl->error || ferror(tl->f);
+	if (fclose(tl->f))
+		res = 1;
+	free(tl);
+
+	return res;
+}
+
+/* Events are comma separated, without one after the last */
+static inline const char *timeline_sep(timeline_t *tl)
+{
+	return tl->events++ ? ",\n" : "";
+}
+
+/* Trace event timestamps are in microseconds */
+static inline double timeline_us(const timeline_t *tl, uint64_t ns)
+{
+	return ns > tl->base ? (double)(ns - tl->base) / 1000 : 0;
+}
+
+static void timeline_slice(timeline_t *tl, size_t pid, size_t tid,
+			   const char *name, uint64_t start, uint64_t end)
+{
+	if (!start || end < start)
+		return;
+
+	fprintf(tl->f,
+		"%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%zu,\"tid\":%zu,"
+		"\"ts\":%.3lf,\"dur\":%.3lf}",
+		timeline_sep(tl), name, pid, tid, timeline_us(tl, start),
+		(double)(end - start) / 1000);
+}
+
+static void timeline_frames(timeline_t *tl, size_t pid, size_t tid,
+			    const test_result_t *res)
+{
+	uint64_t i;
+
+	fprintf(tl->f,
+		"%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%zu,"
+		"\"tid\":%zu,\"args\":{\"name\":\"thread %zu\"}}",
+		timeline_sep(tl), pid, tid, tid);
+
+	for (i = 0; i < res->frames_written; i++) {
+		const test_completion_t *c = &res->completion[i];
+
+		fprintf(tl->f,
+			"%s{\"name\":\"frame\",\"ph\":\"X\",\"pid\":%zu,"
+			"\"tid\":%zu,\"ts\":%.3lf,\"dur\":%.3lf,"
+			"\"args\":{\"n\":%" PRIu64 "}}",
+			timeline_sep(tl), pid, tid, timeline_us(tl, c->start),
+			(double)(c->frame - c->start) / 1000, i);
+		timeline_slice(tl, pid, tid, "open", c->start, c->open);
+		timeline_slice(tl, pid, tid, "io", c->open, c->io);
+		timeline_slice(tl, pid, tid, "close", c->io, c->close);
+	}
+}
+
+static int timeline_counters(timeline_t *tl, size_t pid,
+			     const test_result_t *thread_res, size_t threads,
+			     uint64_t frame_size, uint64_t start,
+			     uint64_t end)
+{
+	uint64_t *cnts;
+	uint64_t step;
+	size_t points;
+	size_t i;
+
+	if (end <= start)
+		return 0;
+
+	step = (end - start) / TIMELINE_COUNTER_POINTS;
+	if (step < SEC_IN_MS)
+		step = SEC_IN_MS;
+	points = (end - start) / step + 1;
+
+	cnts = calloc(points, sizeof(*cnts));
+	if (!cnts)
+		return 1;
+
+	for (i = 0; i < threads; i++) {
+		const test_result_t *res = &thread_res[i];
+		uint64_t j;
+
+		for (j = 0; j < res->frames_written; j++) {
+			uint64_t t = res->completion[j].frame;
+
+			if (t >= start && t <= end)
+				++cnts[(t - start) / step];
+		}
+	}
+
+	for (i = 0; i < points; i++) {
+		double fps = (double)cnts[i] * SEC_IN_NS / step;
+
+		fprintf(tl->f,
+			"%s{\"name\":\"throughput\",\"ph\":\"C\",\"pid\":%zu,"
+			"\"ts\":%.3lf,\"args\":{\"fps\":%.3lf,"
+			"\"MiB/s\":%.3lf}}",
+			timeline_sep(tl), pid,
+			timeline_us(tl, start + i * step), fps,
+			fps * frame_size / (1024 * 1024));
+	}
+	free(cnts);
+
+	return 0;
+}
+
+int timeline_add(timeline_t *tl, const char *tcase,
+		 const test_result_t *thread_res, size_t threads,
+		 uint64_t frame_size)
+{
+	uint64_t start = 0;
+	uint64_t end = 0;
+	size_t pid;
+	size_t i;
+
+	if (!tl || !thread_res)
+		return 1;
+
+	for (i = 0; i < threads; i++) {
+		const test_result_t *res = &thread_res[i];
+
+		if (res->started && (!start || res->started < start))
+			start = res->started;
+		if (res->finished > end)
+			end = res->finished;
+	}
+	if (!tl->tests)
+		tl->base = start;
+
+	pid = ++tl->tests;
+	fprintf(tl->f,
+		"%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%zu,"
+		"\"args\":{\"name\":\"%s\"}}",
+		timeline_sep(tl), pid, tcase);
+	fprintf(tl->f,
+		"%s{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%zu,"
+		"\"args\":{\"sort_index\":%zu}}",
+		timeline_sep(tl), pid, pid);
+
+	for (i = 0; i < threads; i++)
+		timeline_frames(tl, pid, i, &thread_res[i]);
+
+	if (timeline_counters(tl, pid, thread_res, threads, frame_size, start,
+			      end))
+		tl->error = 1;
+
+	return tl->error;
+}
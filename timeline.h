@@ -0,0 +1,53 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_TIMELINE_H
+#define FRAMETEST_TIMELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "frametest.h"
+
+/*
+ * Timeline in Chrome trace-event JSON format, loadable in chrome://tracing
+ * and Perfetto UI. Every test case is a process and every test thread a
+ * thread in it, with a slice per frame and sub-slices for open, io and
+ * close. Each test case also gets a throughput counter track.
+ */
+#define TIMELINE_COUNTER_POINTS 500
+
+typedef struct timeline_t {
+	FILE *f;
+	size_t tests;
+	size_t events;
+	/* Timestamps are relative to the start of the first test */
+	uint64_t base;
+	int error;
+} timeline_t;
+
+timeline_t *timeline_open(const char *fname);
+int timeline_close(timeline_t *tl);
+
+int timeline_add(timeline_t *tl, const char *tcase,
+		 const test_result_t *thread_res, size_t threads,
+		 uint64_t frame_size);
+
+#endif
@@ -30,18 +30,207 @@
 #include "frametest.h"
 #include "timing.h"
 
-uint64_t timing_time(void)
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TIMING_HAVE_TSC 1
+#include <cpuid.h>
+#endif
+
+/* Busy wait used to calibrate TSC against the monotonic clock */
+#define TIMING_CALIBRATE_NS (20 * SEC_IN_MS)
+#define TIMING_MEASURE_CNT 10000
+/* Short sleeps taken to find the typical oversleep, odd for the median */
+#define TIMING_SLEEP_CNT 9
+#define TIMING_SLEEP_NS 1000
+
+static enum TimingSource timing_source = TIMING_CLOCK;
+static clockid_t timing_clock = CLOCK_MONOTONIC;
+static timing_info_t timing_info = { TIMING_CLOCK, "clock", 0, 0, 0, 0 };
+
+static inline uint64_t timing_clock_time(void)
 {
 	struct timespec ts;
 	uint64_t res;
 
-	if (clock_gettime(CLOCK_MONOTONIC, &ts)) {
-		if (clock_gettime(CLOCK_REALTIME, &ts)) {
-			return 0;
-		}
-	}
+	if (clock_gettime(timing_clock, &ts))
+		return 0;
 	res = (uint64_t)ts.tv_sec * SEC_IN_NS;
 	res += ts.tv_nsec;
 
 	return res;
 }
+
+#ifdef TIMING_HAVE_TSC
+static int timing_tscp;
+static uint64_t timing_tsc_base;
+static uint64_t timing_tsc_base_ns;
+static double timing_ns_per_tick;
+
+static inline uint64_t timing_rdtsc(void)
+{
+	uint32_t lo;
+	uint32_t hi;
+
+	/* RDTSCP waits for earlier instructions, so prefer it */
+	if (timing_tscp)
+		__asm__ __volatile__("rdtscp" : "=a"(lo), "=d"(hi) : : "ecx");
+	else
+		__asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+
+	return ((uint64_t)hi << 32) | lo;
+}
+
+static int timing_tsc_invariant(void)
+{
+	unsigned int eax;
+	unsigned int ebx;
+	unsigned int ecx;
+	unsigned int edx;
+
+	if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx))
+		return 0;
+	if (eax < 0x80000007)
+		return 0;
+
+	if (__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx))
+		timing_tscp = (edx >> 27) & 1;
+
+	/* Invariant TSC ticks at constant rate in all P-, C- and T-states */
+	if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+		return 0;
+
+	return (edx >> 8) & 1;
+}
+
+static int timing_tsc_calibrate(void)
+{
+	uint64_t tsc0;
+	uint64_t tsc1;
+	uint64_t ns0;
+	uint64_t ns1;
+	double hz;
+
+	tsc0 = timing_rdtsc();
+	ns0 = timing_clock_time();
+	do {
+		ns1 = timing_clock_time();
+	} while (ns1 - ns0 < TIMING_CALIBRATE_NS && ns1 >= ns0);
+	tsc1 = timing_rdtsc();
+
+	if (!ns0 || ns1 <= ns0 || tsc1 <= tsc0)
+		return 1;
+
+	hz = (double)(tsc1 - tsc0) * SEC_IN_NS / (ns1 - ns0);
+	/* Anything outside 100 MHz - 20 GHz can't be right */
+	if (hz < 1e8 || hz > 2e10)
+		return 1;
+
+	timing_ns_per_tick = (double)SEC_IN_NS / hz;
+	timing_tsc_base = tsc1;
+	timing_tsc_base_ns = ns1;
+	timing_info.tsc_hz = hz;
+
+	return 0;
+}
+
+static inline uint64_t timing_tsc_time(void)
+{
+	uint64_t ticks = timing_rdtsc() - timing_tsc_base;
+
+	return timing_tsc_base_ns + (uint64_t)(ticks * timing_ns_per_tick);
+}
+#endif
+
+uint64_t timing_time(void)
+{
+#ifdef TIMING_HAVE_TSC
+	if (timing_source == TIMING_TSC)
+		return timing_tsc_time();
+#endif
+	return timing_clock_time();
+}
+
+static uint64_t timing_measure_sleep(void)
+{
+	uint64_t over[TIMING_SLEEP_CNT];
+	struct timespec ts = { 0, TIMING_SLEEP_NS };
+	size_t i;
+	size_t j;
+
+	for (i = 0; i < TIMING_SLEEP_CNT; i++) {
+		uint64_t start = timing_time();
+		uint64_t took;
+
+		if (nanosleep(&ts, NULL))
+			return 0;
+		took = timing_time() - start;
+		over[i] = took > TIMING_SLEEP_NS ? took - TIMING_SLEEP_NS : 0;
+		/* Insertion sort, the median is all that's needed */
+		for (j = i; j > 0 && over[j - 1] > over[j]; j--) {
+			uint64_t t = over[j];
+
+			over[j] = over[j - 1];
+			over[j - 1] = t;
+		}
+	}
+
+	return over[TIMING_SLEEP_CNT / 2];
+}
+
+static void timing_measure(void)
+{
+	uint64_t start;
+	uint64_t prev;
+	uint64_t res = UINT64_MAX;
+	size_t i;
+
+	start = timing_time();
+	for (i = 0; i < TIMING_MEASURE_CNT; i++)
+		(void)timing_time();
+	timing_info.cost_ns =
+		(double)(timing_time() - start) / (TIMING_MEASURE_CNT + 1);
+
+	prev = timing_time();
+	for (i = 0; i < TIMING_MEASURE_CNT; i++) {
+		uint64_t now = timing_time();
+
+		if (now > prev && now - prev < res)
+			res = now - prev;
+		prev = now;
+	}
+	timing_info.resolution_ns = res == UINT64_MAX ? 0 : res;
+
+	timing_info.sleep_ns = timing_measure_sleep();
+}
+
+enum TimingSource timing_init(enum TimingSource prefer)
+{
+	struct timespec ts;
+
+	/* Resolve the clock once instead of retrying on every call */
+	timing_clock = CLOCK_MONOTONIC;
+	if (clock_gettime(timing_clock, &ts))
+		timing_clock = CLOCK_REALTIME;
+	timing_source = TIMING_CLOCK;
+	timing_info.source = TIMING_CLOCK;
+	timing_info.name = timing_clock == CLOCK_MONOTONIC ? "clock" :
+							     "clock-realtime";
+	timing_info.tsc_hz = 0;
+
+#ifdef TIMING_HAVE_TSC
+	if (prefer != TIMING_CLOCK && timing_tsc_invariant() &&
+	    !timing_tsc_calibrate()) {
+		timing_source = TIMING_TSC;
+		timing_info.source = TIMING_TSC;
+		timing_info.name = timing_tscp ? "tsc-rdtscp" : "tsc";
+	}
+#endif
+
+	timing_measure();
+
+	return timing_source;
+}
+
+void timing_get_info(timing_info_t *info)
+{
+	*info = timing_info;
+}
@@ -23,6 +23,33 @@
 
 #include <stdint.h>
 
+enum TimingSource {
+	TIMING_AUTO = 0,
+	TIMING_CLOCK,
+	TIMING_TSC,
+};
+
+typedef struct timing_info_t {
+	enum TimingSource source;
+	const char *name;
+	/* Average cost of one timing_time() call */
+	double cost_ns;
+	/* Smallest observed non-zero step between two readings */
+	uint64_t resolution_ns;
+	/* Typical oversleep of a short sleep, 0 if not measured */
+	uint64_t sleep_ns;
+	/* Calibrated TSC frequency, zero with clock source */
+	double tsc_hz;
+} timing_info_t;
+
+/*
+ * Select and calibrate the time source. Must be called before any
+ * threads are started. Without calling this, timing_time() uses the
+ * monotonic clock.
+ */
+enum TimingSource timing_init(enum TimingSource prefer);
+void timing_get_info(timing_info_t *info);
+
 uint64_t timing_time(void);
 
 static inline uint64_t timing_start(void)
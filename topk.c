@@ -0,0 +1,203 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifdef __linux__
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "timing.h"
+#include "topk.h"
+
+static uint64_t topk_wall_now(void)
+{
+#ifdef __linux__
+	struct timespec ts;
+
+	if (!clock_gettime(CLOCK_REALTIME, &ts))
+		return (uint64_t)ts.tv_sec * SEC_IN_NS + ts.tv_nsec;
+#endif
+	return (uint64_t)time(NULL) * SEC_IN_NS;
+}
+
+int topk_init(topk_t *tk, size_t k, size_t thread)
+{
+	memset(tk, 0, sizeof(*tk));
+	if (!k)
+		return 1;
+
+	tk->heap = calloc(k, sizeof(*tk->heap));
+	if (!tk->heap)
+		return 1;
+	tk->k = k;
+	tk->thread = thread;
+	tk->mono_base = timing_time();
+	tk->wall_base = topk_wall_now();
+
+	return 0;
+}
+
+void topk_free(topk_t *tk)
+{
+	free(tk->heap);
+	tk->heap = NULL;
+	tk->k = 0;
+	tk->cnt = 0;
+}
+
+static uint64_t topk_wall_time(const topk_t *tk, uint64_t mono)
+{
+	if (mono >= tk->mono_base)
+		return tk->wall_base + (mono - tk->mono_base);
+	return tk->wall_base - (tk->mono_base - mono);
+}
+
+static inline void topk_swap(topk_frame_t *a, topk_frame_t *b)
+{
+	topk_frame_t tmp = *a;
+
+	*a = *b;
+	*b = tmp;
+}
+
+static void topk_sift_down(topk_frame_t *heap, size_t cnt, size_t i)
+{
+	while (1) {
+		size_t l = 2 * i + 1;
+		size_t r = l + 1;
+		size_t min = i;
+
+		if (l < cnt && heap[l].lat < heap[min].lat)
+			min = l;
+		if (r < cnt && heap[r].lat < heap[min].lat)
+			min = r;
+		if (min == i)
+			return;
+		topk_swap(&heap[i], &heap[min]);
+		i = min;
+	}
+}
+
+static void topk_sift_up(topk_frame_t *heap, size_t i)
+{
+	while (i) {
+		size_t parent = (i - 1) / 2;
+
+		if (heap[parent].lat <= heap[i].lat)
+			return;
+		topk_swap(&heap[i], &heap[parent]);
+		i = parent;
+	}
+}
+
+static void topk_push(topk_t *tk, const topk_frame_t *f)
+{
+	if (tk->cnt < tk->k) {
+		tk->heap[tk->cnt] = *f;
+		topk_sift_up(tk->heap, tk->cnt++);
+	} else if (f->lat > tk->heap[0].lat) {
+		tk->heap[0] = *f;
+		topk_sift_down(tk->heap, tk->cnt, 0);
+	}
+}
+
+/* Offer the frame seen as number idx, its window slots are still intact */
+static void topk_offer(topk_t *tk, uint64_t idx)
+{
+	topk_frame_t f = tk->window[idx % TOPK_WINDOW];
+	size_t i;
+
+	if (tk->cnt == tk->k && f.lat <= tk->heap[0].lat)
+		return;
+
+	for (i = 0; i < TOPK_NEIGHBOURS; i++) {
+		uint64_t p = idx - i - 1;
+		uint64_t n = idx + i + 1;
+
+		f.prev[i] = idx > i ? tk->window[p % TOPK_WINDOW].lat : 0;
+		f.next[i] = n < tk->seen ? tk->window[n % TOPK_WINDOW].lat : 0;
+	}
+	f.wall = topk_wall_time(tk, f.comp.start);
+	topk_push(tk, &f);
+}
+
+void topk_add(topk_t *tk, size_t frame, uint64_t offset,
+	      const test_completion_t *comp)
+{
+	topk_frame_t *f;
+
+	if (!tk || !tk->k)
+		return;
+
+	f = &tk->window[tk->seen % TOPK_WINDOW];
+	f->lat = comp->frame - comp->start;
+	f->thread = tk->thread;
+	f->frame = frame;
+	f->offset = offset;
+	f->comp = *comp;
+	++tk->seen;
+
+	/* Frame in the middle of the window has all its neighbours now */
+	if (tk->seen > TOPK_NEIGHBOURS)
+		topk_offer(tk, tk->seen - TOPK_NEIGHBOURS - 1);
+}
+
+void topk_flush(topk_t *tk)
+{
+	uint64_t i;
+
+	if (!tk || !tk->k)
+		return;
+
+	i = tk->seen > TOPK_NEIGHBOURS ? tk->seen - TOPK_NEIGHBOURS : 0;
+	for (; i < tk->seen; i++)
+		topk_offer(tk, i);
+	/* Each frame is offered once */
+	tk->seen = 0;
+}
+
+static int topk_cmp_desc(const void *a, const void *b)
+{
+	const topk_frame_t *x = a;
+	const topk_frame_t *y = b;
+
+	return x->lat < y->lat ? 1 : (x->lat > y->lat ? -1 : 0);
+}
+
+size_t topk_merge(const topk_t *tks, size_t cnt, topk_frame_t *out,
+		  size_t k)
+{
+	topk_t all;
+	size_t i;
+	size_t j;
+
+	memset(&all, 0, sizeof(all));
+	all.heap = out;
+	all.k = k;
+	for (i = 0; i < cnt; i++) {
+		for (j = 0; j < tks[i].cnt; j++)
+			topk_push(&all, &tks[i].heap[j]);
+	}
+	qsort(out, all.cnt, sizeof(*out), topk_cmp_desc);
+
+	return all.cnt;
+}
@@ -0,0 +1,76 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_TOPK_H
+#define FRAMETEST_TOPK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "frametest.h"
+
+/* Latencies of frames before and after a slow one */
+#define TOPK_NEIGHBOURS 2
+#define TOPK_WINDOW (2 * TOPK_NEIGHBOURS + 1)
+
+typedef struct topk_frame_t {
+	uint64_t lat;
+	size_t thread;
+	size_t frame;
+	uint64_t offset;
+	test_completion_t comp;
+	/* Wall clock time of the frame start in ns */
+	uint64_t wall;
+	/* Zero when there was no such neighbour */
+	uint64_t prev[TOPK_NEIGHBOURS];
+	uint64_t next[TOPK_NEIGHBOURS];
+} topk_frame_t;
+
+/*
+ * K slowest frames of one thread in a min-heap, fastest of them at the
+ * root. Frames go through a small window first, so they enter the heap
+ * with latencies of their neighbours on both sides.
+ */
+typedef struct topk_t {
+	size_t k;
+	size_t cnt;
+	topk_frame_t *heap;
+	size_t thread;
+
+	topk_frame_t window[TOPK_WINDOW];
+	uint64_t seen;
+
+	/* Wall clock and timing_time() at the same instant */
+	uint64_t wall_base;
+	uint64_t mono_base;
+} topk_t;
+
+int topk_init(topk_t *tk, size_t k, size_t thread);
+void topk_free(topk_t *tk);
+
+void topk_add(topk_t *tk, size_t frame, uint64_t offset,
+	      const test_completion_t *comp);
+/* Take in the frames still waiting for their next neighbours */
+void topk_flush(topk_t *tk);
+
+/* Combines heaps of all threads, sorted slowest first */
+size_t topk_merge(const topk_t *tks, size_t cnt, topk_frame_t *out,
+		  size_t k);
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+trace_t *trace_open(const char *fname, size_t threads, uint64_t frame_size)
+{
+	trace_header_t hdr;
+	trace_t *trace;
+
+	if (!fname)
+		return NULL;
+
+	trace = calloc(1, sizeof(*trace));
+	if (!trace)
+		return NULL;
+
+	trace->f = fopen(fname, "wb");
+	if (!trace->f) {
+		free(trace);
+		return NULL;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+	hdr.version = TRACE_VERSION;
+	hdr.record_size = sizeof(trace_record_t);
+	hdr.endian = TRACE_ENDIAN;
+	hdr.threads = threads;
+	hdr.frame_size = frame_size;
+
+	if (fwrite(&hdr, sizeof(hdr), 1, trace->f) != 1) {
+		fclose(trace->f);
+		free(trace);
+		return NULL;
+	}
+
+	return trace;
+}
+
+int trace_close(trace_t *trace)
+{
+	int res;
+
+	if (!trace)
+		return 0;
+
+	res = trace->error;
+	if (fclose(trace->f))
+		res = 1;
+	free(trace);
+
+	return res;
+}
+
+void trace_writer_init(trace_writer_t *w, trace_t *trace)
+{
+	w->trace = trace;
+	w->cnt = 0;
+}
+
+int trace_writer_flush(trace_writer_t *w)
+{
+	size_t cnt = w->cnt;
+
+	w->cnt = 0;
+	if (!cnt || !w->trace)
+		return 0;
+
+	/* Stdio locks the stream, so a chunk is never split by others */
+	if (fwrite(w->buf, sizeof(*w->buf), cnt, w->trace->f) != cnt) {
+		w->trace->error = 1;
+		return 1;
+	}
+
+	return 0;
+}
+
+int trace_read_header(FILE *f, trace_header_t *hdr)
+{
+	if (fread(hdr, sizeof(*hdr), 1, f) != 1)
+		return 1;
+	if (memcmp(hdr->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)))
+		return 1;
+	if (hdr->endian != TRACE_ENDIAN)
+		return 1;
+	if (hdr->version != TRACE_VERSION)
+		return 1;
+	if (hdr->record_size != sizeof(trace_record_t))
+		return 1;
+
+	return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_TRACE_H
+#define FRAMETEST_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Binary frame trace file layout, all values in host byte order:
+ *   trace_header_t
+ *   trace_record_t * N
+ * Records of different threads are interleaved in chunks of up to
+ * TRACE_BUFFER_RECORDS, in completion order within one thread.
+ */
+#define TRACE_MAGIC "TFTRACE"
+#define TRACE_VERSION 1
+#define TRACE_ENDIAN 0x01020304U
+#define TRACE_BUFFER_RECORDS 1024
+
+typedef struct trace_header_t {
+	char magic[8];
+	uint32_t version;
+	uint32_t record_size;
+	uint32_t endian;
+	uint32_t threads;
+	uint64_t frame_size;
+} trace_header_t;
+
+enum TraceOp {
+	TRACE_OP_WRITE = 0,
+	TRACE_OP_READ = 1,
+};
+
+typedef struct trace_record_t {
+	uint32_t thread;
+	uint16_t op;
+	uint16_t result;
+	uint64_t frame;
+	uint64_t offset;
+	uint64_t start;
+	uint64_t open;
+	uint64_t io;
+	uint64_t close;
+	uint64_t end;
+} trace_record_t;
+
+typedef struct trace_t {
+	FILE *f;
+	int error;
+} trace_t;
+
+/* Per thread writer, flushes full buffers to the shared trace file */
+typedef struct trace_writer_t {
+	trace_t *trace;
+	size_t cnt;
+	trace_record_t buf[TRACE_BUFFER_RECORDS];
+} trace_writer_t;
+
+trace_t *trace_open(const char *fname, size_t threads, uint64_t frame_size);
+int trace_close(trace_t *trace);
+
+void trace_writer_init(trace_writer_t *w, trace_t *trace);
+int trace_writer_flush(trace_writer_t *w);
+
+int trace_read_header(FILE *f, trace_header_t *hdr);
+
+static inline void trace_writer_add(trace_writer_t *w,
+				    const trace_record_t *rec)
+{
+	w->buf[w->cnt++] = *rec;
+	if (w->cnt == TRACE_BUFFER_RECORDS)
+		(void)trace_writer_flush(w);
+}
+
+#endif
@@ -0,0 +1,228 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sysinfo.h"
+#include "telemetry.h"
+#include "timing.h"
+#include "watchdog.h"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/* Bounds of the polling period */
+#define WATCHDOG_POLL_MIN_US 1000
+#define WATCHDOG_POLL_MAX_US 100000
+
+int watchdog_tid(void)
+{
+#ifdef __linux__
+	return (int)syscall(SYS_gettid);
+#else
+	return 0;
+#endif
+}
+
+int watchdog_copy(FILE *in, FILE *out, const char *indent)
+{
+	char line[512];
+	int lines = 0;
+
+	while (fgets(line, sizeof(line), in)) {
+		size_t len = strlen(line);
+
+		if (len && line[len - 1] == '\n')
+			line[--len] = 0;
+		if (!len)
+			continue;
+		fprintf(out, "%s%s\n", indent, line);
+		++lines;
+	}
+
+	return lines ? 0 : 1;
+}
+
+static void watchdog_dump(FILE *out, const char *label, const char *path)
+{
+	FILE *f = fopen(path, "r");
+
+	fprintf(out, "  %s:", label);
+	if (!f) {
+		fprintf(out, " not available\n");
+		return;
+	}
+	fprintf(out, "\n");
+	if (watchdog_copy(f, out, "    "))
+		fprintf(out, "    (empty)\n");
+	fclose(f);
+}
+
+static const char *watchdog_phase(const test_completion_t *comp)
+{
+	if (!comp || !comp->open)
+		return "open";
+	if (!comp->io)
+		return "io";
+	return "close";
+}
+
+static void watchdog_report(watchdog_t *wd, size_t thread,
+			    const watchdog_slot_t *slot, uint64_t start,
+			    uint64_t now)
+{
+	const opts_t *opts = wd->opts;
+	size_t frame = slot->frame;
+	FILE *out = wd->out;
+	char path[128];
+	FILE *f;
+
+	fprintf(out, "Stall in %s test: thread %zu (tid %d) frame %zu",
+		wd->tcase, thread, slot->tid, frame);
+	if (opts && opts->single_file && opts->frm)
+		fprintf(out, " at offset %zu", frame * opts->frm->size);
+	else if (opts)
+		fprintf(out, " (%s/frame%.6zu.tst)", opts->path, frame);
+	fprintf(out, " in %s for %.3lf s\n", watchdog_phase(slot->comp),
+		(double)(now - start) / SEC_IN_NS);
+
+	if (slot->tid) {
+		snprintf(path, sizeof(path), "/proc/self/task/%d/wchan",
+			 slot->tid);
+		watchdog_dump(out, "wchan", path);
+		snprintf(path, sizeof(path), "/proc/self/task/%d/stack",
+			 slot->tid);
+		watchdog_dump(out, "stack", path);
+	}
+	watchdog_dump(out, "io", "/proc/self/io");
+
+	f = fopen("/proc/diskstats", "r");
+	if (f) {
+		telemetry_sample_t sample;
+
+		memset(&sample, 0, sizeof(sample));
+		if (!telemetry_read_diskstats(f, wd->dev_major, wd->dev_minor,
+					      &sample))
+			fprintf(out, "  device %u:%u in flight: %" PRIu64 "\n",
+				wd->dev_major, wd->dev_minor, sample.in_flight);
+		fclose(f);
+	}
+	fflush(out);
+}
+
+size_t watchdog_check(watchdog_t *wd, uint64_t now)
+{
+	size_t found = 0;
+	size_t i;
+
+	for (i = 0; i < wd->cnt; i++) {
+		watchdog_slot_t *slot = &wd->slots[i];
+		uint64_t start = slot->start;
+
+		/* Report each stalled frame once */
+		if (!start || start == slot->reported || now < start ||
+		    now - start < wd->threshold_ns)
+			continue;
+		slot->reported = start;
+		watchdog_report(wd, i, slot, start, now);
+		++found;
+	}
+	wd->stalls += found;
+
+	return found;
+}
+
+static void *watchdog_thread(void *arg)
+{
+	watchdog_t *wd = arg;
+	uint64_t us = wd->threshold_ns / 4000;
+
+	if (us < WATCHDOG_POLL_MIN_US)
+		us = WATCHDOG_POLL_MIN_US;
+	if (us > WATCHDOG_POLL_MAX_US)
+		us = WATCHDOG_POLL_MAX_US;
+
+	while (!wd->stop) {
+		wd->platform->usleep(us);
+		(void)watchdog_check(wd, timing_time());
+	}
+
+	return NULL;
+}
+
+int watchdog_init(watchdog_t *wd, const platform_t *platform,
+		  const opts_t *opts, const char *tcase)
+{
+	sysinfo_t info;
+
+	memset(wd, 0, sizeof(*wd));
+	wd->slots = calloc(opts->threads, sizeof(*wd->slots));
+	if (!wd->slots)
+		return 1;
+
+	wd->platform = platform;
+	wd->opts = opts;
+	wd->tcase = tcase;
+	wd->cnt = opts->threads;
+	wd->threshold_ns = opts->watchdog_ns;
+	wd->out = stderr;
+	if (!sysinfo_get(opts->path, &info)) {
+		wd->dev_major = info.dev_major;
+		wd->dev_minor = info.dev_minor;
+	}
+
+	return 0;
+}
+
+int watchdog_start(watchdog_t *wd)
+{
+	wd->stop = 0;
+	if (wd->platform->thread_create(&wd->thread, watchdog_thread, wd))
+		return 1;
+	wd->running = 1;
+
+	return 0;
+}
+
+void watchdog_stop(watchdog_t *wd)
+{
+	void *ret;
+
+	if (!wd->running)
+		return;
+	wd->stop = 1;
+	wd->platform->thread_join(wd->thread, &ret);
+	wd->running = 0;
+}
+
+void watchdog_free(watchdog_t *wd)
+{
+	free(wd->slots);
+	wd->slots = NULL;
+	wd->cnt = 0;
+	wd->platform = NULL;
+}
@@ -0,0 +1,93 @@
+/*
+ * This file is part of tframetest.
+ *
+ * Copyright (c) 2023-2025 Tuxera Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMETEST_WATCHDOG_H
+#define FRAMETEST_WATCHDOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "frametest.h"
+#include "platform.h"
+
+/* Frame in progress on one worker, published by the worker itself */
+typedef struct watchdog_slot_t {
+	/* Start of the current frame, zero between frames */
+	volatile uint64_t start;
+	volatile size_t frame;
+	test_completion_t *volatile comp;
+	int tid;
+	/* Start of the frame already reported, owned by the watchdog */
+	uint64_t reported;
+} watchdog_slot_t;
+
+/*
+ * Thread checking that no worker is stuck on a frame for longer than the
+ * threshold. On a stall the kernel wait channel and stack of the worker,
+ * I/O counters of the process and in-flight requests of the device are
+ * logged while the stall is still going on.
+ */
+typedef struct watchdog_t {
+	const platform_t *platform;
+	uint64_t thread;
+	volatile int stop;
+	int running;
+
+	const opts_t *opts;
+	const char *tcase;
+	uint64_t threshold_ns;
+	unsigned int dev_major;
+	unsigned int dev_minor;
+	FILE *out;
+
+	size_t cnt;
+	watchdog_slot_t *slots;
+	size_t stalls;
+} watchdog_t;
+
+int watchdog_init(watchdog_t *wd, const platform_t *platform,
+		  const opts_t *opts, const char *tcase);
+int watchdog_start(watchdog_t *wd);
+void watchdog_stop(watchdog_t *wd);
+void watchdog_free(watchdog_t *wd);
+
+/* Logs stalls found at the time now, returns their count */
+size_t watchdog_check(watchdog_t *wd, uint64_t now);
+/* Copies lines of a kernel file, returns non-zero if nothing was read */
+int watchdog_copy(FILE *in, FILE *out, const char *indent);
+
+/* Kernel id of the calling thread, zero if not available */
+int watchdog_tid(void);
+
+static inline void watchdog_frame_start(watchdog_slot_t *slot, size_t frame,
+					test_completion_t *comp,
+					uint64_t start)
+{
+	slot->frame = frame;
+	slot->comp = comp;
+	slot->start = start;
+}
+
+static inline void watchdog_frame_end(watchdog_slot_t *slot)
+{
+	slot->start = 0;
+}
+
+#endif